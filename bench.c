@@ -0,0 +1,338 @@
+/* See LICENSE file for copyright and license details. */
+#include "libclut.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+#define WIDTH   1920
+#define HEIGHT  1080
+#define ROUNDS  4
+
+
+struct clut {
+	size_t red_size;
+	size_t green_size;
+	size_t blue_size;
+	uint16_t *red;
+	uint16_t *green;
+	uint16_t *blue;
+};
+
+struct lut3d {
+	size_t size;
+	uint16_t *data;
+};
+
+
+/**
+ * Get the processor time spent since a point in time
+ *
+ * @param   start  The point in time
+ * @return         The number of seconds since `start`
+ */
+static double
+seconds_since(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * Print the throughput of a benchmark
+ *
+ * @param  name     The name of the benchmark
+ * @param  pixels   The number of pixels processed
+ * @param  seconds  The number of seconds it took
+ */
+static void
+report(const char *name, double pixels, double seconds)
+{
+	printf("%-40s %10.1f MP/s\n", name, pixels / seconds / 1000000.);
+}
+
+
+/**
+ * Apply a gamma curve to a value
+ * 
+ * @param   x  The value
+ * @return     The value with the gamma curve applied
+ */
+static double
+curve(double x)
+{
+	return x * x * (3 - 2 * x);
+}
+
+/**
+ * Apply a gamma curve to many values
+ * 
+ * @param  in    The values
+ * @param  out   Output parameter for the values with the gamma curve applied
+ * @param  n     The number of values
+ * @param  user  Not used
+ */
+static void
+curve_batch(const double *in, double *out, size_t n, void *user)
+{
+	size_t i;
+	for (i = 0; i < n; i++)
+		out[i] = in[i] * in[i] * (3 - 2 * in[i]);
+	(void) user;
+}
+
+
+/**
+ * Benchmark libclut
+ *
+ * @return  0: The benchmarks completed
+ *          2: An error occurred
+ */
+int
+main(int argc, char *argv[])
+{
+	libclut_colour_space_conversion_matrix_t M;
+	libclut_rgb_colour_space_t srgb = LIBCLUT_RGB_COLOUR_SPACE_SRGB_INITIALISER;
+	libclut_rgb_colour_space_t p3   = LIBCLUT_RGB_COLOUR_SPACE_DCI_P3_D65_INITIALISER;
+	libclut_white_point_t d65 = {LIBCLUT_ILLUMINANT_D65};
+	libclut_transfer_function_t pq = {LIBCLUT_TRANSFER_PQ, 0};
+	libclut_transfer_table_t pq_table, adobe_table;
+	libclut_rgb_colour_space_t adobe = LIBCLUT_RGB_COLOUR_SPACE_ADOBE_RGB_INITIALISER;
+	libclut_rgb_colour_space_t bt2020 = LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_2020_INITIALISER;
+	libclut_transfer_table_t bt2020_table;
+	libclut_colour_space_conversion_matrix_t A;
+	struct lut3d lut;
+	/* volatile, so the callbacks are opaque, as if they were in another translation unit */
+	double (*volatile curve_fn)(double) = curve;
+	void (*volatile curve_batch_fn)(const double *, double *, size_t, void *) = curve_batch;
+	struct clut ramps, big;
+	uint16_t ramp_data[3 * 256];
+	uint8_t *p8 = NULL;
+	uint16_t *p16 = NULL;
+	float *pf = NULL;
+	double *xyz = NULL, *lab = NULL;
+	size_t i, n = (size_t)WIDTH * HEIGHT;
+	double r, g, b;
+	int round;
+	clock_t start;
+
+	lut.size = 65;
+	lut.data = NULL;
+	big.red = NULL;
+	if (!(lut.data = malloc(3 * 65 * 65 * 65 * sizeof(uint16_t))))  goto fail;
+	if (!(p8 = malloc(4 * n * sizeof(uint8_t))))  goto fail;
+	if (!(p16 = malloc(3 * n * sizeof(uint16_t))))  goto fail;
+	if (!(pf = malloc(3 * n * sizeof(float))))  goto fail;
+	if (!(big.red = malloc(3 * 65536 * sizeof(uint16_t))))  goto fail;
+	if (!(xyz = malloc(3 * n * sizeof(double))))  goto fail;
+	if (!(lab = malloc(3 * n * sizeof(double))))  goto fail;
+	for (i = 0; i < 4 * n; i++)
+		p8[i] = (uint8_t)(i * 2654435761UL >> 24);
+	for (i = 0; i < 3 * n; i++) {
+		p16[i] = (uint16_t)(i * 2654435761UL >> 16);
+		pf[i] = (float)p16[i] / UINT16_MAX;
+	}
+	if (libclut_model_get_rgb_conversion_matrix(&srgb, &p3, M, NULL))
+		goto fail;
+	ramps.red_size = ramps.green_size = ramps.blue_size = 256;
+	ramps.blue = (ramps.green = (ramps.red = ramp_data) + 256) + 256;
+	libclut_start_over(&ramps, UINT16_MAX, uint16_t, 1, 1, 1);
+	libclut_gamma(&ramps, UINT16_MAX, uint16_t, 1.2, 1.1, 1.0);
+	big.red_size = big.green_size = big.blue_size = 65536;
+	big.blue = (big.green = big.red + 65536) + 65536;
+
+	start = clock();
+	for (round = 0; round < 64 * ROUNDS; round++) {
+		libclut_start_over(&big, UINT16_MAX, uint16_t, 1, 1, 1);
+		libclut_manipulate(&big, UINT16_MAX, uint16_t, curve_fn, curve_fn, curve_fn);
+	}
+	report("65536-stop libclut_manipulate", 64. * ROUNDS * 3 * 65536, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < 64 * ROUNDS; round++) {
+		libclut_start_over(&big, UINT16_MAX, uint16_t, 1, 1, 1);
+		libclut_manipulate_batch(&big, UINT16_MAX, uint16_t, curve_batch_fn, curve_batch_fn, curve_batch_fn, NULL);
+	}
+	report("65536-stop libclut_manipulate_batch", 64. * ROUNDS * 3 * 65536, seconds_since(start));
+
+	if (libclut_model_get_rgb_conversion_matrix(&adobe, &bt2020, A, NULL) ||
+	    libclut_model_prepare_transfer_table(&adobe_table, &adobe.transfer) ||
+	    libclut_model_prepare_transfer_table(&bt2020_table, &bt2020.transfer))
+		goto fail;
+	start = clock();
+	for (round = 0; round < 64 * ROUNDS; round++) {
+		libclut_start_over(&big, UINT16_MAX, uint16_t, 1, 1, 1);
+		libclut_decode_transfer(&big, UINT16_MAX, uint16_t, &adobe_table, 1, 1, 1);
+		libclut_standardise(&big, UINT16_MAX, uint16_t, 1, 1, 1);
+		libclut_convert_rgb_inplace(&big, UINT16_MAX, uint16_t, A, 1);
+		libclut_linearise(&big, UINT16_MAX, uint16_t, 1, 1, 1);
+		libclut_encode_transfer(&big, UINT16_MAX, uint16_t, &bt2020_table, 1, 1, 1);
+	}
+	report("65536-stop chained Adobe RGB to BT.2020", 64. * ROUNDS * 3 * 65536, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < 64 * ROUNDS; round++) {
+		libclut_start_over(&big, UINT16_MAX, uint16_t, 1, 1, 1);
+		libclut_convert_rgb_transfer(&big, UINT16_MAX, uint16_t, A, 1, &big, &adobe_table, &bt2020_table);
+	}
+	report("65536-stop libclut_convert_rgb_transfer", 64. * ROUNDS * 3 * 65536, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_apply_pixels(&ramps, UINT16_MAX, uint16_t, LIBCLUT_PIXEL_RGBA8888, p8, WIDTH, HEIGHT, 4 * WIDTH);
+	report("libclut_apply_pixels, RGBA8888", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_apply_pixels(&ramps, UINT16_MAX, uint16_t, LIBCLUT_PIXEL_XRGB2101010, p8, WIDTH, HEIGHT, 4 * WIDTH);
+	report("libclut_apply_pixels, XRGB2101010", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++) {
+		for (i = 0; i < 3 * n; i += 3) {
+			libclut_model_convert_rgb(pf[i], pf[i + 1], pf[i + 2], M, &r, &g, &b);
+			pf[i] = (float)r, pf[i + 1] = (float)g, pf[i + 2] = (float)b;
+		}
+	}
+	report("libclut_model_convert_rgb, float RGB", (double)ROUNDS * n, seconds_since(start));
+
+	for (i = 0; i < 3 * n; i++)
+		xyz[i] = pf[i];
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		for (i = 0; i < 3 * n; i += 3)
+			libclut_model_ciexyz_to_cielab(xyz[i], xyz[i + 1], xyz[i + 2], &lab[i], &lab[i + 1], &lab[i + 2]);
+	report("libclut_model_ciexyz_to_cielab", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_model_ciexyz_to_cielab_batch(xyz, lab, n);
+	report("libclut_model_ciexyz_to_cielab_batch", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		for (i = 0; i < 3 * n; i += 3)
+			libclut_model_cielab_to_ciexyz(lab[i], lab[i + 1], lab[i + 2], &xyz[i], &xyz[i + 1], &xyz[i + 2]);
+	report("libclut_model_cielab_to_ciexyz", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_model_cielab_to_ciexyz_batch(lab, xyz, n);
+	report("libclut_model_cielab_to_ciexyz_batch", (double)ROUNDS * n, seconds_since(start));
+
+	libclut_model_prepare_white_point(&d65);
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		for (i = 0; i < 3 * n; i += 3)
+			libclut_model_ciexyz_to_cieluv(xyz[i], xyz[i + 1], xyz[i + 2], d65.Xn, d65.Yn, d65.Zn,
+			                               &lab[i], &lab[i + 1], &lab[i + 2]);
+	report("libclut_model_ciexyz_to_cieluv", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		for (i = 0; i < 3 * n; i += 3)
+			libclut_model_ciexyz_to_cieluv_wp(xyz[i], xyz[i + 1], xyz[i + 2], &d65, &lab[i], &lab[i + 1], &lab[i + 2]);
+	report("libclut_model_ciexyz_to_cieluv_wp", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		for (i = 0; i < 3 * n; i += 3)
+			libclut_model_cieluv_to_ciexyz(lab[i], lab[i + 1], lab[i + 2], d65.Xn, d65.Yn, d65.Zn,
+			                               &xyz[i], &xyz[i + 1], &xyz[i + 2]);
+	report("libclut_model_cieluv_to_ciexyz", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		for (i = 0; i < 3 * n; i += 3)
+			libclut_model_cieluv_to_ciexyz_wp(lab[i], lab[i + 1], lab[i + 2], &d65, &xyz[i], &xyz[i + 1], &xyz[i + 2]);
+	report("libclut_model_cieluv_to_ciexyz_wp", (double)ROUNDS * n, seconds_since(start));
+
+	for (i = 0; i < 3 * n; i++)
+		xyz[i] = pf[i];
+	if (libclut_model_prepare_transfer_table(&pq_table, &pq))
+		goto fail;
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		for (i = 0; i < 3 * n; i++)
+			lab[i] = libclut_model_transfer_encode(&pq, xyz[i]);
+	report("libclut_model_transfer_encode, PQ", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_model_transfer_encode_batch(xyz, lab, 3 * n, &pq_table);
+	report("libclut_model_transfer_encode_batch, PQ", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		for (i = 0; i < 3 * n; i++)
+			xyz[i] = libclut_model_transfer_decode(&pq, lab[i]);
+	report("libclut_model_transfer_decode, PQ", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_model_transfer_decode_batch(lab, xyz, 3 * n, &pq_table);
+	report("libclut_model_transfer_decode_batch, PQ", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_convert_rgb_image(pf, 1, float, WIDTH, HEIGHT, 3 * WIDTH * sizeof(float), 3, M, 0);
+	report("libclut_convert_rgb_image, float RGB", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_convert_rgb_image(p8, UINT8_MAX, uint8_t, WIDTH, HEIGHT, 4 * WIDTH, 4, M, 1);
+	report("libclut_convert_rgb_image, RGBA8", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++) {
+		libclut_3d_start_over(&lut, UINT16_MAX, uint16_t);
+		libclut_3d_convert_rgb(&lut, UINT16_MAX, uint16_t, M, 1);
+	}
+	report("65^3 libclut_3d_convert_rgb", (double)ROUNDS * 65 * 65 * 65, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_3d_rgb_conversion(&lut, UINT16_MAX, uint16_t, M, 1);
+	report("65^3 libclut_3d_rgb_conversion", (double)ROUNDS * 65 * 65 * 65, seconds_since(start));
+
+	lut.size = 33;
+	libclut_3d_rgb_conversion(&lut, UINT16_MAX, uint16_t, M, 1);
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_3d_apply(&lut, UINT16_MAX, uint16_t, p8, UINT8_MAX, uint8_t, WIDTH, HEIGHT, 4 * WIDTH, 4);
+	report("33^3 libclut_3d_apply, RGBA8", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_3d_apply(&lut, UINT16_MAX, uint16_t, p16, UINT16_MAX, uint16_t,
+		                 WIDTH, HEIGHT, 3 * WIDTH * sizeof(uint16_t), 3);
+	report("33^3 libclut_3d_apply, RGB16", (double)ROUNDS * n, seconds_since(start));
+
+	start = clock();
+	for (round = 0; round < ROUNDS; round++)
+		libclut_3d_apply(&lut, UINT16_MAX, uint16_t, pf, 1, float, WIDTH, HEIGHT, 3 * WIDTH * sizeof(float), 3);
+	report("33^3 libclut_3d_apply, float RGB", (double)ROUNDS * n, seconds_since(start));
+
+	free(lut.data);
+	free(p8);
+	free(p16);
+	free(pf);
+	free(big.red);
+	free(xyz);
+	free(lab);
+	return 0;
+fail:
+	perror(*argv);
+	free(lut.data);
+	free(p8);
+	free(p16);
+	free(pf);
+	free(big.red);
+	free(xyz);
+	free(lab);
+	return 2;
+	(void) argc;
+}
@@ -2,6 +2,14 @@
 #include "libclut.h"
 
 #include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if !defined(_WIN32)
+# include <sys/mman.h>
+#endif
 
 #if defined(__GNUC__)
 # pragma GCC diagnostic ignored "-Wunsuffixed-float-constants"
@@ -64,6 +72,245 @@ void
 	libclut_model_standard_to_linear(r, g, b);
 }
 
+/**
+ * The constants of the ITU-R BT.709 transfer function,
+ * at the precision used by ITU-R BT.2020
+ */
+#define BT_709_ALPHA  1.09929682680944
+#define BT_709_BETA   0.018053968510807
+
+/**
+ * The constants of the SMPTE ST 2084 transfer function
+ */
+#define PQ_M1  (2610. / 16384)
+#define PQ_M2  (2523. / 4096 * 128)
+#define PQ_C1  (3424. / 4096)
+#define PQ_C2  (2413. / 4096 * 32)
+#define PQ_C3  (2392. / 4096 * 32)
+
+/**
+ * The constants of the hybrid log-gamma transfer function
+ */
+#define HLG_A  0.17883277
+#define HLG_B  0.28466892
+#define HLG_C  0.55991073
+
+/**
+ * Convert a non-negative value from linear
+ * to encoded with a transfer function
+ * 
+ * @param   tf  The transfer function
+ * @param   c   The linear value
+ * @return      Corresponding encoded value
+ */
+static double
+transfer_encode(const libclut_transfer_function_t *tf, double c)
+{
+	switch (tf->type) {
+	case LIBCLUT_TRANSFER_SRGB:
+		return libclut_model_linear_to_standard1(c);
+	case LIBCLUT_TRANSFER_GAMMA:
+		return pow(c, 1 / tf->gamma);
+	case LIBCLUT_TRANSFER_BT_709:
+		return c < BT_709_BETA ? 4.5 * c : BT_709_ALPHA * pow(c, 0.45) - (BT_709_ALPHA - 1);
+	case LIBCLUT_TRANSFER_PQ:
+		c = pow(c, PQ_M1);
+		return pow((PQ_C1 + PQ_C2 * c) / (1 + PQ_C3 * c), PQ_M2);
+	case LIBCLUT_TRANSFER_HLG:
+		return c <= 1. / 12 ? sqrt(3 * c) : HLG_A * log(12 * c - HLG_B) + HLG_C;
+	case LIBCLUT_TRANSFER_L_STAR:
+		return c <= 216. / 24389 ? c * (24389. / 2700) : 1.16 * cbrt(c) - 0.16;
+	case LIBCLUT_TRANSFER_LINEAR:
+	default:
+		return c;
+	}
+}
+
+/**
+ * Convert a non-negative value from encoded
+ * with a transfer function to linear
+ * 
+ * @param   tf  The transfer function
+ * @param   c   The encoded value
+ * @return      Corresponding linear value
+ */
+static double
+transfer_decode(const libclut_transfer_function_t *tf, double c)
+{
+	switch (tf->type) {
+	case LIBCLUT_TRANSFER_SRGB:
+		return libclut_model_standard_to_linear1(c);
+	case LIBCLUT_TRANSFER_GAMMA:
+		return pow(c, tf->gamma);
+	case LIBCLUT_TRANSFER_BT_709:
+		return c < 4.5 * BT_709_BETA ? c * (1 / 4.5) : pow((c + (BT_709_ALPHA - 1)) * (1 / BT_709_ALPHA), 1 / 0.45);
+	case LIBCLUT_TRANSFER_PQ:
+		c = pow(c, 1 / PQ_M2);
+		c = c > PQ_C1 ? (c - PQ_C1) / (PQ_C2 - PQ_C3 * c) : 0;
+		return pow(c, 1 / PQ_M1);
+	case LIBCLUT_TRANSFER_HLG:
+		return c <= 0.5 ? c * c * (1. / 3) : (exp((c - HLG_C) * (1 / HLG_A)) + HLG_B) * (1. / 12);
+	case LIBCLUT_TRANSFER_L_STAR:
+		return c <= 0.08 ? c * (2700. / 24389) : (c = (c + 0.16) * (1 / 1.16), c * c * c);
+	case LIBCLUT_TRANSFER_LINEAR:
+	default:
+		return c;
+	}
+}
+
+/**
+ * Convert one component from linear to encoded with a transfer function
+ * 
+ * @param   tf  The transfer function
+ * @param   c   The linear value
+ * @return      Corresponding encoded value
+ */
+double
+libclut_model_transfer_encode(const libclut_transfer_function_t *tf, double c)
+{
+	return c < 0 ? -transfer_encode(tf, -c) : transfer_encode(tf, c);
+}
+
+/**
+ * Convert one component from encoded with a transfer function to linear
+ * 
+ * @param   tf  The transfer function
+ * @param   c   The encoded value
+ * @return      Corresponding linear value
+ */
+double
+libclut_model_transfer_decode(const libclut_transfer_function_t *tf, double c)
+{
+	return c < 0 ? -transfer_decode(tf, -c) : transfer_decode(tf, c);
+}
+
+/**
+ * Prepare the tables for a transfer function
+ * 
+ * @param   table  Output parameter for the tables
+ * @param   tf     The transfer function
+ * @return         Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `tf->type` is not a valid transfer function
+ * @throws  EINVAL  `tf->type` is `LIBCLUT_TRANSFER_GAMMA`,
+ *                  but `tf->gamma` is not positive
+ */
+int
+libclut_model_prepare_transfer_table(libclut_transfer_table_t *table, const libclut_transfer_function_t *tf)
+{
+	size_t i, n = sizeof(table->decode) / sizeof(*table->decode);
+	double x;
+
+	if ((int)tf->type < (int)LIBCLUT_TRANSFER_SRGB || (int)tf->type > (int)LIBCLUT_TRANSFER_L_STAR)
+		return errno = EINVAL, -1;
+	if (tf->type == LIBCLUT_TRANSFER_GAMMA && !(tf->gamma > 0))
+		return errno = EINVAL, -1;
+
+	table->function = *tf;
+	for (i = 0; i < n; i++) {
+		x = ldexp(1 + (double)(i & 127) / 128, (int)(i >> 7) - 16);
+		table->decode[i] = transfer_decode(tf, x);
+		table->encode[i] = transfer_encode(tf, x);
+	}
+
+	return 0;
+}
+
+/**
+ * Evaluate a function, using a table if the input is in [2⁻¹⁶, 1)
+ * 
+ * @param   t      The table, `libclut_transfer_table_t.decode`
+ *                 or `libclut_transfer_table_t.encode`
+ * @param   exact  The function, used outside the table
+ * @param   tf     The first argument for `exact`
+ * @param   c      The value to convert
+ * @return         The converted value
+ */
+static inline double
+transfer_lookup(const double *t, double (*exact)(const libclut_transfer_function_t *, double),
+                const libclut_transfer_function_t *tf, double c)
+{
+	uint64_t bits;
+	double sign = 1, d1, d2;
+	size_t i, m;
+	int e;
+
+	if (c < 0)
+		c = -c, sign = -1;
+
+	/* The table is indexed by the exponent and the 7 most significant
+	 * bits of the mantissa, and interpolated by the rest, quadratically
+	 * through three evenly spaced samples in the same octave */
+	memcpy(&bits, &c, sizeof(bits));
+	e = (int)(bits >> 52) - 1023;
+	if (e < -16 || e >= 0)
+		return sign * exact(tf, c);
+	m = (size_t)((bits >> 45) & 127);
+	c = (double)(bits & ((UINT64_C(1) << 45) - 1)) * (1. / (UINT64_C(1) << 45));
+	if (m == 127)
+		m -= 1, c += 1;
+	i = ((size_t)(e + 16) << 7) | m;
+	d1 = t[i + 1] - t[i];
+	d2 = t[i + 2] - 2 * t[i + 1] + t[i];
+	return sign * (t[i] + c * (d1 + (c - 1) * 0.5 * d2));
+}
+
+/**
+ * Convert many components from linear to encoded with a transfer function
+ * 
+ * Values in [2⁻¹⁶, 1] are interpolated from `table`, with an
+ * absolute error of less than 10⁻⁵, other values are
+ * converted with `libclut_model_transfer_encode`
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
+ * 
+ * @param  in     The linear values
+ * @param  out    Output parameter for the encoded values, may be `in`
+ * @param  n      The number of values in `in` and `out`
+ * @param  table  The transfer function, prepared with
+ *                `libclut_model_prepare_transfer_table`
+ */
+void
+libclut_model_transfer_encode_batch(const double *in, double *out, size_t n, const libclut_transfer_table_t *table)
+{
+	size_t i;
+	if (table->function.type == LIBCLUT_TRANSFER_LINEAR) {
+		if (in != out)
+			memmove(out, in, n * sizeof(*out));
+		return;
+	}
+	for (i = 0; i < n; i++)
+		out[i] = transfer_lookup(table->encode, transfer_encode, &table->function, in[i]);
+}
+
+/**
+ * Convert many components from encoded with a transfer function to linear
+ * 
+ * Values in [2⁻¹⁶, 1] are interpolated from `table`, with an
+ * absolute error of less than 10⁻⁵, other values are
+ * converted with `libclut_model_transfer_decode`
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
+ * 
+ * @param  in     The encoded values
+ * @param  out    Output parameter for the linear values, may be `in`
+ * @param  n      The number of values in `in` and `out`
+ * @param  table  The transfer function, prepared with
+ *                `libclut_model_prepare_transfer_table`
+ */
+void
+libclut_model_transfer_decode_batch(const double *in, double *out, size_t n, const libclut_transfer_table_t *table)
+{
+	size_t i;
+	if (table->function.type == LIBCLUT_TRANSFER_LINEAR) {
+		if (in != out)
+			memmove(out, in, n * sizeof(*out));
+		return;
+	}
+	for (i = 0; i < n; i++)
+		out[i] = transfer_lookup(table->decode, transfer_decode, &table->function, in[i]);
+}
+
 /**
  * Convert CIE xyY to CIE XYZ.
  * 
@@ -228,6 +475,99 @@ void
 	libclut_model_cieluv_to_ciexyz(L, u, v, Xn, Yn, Zn, X, Y, Z);
 }
 
+/**
+ * Prepare a reference white for the CIE L*a*b*
+ * and CIE L*u*v* conversions that take one
+ * 
+ * @param  wp  The white point, `.white_x`, `.white_y`, and
+ *             `.white_Y` must be set, the other members are set
+ */
+void
+libclut_model_prepare_white_point(libclut_white_point_t *wp)
+{
+	double t;
+	wp->Yn = wp->white_Y;
+	libclut_model_ciexyy_to_ciexyz(wp->white_x, wp->white_y, wp->Yn, &wp->Xn, &wp->Zn);
+	wp->rXn = 1 / wp->Xn;
+	wp->rYn = 1 / wp->Yn;
+	wp->rZn = 1 / wp->Zn;
+	t = 1 / (wp->Xn + 15 * wp->Yn + 3 * wp->Zn);
+	wp->un = 4 * wp->Xn * t;
+	wp->vn = 9 * wp->Yn * t;
+}
+
+/**
+ * Convert from CIE XYZ to CIE L*a*b*, with a specified reference white
+ * 
+ * @param  X   The X parameter
+ * @param  Y   The Y parameter
+ * @param  Z   The Z parameter
+ * @param  wp  The reference white, prepared with `libclut_model_prepare_white_point`
+ * @param  L   Output parameter for the L* component
+ * @param  a   Output parameter for the a* component
+ * @param  b   Output parameter for the b* component
+ */
+void
+(libclut_model_ciexyz_to_cielab_wp)(double X, double Y, double Z, const libclut_white_point_t *wp,
+                                    double *L, double *a, double *b)
+{
+	libclut_model_ciexyz_to_cielab_wp(X, Y, Z, wp, L, a, b);
+}
+
+/**
+ * Convert from CIE L*a*b* to CIE XYZ, with a specified reference white
+ * 
+ * @param  L   The L* component
+ * @param  a   The a* component
+ * @param  b   The b* component
+ * @param  wp  The reference white, prepared with `libclut_model_prepare_white_point`
+ * @param  X   Output parameter for the X parameter
+ * @param  Y   Output parameter for the Y parameter
+ * @param  Z   Output parameter for the Z parameter
+ */
+void
+(libclut_model_cielab_to_ciexyz_wp)(double L, double a, double b, const libclut_white_point_t *wp,
+                                    double *X, double *Y, double *Z)
+{
+	libclut_model_cielab_to_ciexyz_wp(L, a, b, wp, X, Y, Z);
+}
+
+/**
+ * Convert from CIE XYZ to CIELUV, with a specified reference white
+ * 
+ * @param  X   The X component
+ * @param  Y   The Y component
+ * @param  Z   The Z component
+ * @param  wp  The reference white, prepared with `libclut_model_prepare_white_point`
+ * @param  L   Output parameter for the L* parameter
+ * @param  u   Output parameter for the u* parameter
+ * @param  v   Output parameter for the v* parameter
+ */
+void
+(libclut_model_ciexyz_to_cieluv_wp)(double X, double Y, double Z, const libclut_white_point_t *wp,
+                                    double *L, double *u, double *v)
+{
+	libclut_model_ciexyz_to_cieluv_wp(X, Y, Z, wp, L, u, v);
+}
+
+/**
+ * Convert from CIELUV to CIE XYZ, with a specified reference white
+ * 
+ * @param  L   The L* component
+ * @param  u   The u* component
+ * @param  v   The v* component
+ * @param  wp  The reference white, prepared with `libclut_model_prepare_white_point`
+ * @param  X   Output parameter for the X parameter
+ * @param  Y   Output parameter for the Y parameter
+ * @param  Z   Output parameter for the Z parameter
+ */
+void
+(libclut_model_cieluv_to_ciexyz_wp)(double L, double u, double v, const libclut_white_point_t *wp,
+                                    double *X, double *Y, double *Z)
+{
+	libclut_model_cieluv_to_ciexyz_wp(L, u, v, wp, X, Y, Z);
+}
+
 /**
  * Convert from CIELCh to CIE L*u*v*
  * 
@@ -446,6 +786,82 @@ void
 	libclut_model_ciexyz_to_cie_1960_ucs(x, y, z, u, v, Y);
 }
 
+/**
+ * The CIE xy chromaticities of the Planckian locus, from 40 mireds
+ * (25000 K) to 1000 mireds (1000 K) in steps of 10 mireds, computed
+ * from Krystek's approximation of the locus in CIE 1960 UCS
+ */
+static const double planckian_locus[][2] = {
+		{0.2520891, 0.2507476}, {0.2561431, 0.2567565}, {0.2604961, 0.2629082}, {0.2651377, 0.2691834},
+		{0.2700558, 0.2755612}, {0.2752377, 0.2820190}, {0.2806694, 0.2885335}, {0.2863358, 0.2950799},
+		{0.2922211, 0.3016331}, {0.2983083, 0.3081676}, {0.3045799, 0.3146576}, {0.3110177, 0.3210778},
+		{0.3176032, 0.3274035}, {0.3243173, 0.3336105}, {0.3311410, 0.3396761}, {0.3380551, 0.3455790},
+		{0.3450407, 0.3512992}, {0.3520793, 0.3568187}, {0.3591527, 0.3621214}, {0.3662435, 0.3671934},
+		{0.3733349, 0.3720226}, {0.3804111, 0.3765993}, {0.3874572, 0.3809159}, {0.3944592, 0.3849666},
+		{0.4014043, 0.3887480}, {0.4082808, 0.3922585}, {0.4150780, 0.3954982}, {0.4217864, 0.3984688},
+		{0.4283977, 0.4011738}, {0.4349046, 0.4036177}, {0.4413008, 0.4058065}, {0.4475811, 0.4077470},
+		{0.4537411, 0.4094471}, {0.4597774, 0.4109152}, {0.4656874, 0.4121604}, {0.4714692, 0.4131922},
+		{0.4771217, 0.4140205}, {0.4826444, 0.4146553}, {0.4880373, 0.4151069}, {0.4933009, 0.4153853},
+		{0.4984362, 0.4155006}, {0.5034444, 0.4154629}, {0.5083275, 0.4152820}, {0.5130872, 0.4149673},
+		{0.5177257, 0.4145281}, {0.5222456, 0.4139734}, {0.5266493, 0.4133117}, {0.5309395, 0.4125514},
+		{0.5351190, 0.4117003}, {0.5391907, 0.4107659}, {0.5431574, 0.4097554}, {0.5470220, 0.4086755},
+		{0.5507875, 0.4075326}, {0.5544568, 0.4063327}, {0.5580327, 0.4050815}, {0.5615182, 0.4037842},
+		{0.5649159, 0.4024459}, {0.5682287, 0.4010713}, {0.5714593, 0.3996646}, {0.5746102, 0.3982299},
+		{0.5776841, 0.3967710}, {0.5806835, 0.3952914}, {0.5836108, 0.3937944}, {0.5864683, 0.3922828},
+		{0.5892583, 0.3907596}, {0.5919830, 0.3892273}, {0.5946446, 0.3876882}, {0.5972450, 0.3861446},
+		{0.5997864, 0.3845984}, {0.6022706, 0.3830515}, {0.6046994, 0.3815056}, {0.6070746, 0.3799622},
+		{0.6093980, 0.3784226}, {0.6116712, 0.3768883}, {0.6138957, 0.3753603}, {0.6160731, 0.3738398},
+		{0.6182049, 0.3723276}, {0.6202925, 0.3708247}, {0.6223372, 0.3693317}, {0.6243403, 0.3678495},
+		{0.6263032, 0.3663786}, {0.6282269, 0.3649196}, {0.6301127, 0.3634730}, {0.6319617, 0.3620392},
+		{0.6337750, 0.3606186}, {0.6355536, 0.3592115}, {0.6372984, 0.3578183}, {0.6390105, 0.3564390},
+		{0.6406908, 0.3550740}, {0.6423402, 0.3537235}, {0.6439595, 0.3523875}, {0.6455495, 0.3510661},
+		{0.6471111, 0.3497595}, {0.6486449, 0.3484677}, {0.6501519, 0.3471907}, {0.6516326, 0.3459285},
+		{0.6530877, 0.3446811}
+};
+
+/**
+ * Get the chromaticity of a blackbody of a
+ * correlated colour temperature in CIE xyY
+ * 
+ * @param  T  The temperature, in kelvins, clamped to [1000, 25000]
+ * @param  x  Output parameter for the x parameter
+ * @param  y  Output parameter for the y parameter
+ */
+void
+libclut_model_cct_to_ciexy(double T, double *x, double *y)
+{
+	size_t n = sizeof(planckian_locus) / sizeof(*planckian_locus);
+	size_t i;
+	double f;
+
+	/* The index in the table is linear in mireds, 10⁶ / T */
+	f = (T > 1000 ? (T < 25000 ? 100000 / T : 4) : 100) - 4;
+	i = (size_t)f;
+	if (i > n - 2)
+		i = n - 2;
+	f -= (double)i;
+
+	*x = planckian_locus[i][0] + f * (planckian_locus[i + 1][0] - planckian_locus[i][0]);
+	*y = planckian_locus[i][1] + f * (planckian_locus[i + 1][1] - planckian_locus[i][1]);
+}
+
+/**
+ * Get the chromaticity of a blackbody of a
+ * correlated colour temperature in CIE 1960 UCS
+ * 
+ * @param  T  The temperature, in kelvins, clamped to [1000, 25000]
+ * @param  u  Output parameter for the u parameter
+ * @param  v  Output parameter for the v parameter
+ */
+void
+libclut_model_cct_to_cie_1960_ucs(double T, double *u, double *v)
+{
+	double x, y, X, Z;
+	libclut_model_cct_to_ciexy(T, &x, &y);
+	libclut_model_ciexyy_to_ciexyz(x, y, 1, &X, &Z);
+	libclut_model_ciexyz_to_cie_1960_ucs(X, 1, Z, u, v, &y);
+}
+
 /**
  * Convert from CIEUVW to CIE 1960 UCS
  * 
@@ -485,96 +901,70 @@ void
 }
 
 /**
- * Divide all values in a row by a divisor
+ * Invert a matrix, using its adjugate and determinant
  * 
- * @param  m  The first part of the row
- * @param  a  The second part of the row
- * @param  d  The divisor
- */
-static void
-divrow(double m[3], double a[3], double d)
-{
-	m[0] /= d, m[1] /= d, m[2] /= d;
-	a[0] /= d, a[1] /= d, a[2] /= d;
-}
-
-/**
- * Subtract all values in a row by corresponding value
- * in another row multiplied by a common value
+ * @param   M     The matrix to invert
+ * @param   Minv  Output parameter for the inverse of `M`, may be `M`
+ * @param   cond  Output parameter for the condition number of `M`,
+ *                in the maximum absolute row sum norm, may be `NULL`
+ * @return        Zero on success, -1 on error
  * 
- * @param  a1  The first part of the minuend/difference row
- * @param  a2  The second part of the minuend/difference row
- * @param  b1  The first part of the subtrahend row
- * @param  b2  The second part of the subtrahend row
- * @param  m   The multiplier
+ * @throws  EINVAL  The matrix is not invertible
  */
-static void
-subrow(double a1[3], double a2[3], double b1[3], double b2[3], double m)
+int
+libclut_model_invert_matrix(libclut_colour_space_conversion_matrix_t M, libclut_colour_space_conversion_matrix_t Minv,
+                            double *cond)
 {
-	a1[0] -= b1[0] * m, a1[1] -= b1[1] * m, a1[2] -= b1[2] * m;
-	a2[0] -= b2[0] * m, a2[1] -= b2[1] * m, a2[2] -= b2[2] * m;
+	libclut_colour_space_conversion_matrix_t A;
+	double det, n, ninv, t;
+	int i;
+
+	A[0][0] = M[1][1] * M[2][2] - M[1][2] * M[2][1];
+	A[1][0] = M[1][2] * M[2][0] - M[1][0] * M[2][2];
+	A[2][0] = M[1][0] * M[2][1] - M[1][1] * M[2][0];
+	det = M[0][0] * A[0][0] + M[0][1] * A[1][0] + M[0][2] * A[2][0];
+	if (libclut_0__(det) || !isfinite(det))
+		return errno = EINVAL, -1;
+
+	A[0][1] = M[0][2] * M[2][1] - M[0][1] * M[2][2];
+	A[1][1] = M[0][0] * M[2][2] - M[0][2] * M[2][0];
+	A[2][1] = M[0][1] * M[2][0] - M[0][0] * M[2][1];
+	A[0][2] = M[0][1] * M[1][2] - M[0][2] * M[1][1];
+	A[1][2] = M[0][2] * M[1][0] - M[0][0] * M[1][2];
+	A[2][2] = M[0][0] * M[1][1] - M[0][1] * M[1][0];
+
+	det = 1 / det;
+	for (n = ninv = 0, i = 0; i < 3; i++) {
+		t = fabs(M[i][0]) + fabs(M[i][1]) + fabs(M[i][2]);
+		n = t > n ? t : n;
+		A[i][0] *= det, A[i][1] *= det, A[i][2] *= det;
+		t = fabs(A[i][0]) + fabs(A[i][1]) + fabs(A[i][2]);
+		ninv = t > ninv ? t : ninv;
+	}
+
+	memcpy(Minv, A, sizeof(A));
+	if (cond)
+		*cond = n * ninv;
+	return 0;
 }
 
 /**
- * Invert a matrix
+ * Multiply two matrices
  * 
- * @param   M  The matrix to invert, will be modified to an
- *             identity matrix, possibly with reordered rows
- * @param   A  The inversion of M (as input)
- * @return     1 on success, 0 if the matrix is not invertible
+ * @param  R  Output parameter for `A` times `B`, may be `A` or `B`
+ * @param  A  The left-hand factor
+ * @param  B  The right-hand factor
  */
-static int
-invert(libclut_colour_space_conversion_matrix_t M, libclut_colour_space_conversion_matrix_t A)
+void
+libclut_model_multiply_matrices(libclut_colour_space_conversion_matrix_t R, libclut_colour_space_conversion_matrix_t A,
+                                libclut_colour_space_conversion_matrix_t B)
 {
-	int r0 = 0, r1 = 1, r2 = 2, t, swapped = 0;
 	libclut_colour_space_conversion_matrix_t T;
-
-	A[0][0] = A[1][1] = A[2][2] = 1;
-	A[0][1] = A[0][2] = A[1][0] = A[1][2] = A[2][0] = A[2][1] = 0;
-  
-	if (libclut_0__(M[r0][0])) {
-		if (libclut_0__(M[r1][0])) {
-			if (libclut_0__(M[r2][0]))
-				return 0;
-			t = r0, r0 = r2, r2 = t;
-		} else {
-			t = r0, r0 = r1, r1 = t;
-		}
-		swapped = 1;
-	}
-
-	divrow(M[r0], A[r0], M[r0][0]);
-	subrow(M[r1], A[r1], M[r0], A[r0], M[r1][0]);
-	subrow(M[r2], A[r2], M[r0], A[r0], M[r2][0]);
-
-	if (libclut_0__(M[r1][1])) {
-		if (libclut_0__(M[r2][1]))
-			return 0;
-		t = r1, r1 = r2, r2 = t;
-		swapped = 1;
-	}
-
-	divrow(M[r1], A[r1], M[r1][1]);
-	subrow(M[r2], A[r2], M[r1], A[r1], M[r2][1]);
-
-	if (libclut_0__(M[r2][2]))
-		return 0;
-
-	divrow(M[r2], A[r2], M[r2][2]);
-
-	subrow(M[r1], A[r1], M[r2], A[r2], M[r1][2]);
-	subrow(M[r0], A[r0], M[r2], A[r2], M[r0][2]);
-
-	subrow(M[r0], A[r0], M[r1], A[r1], M[r0][1]);
-
-	if (swapped) {
-		memcpy(T, A, sizeof(T));
-		memcpy(A[0], T[r0], sizeof(*T));
-		memcpy(A[1], T[r1], sizeof(*T));
-		memcpy(A[2], T[r2], sizeof(*T));
-	}
-
-	return 1;
+	int i, j;
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < 3; j++)
+			T[i][j] = A[i][0] * B[0][j] + A[i][1] * B[1][j] + A[i][2] * B[2][j];
+	memcpy(R, T, sizeof(T));
 }
 
 /**
@@ -608,8 +998,8 @@ get_conversion_matrix(const libclut_rgb_colour_space_t *cs, libclut_colour_space
 	M2[1][0] = Yr, M2[1][1] = Yg, M2[1][2] = Yb;
 	M2[2][0] = Zr, M2[2][1] = Zg, M2[2][2] = Zb;
 
-	if (!invert(M2, M))
-		return errno = EINVAL, -1;
+	if (libclut_model_invert_matrix(M2, M, NULL))
+		return -1;
 
 	Sr = M[0][0] * Xw + M[0][1] * Yw + M[0][2] * Zw;
 	Sg = M[1][0] * Xw + M[1][1] * Yw + M[1][2] * Zw;
@@ -658,37 +1048,107 @@ libclut_model_get_rgb_conversion_matrix(const libclut_rgb_colour_space_t *from,
 	if (to) {
 		if (get_conversion_matrix(to, M))
 			return -1;
-		if (!invert(M, B)) {
-			errno = EINVAL;
+		if (libclut_model_invert_matrix(M, B, NULL))
 			return -1;
-		}
-
-		if (from) {
-			M[0][0] = B[0][0] * A[0][0] + B[0][1] * A[1][0] + B[0][2] * A[2][0];
-			M[0][1] = B[0][0] * A[0][1] + B[0][1] * A[1][1] + B[0][2] * A[2][1];
-			M[0][2] = B[0][0] * A[0][2] + B[0][1] * A[1][2] + B[0][2] * A[2][2];
-
-			M[1][0] = B[1][0] * A[0][0] + B[1][1] * A[1][0] + B[1][2] * A[2][0];
-			M[1][1] = B[1][0] * A[0][1] + B[1][1] * A[1][1] + B[1][2] * A[2][1];
-			M[1][2] = B[1][0] * A[0][2] + B[1][1] * A[1][2] + B[1][2] * A[2][2];
 
-			M[2][0] = B[2][0] * A[0][0] + B[2][1] * A[1][0] + B[2][2] * A[2][0];
-			M[2][1] = B[2][0] * A[0][1] + B[2][1] * A[1][1] + B[2][2] * A[2][1];
-			M[2][2] = B[2][0] * A[0][2] + B[2][1] * A[1][2] + B[2][2] * A[2][2];
-		} else {
+		if (from)
+			libclut_model_multiply_matrices(M, B, A);
+		else
 			memcpy(M, B, sizeof(B));
-		}
 	} else {
 		memcpy(M, A, sizeof(A));
 	}
 
-	if (Minv) {
-		memcpy(A, M, sizeof(A));
-		if (!invert(A, Minv)) {
-			errno = EINVAL;
-			return -1;
-		}
+	if (Minv && libclut_model_invert_matrix(M, Minv, NULL))
+		return -1;
+
+	return 0;
+}
+
+/**
+ * Create a matrix for converting values between two RGB colour
+ * spaces, that also maps the white point of the input colour
+ * space to the white point of the output colour space
+ * 
+ * The adaptation is folded into the matrix, so converting with
+ * it costs the same as converting with a matrix created with
+ * `libclut_model_get_rgb_conversion_matrix`
+ * 
+ * @param   from  The input colour space, `NULL` for CIE XYZ
+ * @param   to    The output colour space, `NULL` for CIE XYZ
+ * @param   cat   The chromatic adaptation transform, no adaptation is
+ *                done if `from` or `to` is `NULL` as CIE XYZ does not
+ *                have a white point
+ * @param   M     Output matrix for conversion from `from` to `to`
+ * @param   Minv  Output matrix for conversion from `to` to `from`, may be `NULL`
+ * @return        Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  The colour space cannot be used
+ * @throws  EINVAL  `cat` is not a valid chromatic adaptation transform
+ */
+int
+libclut_model_get_adapted_rgb_conversion_matrix(const libclut_rgb_colour_space_t *from,
+                                                const libclut_rgb_colour_space_t *to,
+                                                libclut_chromatic_adaptation_t cat,
+                                                libclut_colour_space_conversion_matrix_t M,
+                                                libclut_colour_space_conversion_matrix_t Minv)
+{
+	static const libclut_colour_space_conversion_matrix_t cones[] = {
+		[LIBCLUT_ADAPTATION_XYZ_SCALING] = {
+			{1, 0, 0},
+			{0, 1, 0},
+			{0, 0, 1}},
+		[LIBCLUT_ADAPTATION_VON_KRIES] = {
+			{ 0.40024, 0.70760, -0.08081},
+			{-0.22630, 1.16532,  0.04570},
+			{ 0.00000, 0.00000,  0.91822}},
+		[LIBCLUT_ADAPTATION_BRADFORD] = {
+			{ 0.8951,  0.2664, -0.1614},
+			{-0.7502,  1.7135,  0.0367},
+			{ 0.0389, -0.0685,  1.0296}},
+		[LIBCLUT_ADAPTATION_CAT02] = {
+			{ 0.7328, 0.4296, -0.1624},
+			{-0.7036, 1.6975,  0.0061},
+			{ 0.0030, 0.0136,  0.9834}}
+	};
+	libclut_colour_space_conversion_matrix_t A, B, C, T;
+	double fX, fY, fZ, tX, tY, tZ, f[3], t[3];
+	int i, j;
+
+	if ((int)cat < (int)LIBCLUT_ADAPTATION_NONE || (int)cat > (int)LIBCLUT_ADAPTATION_CAT02)
+		return errno = EINVAL, -1;
+	if (cat == LIBCLUT_ADAPTATION_NONE || !from || !to)
+		return libclut_model_get_rgb_conversion_matrix(from, to, M, Minv);
+
+	if (libclut_model_get_rgb_conversion_matrix(from, NULL, A, NULL) ||
+	    libclut_model_get_rgb_conversion_matrix(NULL, to, B, NULL))
+		return -1;
+
+	libclut_model_ciexyy_to_ciexyz(from->white_x, from->white_y, from->white_Y, &fX, &fZ);
+	libclut_model_ciexyy_to_ciexyz(to->white_x, to->white_y, to->white_Y, &tX, &tZ);
+	fY = from->white_Y, tY = to->white_Y;
+
+	/* C = inverse(cones) × diag(t / f) × cones, where t and f are the cone responses of the whites */
+	for (i = 0; i < 3; i++) {
+		f[i] = cones[cat][i][0] * fX + cones[cat][i][1] * fY + cones[cat][i][2] * fZ;
+		t[i] = cones[cat][i][0] * tX + cones[cat][i][1] * tY + cones[cat][i][2] * tZ;
+		if (libclut_0__(f[i]))
+			return errno = EINVAL, -1;
+		t[i] /= f[i];
 	}
+	memcpy(T, cones[cat], sizeof(T));
+	if (libclut_model_invert_matrix(T, C, NULL))
+		return -1;
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < 3; j++)
+			T[i][j] = t[i] * cones[cat][i][j];
+	libclut_model_multiply_matrices(M, C, T);
+
+	libclut_model_multiply_matrices(M, M, A);
+	libclut_model_multiply_matrices(M, B, M);
+
+	if (Minv && libclut_model_invert_matrix(M, Minv, NULL))
+		return -1;
 
 	return 0;
 }
@@ -752,3 +1212,1703 @@ void
 {
 	libclut_model_ciexyz_to_rgb(x, y, z, M, r, g, b);
 }
+
+/**
+ * Apply tables built by `libclut_pixel_tables` to a buffer
+ * of pixels, in place
+ * 
+ * @param   format  The pixel format
+ * @param   pixels  Pointer to the first pixel in the buffer,
+ *                  must be aligned for the pixel format
+ * @param   width   The number of pixels per row
+ * @param   height  The number of rows
+ * @param   stride  The number of bytes between the first pixel of a
+ *                  row and the first pixel of the next row
+ * @param   red     The table for the red channel
+ * @param   green   The table for the green channel
+ * @param   blue    The table for the blue channel
+ * @return          Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `format` is not a supported pixel format
+ */
+int
+libclut_apply_pixel_tables(libclut_pixel_format_t format, void *pixels, size_t width, size_t height, size_t stride,
+                           const uint16_t *red, const uint16_t *green, const uint16_t *blue)
+{
+	unsigned char *row = pixels, *p8;
+	uint16_t *p16;
+	uint32_t *p32, v;
+	size_t x, y;
+	const uint16_t *t;
+
+	switch (format) {
+	case LIBCLUT_PIXEL_RGBA8888:
+	case LIBCLUT_PIXEL_BGRA8888:
+		if (format == LIBCLUT_PIXEL_BGRA8888)
+			t = red, red = blue, blue = t;
+		for (y = 0; y < height; y++, row += stride) {
+			for (x = 0, p8 = row; x < width; x++, p8 += 4) {
+				p8[0] = (unsigned char)red[p8[0]];
+				p8[1] = (unsigned char)green[p8[1]];
+				p8[2] = (unsigned char)blue[p8[2]];
+			}
+		}
+		return 0;
+
+	case LIBCLUT_PIXEL_RGB565:
+		for (y = 0; y < height; y++, row += stride) {
+			for (x = 0, p16 = (void *)row; x < width; x++) {
+				v = p16[x];
+				p16[x] = (uint16_t)((red[v >> 11] << 11) | (green[(v >> 5) & 0x3F] << 5) | blue[v & 0x1F]);
+			}
+		}
+		return 0;
+
+	case LIBCLUT_PIXEL_XRGB2101010:
+	case LIBCLUT_PIXEL_XBGR2101010:
+		if (format == LIBCLUT_PIXEL_XBGR2101010)
+			t = red, red = blue, blue = t;
+		for (y = 0; y < height; y++, row += stride) {
+			for (x = 0, p32 = (void *)row; x < width; x++) {
+				v = p32[x];
+				p32[x] = (v & UINT32_C(0xC0000000)) | ((uint32_t)red[(v >> 20) & 0x3FF] << 20) |
+				         ((uint32_t)green[(v >> 10) & 0x3FF] << 10) | (uint32_t)blue[v & 0x3FF];
+			}
+		}
+		return 0;
+
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+}
+
+
+/**
+ * The header of a binary ramp file, see `libclut_save_ramps_file`
+ */
+struct ramp_file_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t element_type;
+	uint32_t element_size;
+	uint64_t sizes[3];
+	uint64_t offsets[3];
+	double max;
+	uint32_t has_colour_space;
+	uint32_t transfer_type;
+	double colour_space[12];
+	double transfer_gamma;
+};
+
+/**
+ * The magic at the beginning of a binary ramp file
+ */
+#define RAMP_FILE_MAGIC  "LIBCLUT\x1A"
+
+/**
+ * The byte order mark in a binary ramp file,
+ * in the native byte order
+ */
+#define RAMP_FILE_BYTE_ORDER  UINT32_C(0x01020304)
+
+/**
+ * Get the size of an element type
+ * 
+ * @param   type  The element type
+ * @return        The size of each element, in bytes,
+ *                0 if `type` is invalid
+ */
+static size_t
+element_size(libclut_element_type_t type)
+{
+	switch (type) {
+	case LIBCLUT_ELEMENT_UINT8:  return sizeof(uint8_t);
+	case LIBCLUT_ELEMENT_UINT16: return sizeof(uint16_t);
+	case LIBCLUT_ELEMENT_UINT32: return sizeof(uint32_t);
+	case LIBCLUT_ELEMENT_UINT64: return sizeof(uint64_t);
+	case LIBCLUT_ELEMENT_FLOAT:  return sizeof(float);
+	case LIBCLUT_ELEMENT_DOUBLE: return sizeof(double);
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Write an entire buffer to a file
+ * 
+ * @param   fd   The file descriptor
+ * @param   buf  The buffer
+ * @param   n    The size of the buffer
+ * @return       Zero on success, -1 on error
+ */
+static int
+write_all(int fd, const void *buf, size_t n)
+{
+	const char *p = buf;
+	ssize_t r;
+	while (n) {
+		r = write(fd, p, n);
+		if (r < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		p += r;
+		n -= (size_t)r;
+	}
+	return 0;
+}
+
+/**
+ * Save gamma ramps to a binary ramp file
+ * 
+ * @param   fd          File descriptor for the file to write, at
+ *                      its beginning, must not be nonblocking
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         The red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       The green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        The blue ramp
+ * @param   cs          The colour space the ramps are calibrated for,
+ *                      `NULL` if unspecified
+ * @return              Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `type` is invalid
+ * @throws          Any error specified for write(3)
+ */
+int
+libclut_save_ramps_file(int fd, libclut_element_type_t type, double max, size_t red_size, const void *red,
+                        size_t green_size, const void *green, size_t blue_size, const void *blue,
+                        const libclut_rgb_colour_space_t *cs)
+{
+	static const char zeroes[64];
+	struct ramp_file_header header;
+	const void *ramps[3];
+	size_t esize = element_size(type), offset, i;
+
+	if (!esize)
+		return errno = EINVAL, -1;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, RAMP_FILE_MAGIC, sizeof(header.magic));
+	header.version = 2;
+	header.byte_order = RAMP_FILE_BYTE_ORDER;
+	header.element_type = (uint32_t)type;
+	header.element_size = (uint32_t)esize;
+	header.sizes[0] = red_size;
+	header.sizes[1] = green_size;
+	header.sizes[2] = blue_size;
+	header.max = max;
+	if (cs) {
+		header.has_colour_space = 1;
+		header.colour_space[0]  = cs->red_x,   header.colour_space[1]  = cs->red_y;
+		header.colour_space[2]  = cs->red_Y,   header.colour_space[3]  = cs->green_x;
+		header.colour_space[4]  = cs->green_y, header.colour_space[5]  = cs->green_Y;
+		header.colour_space[6]  = cs->blue_x,  header.colour_space[7]  = cs->blue_y;
+		header.colour_space[8]  = cs->blue_Y,  header.colour_space[9]  = cs->white_x;
+		header.colour_space[10] = cs->white_y, header.colour_space[11] = cs->white_Y;
+		header.transfer_type = (uint32_t)cs->transfer.type;
+		header.transfer_gamma = cs->transfer.gamma;
+	}
+	for (offset = sizeof(header), i = 0; i < 3; i++) {
+		offset = (offset + 63) & ~(size_t)63;
+		header.offsets[i] = offset;
+		offset += header.sizes[i] * esize;
+	}
+
+	ramps[0] = red, ramps[1] = green, ramps[2] = blue;
+	if (write_all(fd, &header, sizeof(header)))
+		return -1;
+	for (offset = sizeof(header), i = 0; i < 3; i++) {
+		if (write_all(fd, zeroes, header.offsets[i] - offset))
+			return -1;
+		if (write_all(fd, ramps[i], header.sizes[i] * esize))
+			return -1;
+		offset = header.offsets[i] + header.sizes[i] * esize;
+	}
+	return 0;
+}
+
+/**
+ * Map gamma ramps from a binary ramp file into memory
+ * 
+ * @param   fd       File descriptor for the file to read
+ * @param   type     The data type the ramps must have, 0 for any
+ * @param   mapping  Output parameter for the mapping
+ * @return           Zero on success, -1 on error
+ * 
+ * @throws  EINVAL   The file is not a valid binary ramp file,
+ *                   or its ramps are not of the type `type`
+ * @throws  ENOTSUP  The file was created on a machine with another
+ *                   byte order, or with a newer version of the file
+ *                   format, or memory mapping is not supported on
+ *                   this platform
+ * @throws           Any error specified for fstat(3) or mmap(3)
+ */
+int
+libclut_map_ramps_file(int fd, libclut_element_type_t type, libclut_mapped_ramps_t *mapping)
+{
+#if defined(_WIN32)
+	(void) fd;
+	(void) type;
+	(void) mapping;
+	return errno = ENOTSUP, -1;
+#else
+	struct ramp_file_header header;
+	struct stat attr;
+	size_t size, esize, i;
+	char *map;
+	void *ramps[3];
+
+	if (fstat(fd, &attr))
+		return -1;
+	if (attr.st_size < (off_t)sizeof(header) || (uintmax_t)attr.st_size > SIZE_MAX)
+		return errno = EINVAL, -1;
+	size = (size_t)attr.st_size;
+
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED)
+		return -1;
+	memcpy(&header, map, sizeof(header));
+
+	if (memcmp(header.magic, RAMP_FILE_MAGIC, sizeof(header.magic)))
+		goto invalid;
+	if (header.byte_order != RAMP_FILE_BYTE_ORDER || header.version < 1 || header.version > 2)
+		goto unsupported;
+	esize = element_size((libclut_element_type_t)header.element_type);
+	if (!esize || esize != header.element_size || (type && (uint32_t)type != header.element_type))
+		goto invalid;
+	for (i = 0; i < 3; i++) {
+		if (header.offsets[i] % 64 || header.offsets[i] < sizeof(header) || header.offsets[i] > size)
+			goto invalid;
+		if (header.sizes[i] > (size - header.offsets[i]) / esize)
+			goto invalid;
+		ramps[i] = map + header.offsets[i];
+	}
+
+	mapping->type = (libclut_element_type_t)header.element_type;
+	mapping->max = header.max;
+	mapping->red_size   = (size_t)header.sizes[0], mapping->red   = ramps[0];
+	mapping->green_size = (size_t)header.sizes[1], mapping->green = ramps[1];
+	mapping->blue_size  = (size_t)header.sizes[2], mapping->blue  = ramps[2];
+	mapping->has_colour_space = header.has_colour_space == 1;
+	memset(&mapping->colour_space, 0, sizeof(mapping->colour_space));
+	if (mapping->has_colour_space) {
+		mapping->colour_space.red_x   = header.colour_space[0];
+		mapping->colour_space.red_y   = header.colour_space[1];
+		mapping->colour_space.red_Y   = header.colour_space[2];
+		mapping->colour_space.green_x = header.colour_space[3];
+		mapping->colour_space.green_y = header.colour_space[4];
+		mapping->colour_space.green_Y = header.colour_space[5];
+		mapping->colour_space.blue_x  = header.colour_space[6];
+		mapping->colour_space.blue_y  = header.colour_space[7];
+		mapping->colour_space.blue_Y  = header.colour_space[8];
+		mapping->colour_space.white_x = header.colour_space[9];
+		mapping->colour_space.white_y = header.colour_space[10];
+		mapping->colour_space.white_Y = header.colour_space[11];
+		/* Version 1 did not store the transfer function, and only supported sRGB */
+		if (header.version > 1) {
+			if (header.transfer_type > (uint32_t)LIBCLUT_TRANSFER_L_STAR)
+				goto invalid;
+			mapping->colour_space.transfer.type = (libclut_transfer_function_type_t)header.transfer_type;
+			mapping->colour_space.transfer.gamma = header.transfer_gamma;
+		}
+	}
+	mapping->map = map;
+	mapping->map_size = size;
+	return 0;
+
+invalid:
+	munmap(map, size);
+	return errno = EINVAL, -1;
+unsupported:
+	munmap(map, size);
+	return errno = ENOTSUP, -1;
+#endif
+}
+
+/**
+ * Unmap gamma ramps mapped with `libclut_map_ramps`
+ * or `libclut_map_ramps_file`
+ * 
+ * @param  mapping  The mapping
+ */
+void
+libclut_unmap_ramps(libclut_mapped_ramps_t *mapping)
+{
+#if !defined(_WIN32)
+	if (mapping->map)
+		munmap(mapping->map, mapping->map_size);
+#endif
+	mapping->map = NULL;
+	mapping->map_size = 0;
+}
+
+/**
+ * Read a big-endian 16-bit unsigned integer
+ * 
+ * @param   p  The integer
+ * @return     The value of the integer
+ */
+static uint16_t
+be16(const unsigned char *p)
+{
+	return (uint16_t)((unsigned)p[0] << 8 | (unsigned)p[1]);
+}
+
+/**
+ * Read a big-endian 32-bit unsigned integer
+ * 
+ * @param   p  The integer
+ * @return     The value of the integer
+ */
+static uint32_t
+be32(const unsigned char *p)
+{
+	return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+/**
+ * Read a big-endian ICC s15Fixed16Number
+ * 
+ * @param   p  The number
+ * @return     The value of the number
+ */
+static double
+s15f16(const unsigned char *p)
+{
+	uint32_t u = be32(p);
+	return (u & UINT32_C(0x80000000) ? -(double)(~u + 1) : (double)u) / 65536;
+}
+
+/**
+ * Parse an ICC `curv` or `para` tag
+ * 
+ * @param   p      The tag's data
+ * @param   n      The size of the tag's data
+ * @param   curve  Output parameter for the curve, left
+ *                 unmodified if the tag type is unsupported
+ * @return         Zero on success, -1 if the tag is corrupt
+ */
+static int
+parse_icc_curve(const unsigned char *p, size_t n, libclut_icc_curve_t *curve)
+{
+	static const size_t param_count[] = {1, 3, 4, 5, 7};
+	uint32_t count;
+	size_t i;
+
+	if (n >= 12 && !memcmp(p, "curv", 4)) {
+		count = be32(&p[8]);
+		if (count > (n - 12) / 2)
+			return -1;
+		if (count == 1) {
+			curve->kind = LIBCLUT_ICC_CURVE_PARAMETRIC;
+			curve->function = 0;
+			curve->params[0] = (double)be16(&p[12]) / 256;
+		} else if (count == 0) {
+			curve->kind = LIBCLUT_ICC_CURVE_PARAMETRIC;
+			curve->function = 0;
+			curve->params[0] = 1;
+		} else {
+			curve->kind = LIBCLUT_ICC_CURVE_TABLE;
+			curve->size = count;
+			curve->entry_size = 2;
+			curve->table = &p[12];
+		}
+	} else if (n >= 12 && !memcmp(p, "para", 4)) {
+		if (be16(&p[8]) > 4 || n < 12 + 4 * param_count[be16(&p[8])])
+			return -1;
+		curve->kind = LIBCLUT_ICC_CURVE_PARAMETRIC;
+		curve->function = be16(&p[8]);
+		for (i = 0; i < param_count[curve->function]; i++)
+			curve->params[i] = s15f16(&p[12 + 4 * i]);
+	}
+	return 0;
+}
+
+/**
+ * Parse an ICC `vcgt` tag
+ * 
+ * @param   p     The tag's data
+ * @param   n     The size of the tag's data
+ * @param   vcgt  Output parameter for the curves, left
+ *                unmodified if the tag type is unsupported
+ * @return        Zero on success, -1 if the tag is corrupt
+ */
+static int
+parse_icc_vcgt(const unsigned char *p, size_t n, libclut_icc_curve_t vcgt[3])
+{
+	size_t channels, entries, entry_size, i;
+
+	if (n < 12 || memcmp(p, "vcgt", 4))
+		return 0;
+
+	if (be32(&p[8]) == 0) {
+		if (n < 18)
+			return -1;
+		channels = be16(&p[12]);
+		entries = be16(&p[14]);
+		entry_size = be16(&p[16]);
+		if ((channels != 1 && channels != 3) || entries < 2 || (entry_size != 1 && entry_size != 2))
+			return -1;
+		if (n - 18 < channels * entries * entry_size)
+			return -1;
+		for (i = 0; i < 3; i++) {
+			vcgt[i].kind = LIBCLUT_ICC_CURVE_TABLE;
+			vcgt[i].size = entries;
+			vcgt[i].entry_size = entry_size;
+			vcgt[i].table = &p[18 + (channels == 3 ? i : 0) * entries * entry_size];
+		}
+	} else if (be32(&p[8]) == 1) {
+		if (n < 12 + 9 * 4)
+			return -1;
+		for (i = 0; i < 3; i++) {
+			vcgt[i].kind = LIBCLUT_ICC_CURVE_FORMULA;
+			vcgt[i].params[0] = s15f16(&p[12 + 12 * i + 0]);
+			vcgt[i].params[1] = s15f16(&p[12 + 12 * i + 4]);
+			vcgt[i].params[2] = s15f16(&p[12 + 12 * i + 8]);
+		}
+	} else {
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Parse the parts of an ICC profile that map onto gamma ramps
+ * and RGB colour spaces
+ * 
+ * @param   data  The ICC profile
+ * @param   size  The size of `data`, in bytes
+ * @param   icc   Output parameter for the parsed profile
+ * @return        Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `data` is not a valid ICC profile
+ */
+int
+libclut_icc_parse(const void *data, size_t size, libclut_icc_t *icc)
+{
+	const unsigned char *p = data, *t;
+	double xyz[4][3], chad[3][3], A[3][3], v[3], sum, *xy[4][3];
+	int have = 0, have_chad = 0;
+	uint32_t count, offset, n;
+	size_t i, j, k;
+
+	memset(icc, 0, sizeof(*icc));
+	if (size < 132 || be32(p) < 132 || be32(p) > size || memcmp(&p[36], "acsp", 4))
+		return errno = EINVAL, -1;
+	size = be32(p);
+	count = be32(&p[128]);
+	if (count > (size - 132) / 12)
+		return errno = EINVAL, -1;
+
+	for (i = 0; i < count; i++) {
+		t = &p[132 + 12 * i];
+		offset = be32(&t[4]);
+		n = be32(&t[8]);
+		if (offset > size || n > size - offset)
+			return errno = EINVAL, -1;
+		if (!memcmp(t, "vcgt", 4)) {
+			if (parse_icc_vcgt(&p[offset], n, icc->vcgt))
+				return errno = EINVAL, -1;
+		} else if (!memcmp(t, "rTRC", 4) || !memcmp(t, "gTRC", 4) || !memcmp(t, "bTRC", 4)) {
+			j = t[0] == 'r' ? 0 : t[0] == 'g' ? 1 : 2;
+			if (parse_icc_curve(&p[offset], n, &icc->trc[j]))
+				return errno = EINVAL, -1;
+		} else if (!memcmp(t, "rXYZ", 4) || !memcmp(t, "gXYZ", 4) ||
+		           !memcmp(t, "bXYZ", 4) || !memcmp(t, "wtpt", 4)) {
+			j = t[0] == 'r' ? 0 : t[0] == 'g' ? 1 : t[0] == 'b' ? 2 : 3;
+			if (n < 20 || memcmp(&p[offset], "XYZ ", 4))
+				continue;
+			for (k = 0; k < 3; k++)
+				xyz[j][k] = s15f16(&p[offset + 8 + 4 * k]);
+			have |= 1 << j;
+		} else if (!memcmp(t, "chad", 4)) {
+			if (n < 8 + 9 * 4 || memcmp(&p[offset], "sf32", 4))
+				continue;
+			for (j = 0; j < 9; j++)
+				chad[j / 3][j % 3] = s15f16(&p[offset + 8 + 4 * j]);
+			have_chad = 1;
+		}
+	}
+
+	if (have != 15)
+		return 0;
+
+	if (have_chad && !libclut_model_invert_matrix(chad, A, NULL)) {
+		for (j = 0; j < 4; j++) {
+			for (k = 0; k < 3; k++)
+				v[k] = A[k][0] * xyz[j][0] + A[k][1] * xyz[j][1] + A[k][2] * xyz[j][2];
+			xyz[j][0] = v[0], xyz[j][1] = v[1], xyz[j][2] = v[2];
+		}
+	}
+
+	xy[0][0] = &icc->colour_space.red_x,   xy[0][1] = &icc->colour_space.red_y,   xy[0][2] = &icc->colour_space.red_Y;
+	xy[1][0] = &icc->colour_space.green_x, xy[1][1] = &icc->colour_space.green_y, xy[1][2] = &icc->colour_space.green_Y;
+	xy[2][0] = &icc->colour_space.blue_x,  xy[2][1] = &icc->colour_space.blue_y,  xy[2][2] = &icc->colour_space.blue_Y;
+	xy[3][0] = &icc->colour_space.white_x, xy[3][1] = &icc->colour_space.white_y, xy[3][2] = &icc->colour_space.white_Y;
+	for (j = 0; j < 4; j++) {
+		sum = xyz[j][0] + xyz[j][1] + xyz[j][2];
+		if (!(sum > 0))
+			return 0;
+		*xy[j][0] = xyz[j][0] / sum;
+		*xy[j][1] = xyz[j][1] / sum;
+		*xy[j][2] = xyz[j][1];
+	}
+	icc->colour_space.white_Y = 1;
+	icc->has_colour_space = 1;
+	return 0;
+}
+
+/**
+ * Evaluate a curve from an ICC profile
+ * 
+ * @param   curve  The curve, must not be `LIBCLUT_ICC_CURVE_NONE`
+ * @param   x      The input value, in [0, 1]
+ * @return         The output value, normally in [0, 1]
+ */
+double
+libclut_icc_curve(const libclut_icc_curve_t *curve, double x)
+{
+	const double *p = curve->params;
+	double m, w;
+	size_t i;
+
+	x = x > 0 ? (x < 1 ? x : 1) : 0;
+	switch (curve->kind) {
+	case LIBCLUT_ICC_CURVE_TABLE:
+		m = curve->entry_size == 1 ? UINT8_MAX : UINT16_MAX;
+		x *= (double)(curve->size - 1);
+		i = (size_t)x;
+		i -= (i == curve->size - 1);
+		w = x - (double)i;
+		return (libclut_icc_table_entry__(curve, i) * (1 - w) + libclut_icc_table_entry__(curve, i + 1) * w) / m;
+
+	case LIBCLUT_ICC_CURVE_FORMULA:
+		return p[1] + (p[2] - p[1]) * pow(x, p[0]);
+
+	case LIBCLUT_ICC_CURVE_PARAMETRIC:
+		switch (curve->function) {
+		case 0:  return pow(x, p[0]);
+		case 1:  return x >= -p[2] / p[1] ? pow(p[1] * x + p[2], p[0]) : 0;
+		case 2:  return x >= -p[2] / p[1] ? pow(p[1] * x + p[2], p[0]) + p[3] : p[3];
+		case 3:  return x >= p[4] ? pow(p[1] * x + p[2], p[0]) : p[3] * x;
+		default: return x >= p[4] ? pow(p[1] * x + p[2], p[0]) + p[5] : p[3] * x + p[6];
+		}
+
+	default:
+		return x;
+	}
+}
+
+
+/**
+ * Get an element in an array of any element type
+ * 
+ * @param   type  The element type, must be valid
+ * @param   data  The array
+ * @param   i     The index of the element
+ * @return        The value of the element
+ */
+static double
+get_element(libclut_element_type_t type, const void *data, size_t i)
+{
+	switch (type) {
+	case LIBCLUT_ELEMENT_UINT8:  return (double)((const uint8_t *)data)[i];
+	case LIBCLUT_ELEMENT_UINT16: return (double)((const uint16_t *)data)[i];
+	case LIBCLUT_ELEMENT_UINT32: return (double)((const uint32_t *)data)[i];
+	case LIBCLUT_ELEMENT_UINT64: return (double)((const uint64_t *)data)[i];
+	case LIBCLUT_ELEMENT_FLOAT:  return (double)((const float *)data)[i];
+	default:
+		return ((const double *)data)[i];
+	}
+}
+
+/**
+ * Output buffer for writing .cube files
+ */
+struct cube_writer {
+	int fd;
+	size_t length;
+	char buffer[4096];
+};
+
+/**
+ * Write the buffered output of a .cube file
+ * 
+ * @param   w  The output buffer
+ * @return     Zero on success, -1 on error
+ */
+static int
+cube_flush(struct cube_writer *w)
+{
+	size_t n = w->length;
+	w->length = 0;
+	return write_all(w->fd, w->buffer, n);
+}
+
+/**
+ * Write a string to a .cube file
+ * 
+ * @param   w  The output buffer
+ * @param   s  The string, may not be longer than `LIBCLUT_CUBE_LINE_MAX`
+ * @return     Zero on success, -1 on error
+ */
+static int
+cube_puts(struct cube_writer *w, const char *s)
+{
+	size_t n = strlen(s);
+	if (w->length + n > sizeof(w->buffer) && cube_flush(w))
+		return -1;
+	memcpy(&w->buffer[w->length], s, n);
+	w->length += n;
+	return 0;
+}
+
+/**
+ * Write the header of a .cube file
+ * 
+ * @param   w        The output buffer
+ * @param   keyword  "LUT_1D_SIZE" or "LUT_3D_SIZE"
+ * @param   size     The size of the lookup table
+ * @param   title    The title of the lookup table, `NULL` if none
+ * @return           Zero on success, -1 on error
+ */
+static int
+cube_header(struct cube_writer *w, const char *keyword, size_t size, const char *title)
+{
+	char number[3 * sizeof(size_t) + 2], *p = &number[sizeof(number) - 1];
+	if (title && (strpbrk(title, "\"\r\n") || strlen(title) >= LIBCLUT_CUBE_LINE_MAX))
+		return errno = EINVAL, -1;
+	if (title && (cube_puts(w, "TITLE \"") || cube_puts(w, title) || cube_puts(w, "\"\n")))
+		return -1;
+	*p = '\0';
+	*--p = '\n';
+	do {
+		*--p = (char)('0' + size % 10);
+	} while (size /= 10);
+	return cube_puts(w, keyword) || cube_puts(w, " ") || cube_puts(w, p);
+}
+
+/**
+ * Write an entry, that is, a line with a red, green, and
+ * blue value, to a .cube file, each value is written with
+ * six decimals without using the current locale
+ * 
+ * @param   w      The output buffer
+ * @param   value  The red, green, and blue value
+ * @return         Zero on success, -1 on error
+ */
+static int
+cube_entry(struct cube_writer *w, const double value[3])
+{
+	char digits[20], *p;
+	uint64_t n;
+	double x;
+	int i, k;
+
+	if (w->length + 3 * 22 > sizeof(w->buffer) && cube_flush(w))
+		return -1;
+	p = &w->buffer[w->length];
+	for (k = 0; k < 3; k++) {
+		x = value[k];
+		if (!(x >= -1e12 && x <= 1e12))
+			x = x > 0 ? 1e12 : x < 0 ? -1e12 : 0;
+		n = (uint64_t)((x < 0 ? -x : x) * 1000000 + 0.5);
+		if (x < 0 && n)
+			*p++ = '-';
+		for (i = 0; i < 7 || n; i++, n /= 10)
+			digits[i] = (char)('0' + n % 10);
+		while (i > 6)
+			*p++ = digits[--i];
+		*p++ = '.';
+		while (i)
+			*p++ = digits[--i];
+		*p++ = k < 2 ? ' ' : '\n';
+	}
+	w->length = (size_t)(p - w->buffer);
+	return 0;
+}
+
+/**
+ * Save a 1D lookup table as a .cube file
+ * 
+ * @param   fd          File descriptor for the file to write,
+ *                      must not be nonblocking
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         The red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       The green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        The blue ramp
+ * @param   title       The title of the lookup table, `NULL` if none
+ * @return              Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `type` is invalid, the ramps do not have the same
+ *                  size, the size is less than 2 or greater than
+ *                  65536, or `title` contains a quotation mark or
+ *                  a line break
+ * @throws          Any error specified for write(3)
+ */
+int
+libclut_cube_save_ramps_file(int fd, libclut_element_type_t type, double max, size_t red_size, const void *red,
+                             size_t green_size, const void *green, size_t blue_size, const void *blue,
+                             const char *title)
+{
+	struct cube_writer w;
+	double value[3];
+	size_t i;
+
+	if (!element_size(type) || red_size != green_size || red_size != blue_size || red_size < 2 || red_size > 65536)
+		return errno = EINVAL, -1;
+
+	w.fd = fd;
+	w.length = 0;
+	if (cube_header(&w, "LUT_1D_SIZE", red_size, title))
+		return -1;
+	for (i = 0; i < red_size; i++) {
+		value[0] = get_element(type, red,   i) / max;
+		value[1] = get_element(type, green, i) / max;
+		value[2] = get_element(type, blue,  i) / max;
+		if (cube_entry(&w, value))
+			return -1;
+	}
+	return cube_flush(&w);
+}
+
+/**
+ * Save a 3D lookup table as a .cube file
+ * 
+ * @param   fd     File descriptor for the file to write,
+ *                 must not be nonblocking
+ * @param   type   The data type used for each element in the lookup table
+ * @param   max    The maximum value on each element in the lookup table
+ * @param   size   The number of lattice points along each axis
+ * @param   data   The lookup table, see `libclut_3d_index`
+ * @param   title  The title of the lookup table, `NULL` if none
+ * @return         Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `type` is invalid, `size` is less than 2 or
+ *                  greater than 256, or `title` contains
+ *                  a quotation mark or a line break
+ * @throws          Any error specified for write(3)
+ */
+int
+libclut_cube_save_3d_file(int fd, libclut_element_type_t type, double max, size_t size, const void *data,
+                          const char *title)
+{
+	struct cube_writer w;
+	double value[3];
+	size_t i, n = 3 * size * size * size;
+
+	if (!element_size(type) || size < 2 || size > 256)
+		return errno = EINVAL, -1;
+
+	w.fd = fd;
+	w.length = 0;
+	if (cube_header(&w, "LUT_3D_SIZE", size, title))
+		return -1;
+	for (i = 0; i < n; i += 3) {
+		value[0] = get_element(type, data, i + 0) / max;
+		value[1] = get_element(type, data, i + 1) / max;
+		value[2] = get_element(type, data, i + 2) / max;
+		if (cube_entry(&w, value))
+			return -1;
+	}
+	return cube_flush(&w);
+}
+
+/**
+ * Check whether a character is white space within a line
+ * 
+ * @param   c  The character
+ * @return     1 if `c` is a space, a tab, or a carriage
+ *             return, 0 otherwise
+ */
+static int
+cube_blank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * Parse a number in a .cube file, without using the current locale
+ * 
+ * The result is exact for numbers with at most 15 significant
+ * digits and at most 22 decimals, which covers all numbers
+ * written by programs that create .cube files
+ * 
+ * @param   s    The text to parse
+ * @param   end  The end of the text
+ * @param   out  Output parameter for the number
+ * @return       The end of the number, `NULL` if `s`
+ *               does not begin with a number followed
+ *               by white space or the end of the text
+ */
+static const char *
+cube_number(const char *s, const char *end, double *out)
+{
+	static const double powers[] = {
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	uint64_t m = 0;
+	int digits = 0, exp = 0, e = 0, neg = 0, eneg = 0;
+	double x;
+
+	if (s != end && (*s == '-' || *s == '+'))
+		neg = *s++ == '-';
+	for (; s != end && (unsigned)(*s - '0') < 10; s++, digits++) {
+		if (m < UINT64_C(1000000000000000000))
+			m = m * 10 + (uint64_t)(*s - '0');
+		else
+			exp++;
+	}
+	if (s != end && *s == '.') {
+		for (s++; s != end && (unsigned)(*s - '0') < 10; s++, digits++) {
+			if (m < UINT64_C(1000000000000000000))
+				m = m * 10 + (uint64_t)(*s - '0'), exp--;
+		}
+	}
+	if (!digits)
+		return NULL;
+	if (s != end && (*s == 'e' || *s == 'E')) {
+		s++;
+		if (s != end && (*s == '-' || *s == '+'))
+			eneg = *s++ == '-';
+		if (s == end || (unsigned)(*s - '0') >= 10)
+			return NULL;
+		for (; s != end && (unsigned)(*s - '0') < 10; s++)
+			if (e < 10000)
+				e = e * 10 + (*s - '0');
+		exp += eneg ? -e : e;
+	}
+	if (s != end && !cube_blank(*s))
+		return NULL;
+
+	x = (double)m;
+	if (exp < 0) {
+		for (; exp < -22; exp += 22)
+			x /= 1e22;
+		x /= powers[-exp];
+	} else {
+		for (; exp > 22; exp -= 22)
+			x *= 1e22;
+		x *= powers[exp];
+	}
+	*out = neg ? -x : x;
+	return s;
+}
+
+/**
+ * Parse the numbers after a keyword, or of an entry, in a .cube file
+ * 
+ * @param   s    The text after the keyword, or the entry
+ * @param   end  The end of the line, after trailing white space
+ * @param   out  Output parameter for the numbers
+ * @param   n    The number of numbers to parse
+ * @return       Zero on success, -1 if the line is invalid
+ */
+static int
+cube_numbers(const char *s, const char *end, double *out, size_t n)
+{
+	while (n--) {
+		while (s != end && cube_blank(*s))
+			s++;
+		if (!(s = cube_number(s, end, out++)))
+			return -1;
+	}
+	while (s != end && cube_blank(*s))
+		s++;
+	return s == end || *s == '#' ? 0 : -1;
+}
+
+/**
+ * Parse the size of a lookup table in a .cube file
+ * 
+ * @param   s    The text after the keyword
+ * @param   end  The end of the line, after trailing white space
+ * @param   max  The maximum allowed size
+ * @param   out  Output parameter for the size
+ * @return       Zero on success, -1 if the line is invalid
+ */
+static int
+cube_size(const char *s, const char *end, size_t max, size_t *out)
+{
+	size_t n = 0;
+	while (s != end && cube_blank(*s))
+		s++;
+	if (s == end)
+		return -1;
+	for (; s != end && (unsigned)(*s - '0') < 10; s++)
+		if ((n = n * 10 + (size_t)(*s - '0')) > max)
+			return -1;
+	while (s != end && cube_blank(*s))
+		s++;
+	if (n < 2 || (s != end && *s != '#'))
+		return -1;
+	*out = n;
+	return 0;
+}
+
+/**
+ * Parse a line in a .cube file
+ * 
+ * @param   cube    The parser
+ * @param   s       The line, without the line break; may be truncated
+ *                  to `LIBCLUT_CUBE_LINE_MAX` bytes if it is too long
+ * @param   end     The end of `s`
+ * @param   length  The length of the line, before truncation
+ * @return          Zero on success, -1 on error
+ */
+static int
+cube_line(libclut_cube_t *cube, const char *s, const char *end, size_t length)
+{
+	const char *k;
+	double v[3], *buf;
+	size_t n, i;
+
+	while (s != end && cube_blank(*s))
+		s++;
+	while (end != s && cube_blank(end[-1]))
+		end--;
+	if (s == end || *s == '#')
+		return 0;
+
+	if (*s == '-' || *s == '+' || *s == '.' || (unsigned)(*s - '0') < 10) {
+		if (length > LIBCLUT_CUBE_LINE_MAX)
+			goto invalid;
+		if (!cube->count) {
+			n = 3 * cube->red_size + 3 * cube->size * cube->size * cube->size;
+			for (i = 0; i < 3; i++)
+				if (!(cube->domain_min[i] < cube->domain_max[i]))
+					goto invalid;
+			if (!n)
+				goto invalid;
+			if (!(buf = malloc(n * sizeof(double))))
+				return errno = ENOMEM, -1;
+			if (cube->red_size)
+				cube->blue = (cube->green = (cube->red = buf) + cube->red_size) + cube->red_size;
+			if (cube->size)
+				cube->data = buf + 3 * cube->red_size;
+			cube->green_size = cube->blue_size = cube->red_size;
+		}
+		if (cube->count == cube->red_size + cube->size * cube->size * cube->size)
+			goto invalid;
+		if (cube_numbers(s, end, v, 3))
+			goto invalid;
+		if (cube->count < cube->red_size) {
+			i = cube->count;
+			cube->red[i] = v[0], cube->green[i] = v[1], cube->blue[i] = v[2];
+		} else {
+			i = 3 * (cube->count - cube->red_size);
+			cube->data[i + 0] = v[0], cube->data[i + 1] = v[1], cube->data[i + 2] = v[2];
+		}
+		cube->count += 1;
+		return 0;
+	}
+
+	for (k = s; k != end && !cube_blank(*k); k++);
+	n = (size_t)(k - s);
+#define KEYWORD(KW) (n == sizeof(KW) - 1 && !memcmp(s, KW, n))
+	if (cube->count)
+		goto invalid;
+	if (KEYWORD("TITLE")) {
+		while (k != end && cube_blank(*k))
+			k++;
+		if (k == end || *k++ != '"')
+			goto invalid;
+		if (k != end && end[-1] == '"')
+			end--;
+		n = (size_t)(end - k);
+		n = n < LIBCLUT_CUBE_LINE_MAX - 1 ? n : LIBCLUT_CUBE_LINE_MAX - 1;
+		memcpy(cube->title, k, n);
+		cube->title[n] = '\0';
+		return 0;
+	}
+	if (length > LIBCLUT_CUBE_LINE_MAX)
+		goto invalid;
+	if (KEYWORD("LUT_1D_SIZE")) {
+		if (cube_size(k, end, 65536, &cube->red_size))
+			goto invalid;
+	} else if (KEYWORD("LUT_3D_SIZE")) {
+		if (cube_size(k, end, 256, &cube->size))
+			goto invalid;
+	} else if (KEYWORD("DOMAIN_MIN")) {
+		if (cube_numbers(k, end, cube->domain_min, 3))
+			goto invalid;
+	} else if (KEYWORD("DOMAIN_MAX")) {
+		if (cube_numbers(k, end, cube->domain_max, 3))
+			goto invalid;
+	} else if (KEYWORD("LUT_1D_INPUT_RANGE") || KEYWORD("LUT_3D_INPUT_RANGE")) {
+		if (cube_numbers(k, end, v, 2))
+			goto invalid;
+		cube->domain_min[0] = cube->domain_min[1] = cube->domain_min[2] = v[0];
+		cube->domain_max[0] = cube->domain_max[1] = cube->domain_max[2] = v[1];
+	}
+#undef KEYWORD
+	return 0;
+
+invalid:
+	return errno = EINVAL, -1;
+}
+
+/**
+ * Initialise a .cube parser
+ * 
+ * @param  cube  The parser, and output parameter for the parsed file
+ */
+void
+libclut_cube_init(libclut_cube_t *cube)
+{
+	memset(cube, 0, sizeof(*cube));
+	cube->red = cube->green = cube->blue = cube->data = NULL;
+	cube->domain_max[0] = cube->domain_max[1] = cube->domain_max[2] = 1;
+}
+
+/**
+ * Feed the next part of a .cube file to the parser
+ * 
+ * @param   cube  The parser, initialised with `libclut_cube_init`
+ * @param   data  The next part of the file
+ * @param   n     The size of `data`, 0 at the end of the file
+ * @return        Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  The file is not a valid .cube file
+ * @throws  ENOMEM  Insufficient memory is available
+ */
+int
+libclut_cube_parse(libclut_cube_t *cube, const void *data, size_t n)
+{
+	const char *s = data, *end = s + n, *nl;
+	size_t len, m;
+
+	if (cube->error)
+		return errno = cube->error, -1;
+
+	if (!n) {
+		m = cube->line_length < LIBCLUT_CUBE_LINE_MAX ? cube->line_length : LIBCLUT_CUBE_LINE_MAX;
+		if (cube_line(cube, cube->line, cube->line + m, cube->line_length))
+			goto fail;
+		cube->line_length = 0;
+		if (!cube->count || cube->count != cube->red_size + cube->size * cube->size * cube->size) {
+			errno = EINVAL;
+			goto fail;
+		}
+		return 0;
+	}
+
+	while (s != end) {
+		nl = memchr(s, '\n', (size_t)(end - s));
+		len = (size_t)((nl ? nl : end) - s);
+		if (nl && !cube->line_length) {
+			if (cube_line(cube, s, nl, len))
+				goto fail;
+		} else {
+			if (cube->line_length < LIBCLUT_CUBE_LINE_MAX) {
+				m = LIBCLUT_CUBE_LINE_MAX - cube->line_length;
+				memcpy(&cube->line[cube->line_length], s, len < m ? len : m);
+			}
+			cube->line_length += len;
+			if (nl) {
+				m = cube->line_length < LIBCLUT_CUBE_LINE_MAX ? cube->line_length : LIBCLUT_CUBE_LINE_MAX;
+				if (cube_line(cube, cube->line, cube->line + m, cube->line_length))
+					goto fail;
+				cube->line_length = 0;
+			}
+		}
+		s += len + !!nl;
+	}
+	return 0;
+
+fail:
+	cube->error = errno;
+	return -1;
+}
+
+/**
+ * Load a .cube file
+ * 
+ * @param   fd    File descriptor for the file to read
+ * @param   cube  Output parameter for the parsed file,
+ *                release with `libclut_cube_destroy`
+ * @return        Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  The file is not a valid .cube file
+ * @throws  ENOMEM  Insufficient memory is available
+ * @throws          Any error specified for read(3)
+ */
+int
+libclut_cube_load(int fd, libclut_cube_t *cube)
+{
+	char buf[4096];
+	ssize_t r;
+	int saved_errno;
+
+	libclut_cube_init(cube);
+	for (;;) {
+		r = read(fd, buf, sizeof(buf));
+		if (r < 0) {
+			if (errno == EINTR)
+				continue;
+			goto fail;
+		}
+		if (libclut_cube_parse(cube, buf, (size_t)r))
+			goto fail;
+		if (!r)
+			return 0;
+	}
+
+fail:
+	saved_errno = errno;
+	libclut_cube_destroy(cube);
+	errno = saved_errno;
+	return -1;
+}
+
+/**
+ * Release the lookup tables of a .cube parser
+ * 
+ * @param  cube  The parser
+ */
+void
+libclut_cube_destroy(libclut_cube_t *cube)
+{
+	free(cube->red ? cube->red : cube->data);
+	cube->red = cube->green = cube->blue = cube->data = NULL;
+	cube->red_size = cube->green_size = cube->blue_size = cube->size = 0;
+	cube->count = 0;
+}
+
+/**
+ * Set an element in an array of any element type
+ * 
+ * For integer types, the value is rounded to nearest
+ * and saturated to the range of the type
+ * 
+ * @param  type   The element type, must be valid
+ * @param  data   The array
+ * @param  i      The index of the element
+ * @param  value  The new value of the element
+ */
+static void
+set_element(libclut_element_type_t type, void *data, size_t i, double value)
+{
+	if (type != LIBCLUT_ELEMENT_FLOAT && type != LIBCLUT_ELEMENT_DOUBLE)
+		value = value > 0 ? value + 0.5 : 0;
+	switch (type) {
+	case LIBCLUT_ELEMENT_UINT8:
+		((uint8_t *)data)[i] = value < (double)UINT8_MAX ? (uint8_t)value : UINT8_MAX;
+		break;
+	case LIBCLUT_ELEMENT_UINT16:
+		((uint16_t *)data)[i] = value < (double)UINT16_MAX ? (uint16_t)value : UINT16_MAX;
+		break;
+	case LIBCLUT_ELEMENT_UINT32:
+		((uint32_t *)data)[i] = value < (double)UINT32_MAX ? (uint32_t)value : UINT32_MAX;
+		break;
+	case LIBCLUT_ELEMENT_UINT64:
+		((uint64_t *)data)[i] = value < 18446744073709551616. ? (uint64_t)value : UINT64_MAX;
+		break;
+	case LIBCLUT_ELEMENT_FLOAT:
+		((float *)data)[i] = (float)value;
+		break;
+	default:
+		((double *)data)[i] = value;
+		break;
+	}
+}
+
+/**
+ * Pass values through one channel of gamma ramps
+ * 
+ * @param  ramps    The gamma ramps
+ * @param  channel  0 for the red ramp, 1 for the
+ *                  green ramp, 2 for the blue ramp
+ * @param  x        The values, in [0, 1], that shall be replaced
+ *                  with their mapped values, divided by the
+ *                  maximum value of the ramps
+ * @param  n        The number of values
+ */
+static void
+compose_stage(const libclut_ramps_t *ramps, int channel, double *x, size_t n)
+{
+	size_t size = channel == 0 ? ramps->red_size : channel == 1 ? ramps->green_size : ramps->blue_size;
+	const void *ramp = channel == 0 ? ramps->red : channel == 1 ? ramps->green : ramps->blue;
+	double m = (double)(size - 1), p, f, y;
+	size_t i, j;
+
+	for (i = 0; i < n; i++) {
+		p = x[i] * m;
+		p = p > 0 ? (p < m ? p : m) : 0;
+		j = (size_t)p;
+		y = get_element(ramps->type, ramp, j);
+		if (j + 1 < size) {
+			f = p - (double)j;
+			y += (get_element(ramps->type, ramp, j + 1) - y) * f;
+		}
+		x[i] = y / ramps->max;
+	}
+}
+
+/**
+ * Replace gamma ramps with the composition of a chain of gamma ramps
+ * 
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         The red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       The green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        The blue ramp
+ * @param   n           The number of ramps in the chain
+ * @param   stages      The chain, in the order the ramps shall be applied
+ * @return              Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  A data type is invalid, or a ramp in the chain is
+ *                  empty or does not have a positive maximum value
+ * @throws  ENOMEM  Insufficient memory is available
+ */
+int
+libclut_compose_ramps(libclut_element_type_t type, double max, size_t red_size, void *red,
+                      size_t green_size, void *green, size_t blue_size, void *blue,
+                      size_t n, const libclut_ramps_t *stages)
+{
+	size_t sizes[3], size, i, k;
+	void *ramps[3];
+	double *x, y;
+	int c, integer = type != LIBCLUT_ELEMENT_FLOAT && type != LIBCLUT_ELEMENT_DOUBLE;
+
+	if (!element_size(type))
+		return errno = EINVAL, -1;
+	for (k = 0; k < n; k++)
+		if (!element_size(stages[k].type) || !stages[k].red_size || !stages[k].green_size || !stages[k].blue_size ||
+		    !(stages[k].max > 0))
+			return errno = EINVAL, -1;
+
+	sizes[0] = red_size, sizes[1] = green_size, sizes[2] = blue_size;
+	ramps[0] = red, ramps[1] = green, ramps[2] = blue;
+	size = red_size > green_size ? red_size : green_size;
+	size = size > blue_size ? size : blue_size;
+	if (!size)
+		return 0;
+	if (!(x = malloc(size * sizeof(*x))))
+		return errno = ENOMEM, -1;
+
+	for (c = 0; c < 3; c++) {
+		size = sizes[c];
+		for (i = 0; i < size; i++)
+			x[i] = size > 1 ? (double)i / (double)(size - 1) : 0;
+		for (k = 0; k < n; k++)
+			compose_stage(&stages[k], c, x, size);
+		for (i = 0; i < size; i++) {
+			y = x[i] * max;
+			if (integer)
+				y = y < max ? y : max;
+			set_element(type, ramps[c], i, y);
+		}
+	}
+
+	free(x);
+	return 0;
+}
+
+/**
+ * Rotate a 64-bit integer to the left
+ * 
+ * @param   x  The integer
+ * @param   n  The number of bits to rotate, 1 to 63
+ * @return     The rotated integer
+ */
+static uint64_t
+rotl64(uint64_t x, int n)
+{
+	return x << n | x >> (64 - n);
+}
+
+/**
+ * Mix a 64-bit word into a hash
+ * 
+ * @param   h  The hash
+ * @param   k  The word
+ * @return     The new hash
+ */
+static uint64_t
+hash_word(uint64_t h, uint64_t k)
+{
+	k *= UINT64_C(0x87c37b91114253d5);
+	k = rotl64(k, 31);
+	k *= UINT64_C(0x4cf5ad432745937f);
+	h ^= k;
+	return rotl64(h, 27) * 5 + UINT64_C(0x52dce729);
+}
+
+/**
+ * Finalise a hash so that all bits depend on all input bits
+ * 
+ * @param   h  The hash
+ * @return     The finalised hash
+ */
+static uint64_t
+hash_final(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= UINT64_C(0xff51afd7ed558ccd);
+	h ^= h >> 33;
+	h *= UINT64_C(0xc4ceb9fe1a85ec53);
+	return h ^ (h >> 33);
+}
+
+/**
+ * Mix a buffer into a hash, including its size
+ * 
+ * @param   h     The hash
+ * @param   data  The buffer
+ * @param   n     The size of the buffer, in bytes
+ * @return        The new hash
+ */
+static uint64_t
+hash_bytes(uint64_t h, const void *data, size_t n)
+{
+	const unsigned char *p = data;
+	uint64_t k;
+	h = hash_word(h, (uint64_t)n);
+	for (; n >= 8; p += 8, n -= 8) {
+		memcpy(&k, p, 8);
+		h = hash_word(h, k);
+	}
+	if (n) {
+		k = 0;
+		memcpy(&k, p, n);
+		h = hash_word(h, k);
+	}
+	return h;
+}
+
+/**
+ * Mix a `double` into a hash, negative zero is
+ * treated as positive zero, and all NaN values
+ * are treated as the same value
+ * 
+ * @param   h  The hash
+ * @param   x  The value
+ * @return     The new hash
+ */
+static uint64_t
+hash_double(uint64_t h, double x)
+{
+	uint64_t k;
+	if (isnan(x))
+		k = UINT64_C(0x7ff8000000000000);
+	else if (libclut_0__(x))
+		k = 0;
+	else
+		memcpy(&k, &x, 8);
+	return hash_word(h, k);
+}
+
+/**
+ * Calculate a 64-bit hash of gamma ramps
+ * 
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         The red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       The green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        The blue ramp
+ * @return              The hash of the ramps, 0 if `type` is invalid
+ */
+uint64_t
+libclut_hash_ramps(libclut_element_type_t type, double max, size_t red_size, const void *red,
+                   size_t green_size, const void *green, size_t blue_size, const void *blue)
+{
+	size_t esize = element_size(type);
+	uint64_t h;
+	if (!esize)
+		return 0;
+	h = hash_word(UINT64_C(0x6c6962636c757421), (uint64_t)type);
+	h = hash_double(h, max);
+	h = hash_bytes(h, red,   red_size   * esize);
+	h = hash_bytes(h, green, green_size * esize);
+	h = hash_bytes(h, blue,  blue_size  * esize);
+	return hash_final(h);
+}
+
+/**
+ * Extend a 64-bit hash of a sequence of operations with another operation
+ * 
+ * @param   hash    The hash of the previous operations, 0 if none
+ * @param   name    The name of the operation
+ * @param   n       The number of parameters of the operation
+ * @param   params  The parameters of the operation
+ * @return          The hash of the operations
+ */
+uint64_t
+libclut_hash_operation(uint64_t hash, const char *name, size_t n, const double *params)
+{
+	uint64_t h = hash_bytes(hash, name, strlen(name));
+	h = hash_word(h, (uint64_t)n);
+	while (n--)
+		h = hash_double(h, *params++);
+	return hash_final(h);
+}
+
+/**
+ * Initialise a gamma ramp cache
+ * 
+ * @param   cache     The cache
+ * @param   capacity  The maximum number of ramp sets in the cache
+ * @return            Zero on success, -1 on error
+ * 
+ * @throws  ENOMEM  Insufficient memory is available
+ */
+int
+libclut_cache_init(libclut_cache_t *cache, size_t capacity)
+{
+	size_t i;
+	cache->capacity = capacity;
+	cache->hits = cache->misses = cache->tick = 0;
+	cache->entries = NULL;
+	if (!capacity)
+		return 0;
+	if (capacity > SIZE_MAX / sizeof(*cache->entries))
+		return errno = ENOMEM, -1;
+	if (!(cache->entries = malloc(capacity * sizeof(*cache->entries))))
+		return errno = ENOMEM, -1;
+	for (i = 0; i < capacity; i++) {
+		cache->entries[i].ramps = NULL;
+		cache->entries[i].last_used = 0;
+	}
+	return 0;
+}
+
+/**
+ * Release all resources in a gamma ramp cache
+ * 
+ * @param  cache  The cache
+ */
+void
+libclut_cache_destroy(libclut_cache_t *cache)
+{
+	size_t i;
+	for (i = 0; i < cache->capacity && cache->entries; i++)
+		free(cache->entries[i].ramps);
+	free(cache->entries);
+	cache->entries = NULL;
+	cache->capacity = 0;
+}
+
+/**
+ * Store a copy of computed gamma ramps in a cache
+ * 
+ * @param   cache       The cache
+ * @param   input       The hash of the input ramps
+ * @param   operation   The hash of the operations that were applied
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         The red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       The green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        The blue ramp
+ * @return              Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `type` is invalid
+ * @throws  ENOMEM  Insufficient memory is available
+ */
+int
+libclut_cache_store_ramps(libclut_cache_t *cache, uint64_t input, uint64_t operation, libclut_element_type_t type,
+                          double max, size_t red_size, const void *red, size_t green_size, const void *green,
+                          size_t blue_size, const void *blue)
+{
+	struct libclut_cache_entry *e, *victim = NULL;
+	size_t esize = element_size(type), i;
+	char *ramps;
+
+	if (!esize)
+		return errno = EINVAL, -1;
+	if (!cache->capacity)
+		return 0;
+
+	for (i = 0; i < cache->capacity; i++) {
+		e = &cache->entries[i];
+		if (e->ramps && e->input == input && e->operation == operation) {
+			victim = e;
+			break;
+		}
+		if (!victim || (victim->ramps && (!e->ramps || e->last_used < victim->last_used)))
+			victim = e;
+	}
+
+	/* Allocate at least one byte, as `ramps` is used to mark the entry as in use */
+	if (!(ramps = malloc((red_size + green_size + blue_size) * esize + 1)))
+		return errno = ENOMEM, -1;
+	memcpy(ramps, red, red_size * esize);
+	memcpy(ramps + red_size * esize, green, green_size * esize);
+	memcpy(ramps + (red_size + green_size) * esize, blue, blue_size * esize);
+
+	free(victim->ramps);
+	victim->input = input;
+	victim->operation = operation;
+	victim->last_used = ++cache->tick;
+	victim->type = type;
+	victim->max = max;
+	victim->red_size = red_size;
+	victim->green_size = green_size;
+	victim->blue_size = blue_size;
+	victim->ramps = ramps;
+	return 0;
+}
+
+/**
+ * Copy gamma ramps from a cache
+ * 
+ * @param   cache       The cache
+ * @param   input       The hash of the input ramps
+ * @param   operation   The hash of the operations to apply
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         Output parameter for the red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       Output parameter for the green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        Output parameter for the blue ramp
+ * @return              1 if the ramps were copied from the cache,
+ *                      0 if the cache does not have the ramps
+ */
+int
+libclut_cache_fetch_ramps(libclut_cache_t *cache, uint64_t input, uint64_t operation, libclut_element_type_t type,
+                          double max, size_t red_size, void *red, size_t green_size, void *green,
+                          size_t blue_size, void *blue)
+{
+	struct libclut_cache_entry *e;
+	size_t esize = element_size(type), i;
+	const char *ramps;
+
+	for (i = 0; i < cache->capacity; i++) {
+		e = &cache->entries[i];
+		if (!e->ramps || e->input != input || e->operation != operation)
+			continue;
+		if (e->type != type || !libclut_eq__(e->max, max) || e->red_size != red_size ||
+		    e->green_size != green_size || e->blue_size != blue_size)
+			break;
+		ramps = e->ramps;
+		memcpy(red, ramps, red_size * esize);
+		memcpy(green, ramps + red_size * esize, green_size * esize);
+		memcpy(blue, ramps + (red_size + green_size) * esize, blue_size * esize);
+		e->last_used = ++cache->tick;
+		cache->hits += 1;
+		return 1;
+	}
+	cache->misses += 1;
+	return 0;
+}
+
+/**
+ * Calculate the cube root of a value, with a relative error
+ * of about 1e-12, for the CIE L*a*b* conversion
+ * 
+ * @param   x  The value, must be positive and finite
+ * @return     The cube root of `x`
+ */
+static inline double
+lab_cbrt(double x)
+{
+	uint64_t i;
+	double y;
+	memcpy(&i, &x, sizeof(i));
+	i = i / 3 + UINT64_C(0x2a9f7893782da1ce);
+	memcpy(&y, &i, sizeof(y));
+	y = (2 * y + x / (y * y)) * (1. / 3);
+	y = (2 * y + x / (y * y)) * (1. / 3);
+	y = (2 * y + x / (y * y)) * (1. / 3);
+	return y;
+}
+
+/**
+ * The part of the CIE XYZ to CIE L*a*b* conversion
+ * that is applied to each component, without branching
+ * 
+ * @param   c  The X, Y, or Z component, divided by the
+ *             corresponding component of the white point
+ * @return     The transformed component
+ */
+static inline double
+lab_f(double c)
+{
+	double lin = (7.78 + 703.0 / 99900) * c + 0.1379310;
+	double cub = lab_cbrt(c > 0.00885642 ? c : 0.00885642);
+	return c > 0.00885642 ? cub : lin;
+}
+
+/**
+ * The inverse of `lab_f`, without branching
+ * 
+ * @param   c  The transformed component
+ * @return     The X, Y, or Z component, divided by the
+ *             corresponding component of the white point
+ */
+static inline double
+lab_f_inverse(double c)
+{
+	double cub = c * c * c;
+	double lin = (c - 0.1379310) * (1 / (7.78 + 703.0 / 99900));
+	return cub > 0.00885642 ? cub : lin;
+}
+
+/**
+ * Convert many colours from CIE XYZ to CIE L*a*b*
+ * 
+ * @param  xyz  The X, Y, and Z parameters, interleaved
+ * @param  lab  Output parameter for the L*, a*, and b* components,
+ *              interleaved, may be `xyz`
+ * @param  n    The number of colours
+ */
+void
+libclut_model_ciexyz_to_cielab_batch(const double *xyz, double *lab, size_t n)
+{
+	double X, Y, Z;
+	size_t i;
+	for (i = 0; i < 3 * n; i += 3) {
+		X = lab_f(xyz[i + 0] * (1 / 0.95047));
+		Y = lab_f(xyz[i + 1]);
+		Z = lab_f(xyz[i + 2] * (1 / 1.08883));
+		lab[i + 0] = 116 * Y - 16;
+		lab[i + 1] = 500 * (X - Y);
+		lab[i + 2] = 200 * (Y - Z);
+	}
+}
+
+/**
+ * Convert many colours from CIE L*a*b* to CIE XYZ
+ * 
+ * @param  lab  The L*, a*, and b* components, interleaved
+ * @param  xyz  Output parameter for the X, Y, and Z parameters,
+ *              interleaved, may be `lab`
+ * @param  n    The number of colours
+ */
+void
+libclut_model_cielab_to_ciexyz_batch(const double *lab, double *xyz, size_t n)
+{
+	double X, Y, Z;
+	size_t i;
+	for (i = 0; i < 3 * n; i += 3) {
+		Y = (lab[i + 0] + 16) * (1. / 116);
+		X = lab[i + 1] * (1. / 500) + Y;
+		Z = Y - lab[i + 2] * (1. / 200);
+		xyz[i + 0] = lab_f_inverse(X) * 0.95047;
+		xyz[i + 1] = lab_f_inverse(Y);
+		xyz[i + 2] = lab_f_inverse(Z) * 1.08883;
+	}
+}
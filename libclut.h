@@ -3,9 +3,14 @@
 #define LIBCLUT_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <math.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 
 /* Not documented, may be removed or modified in the future. */
 #define LIBCLUT_ILLUMINANT_A    .white_x = 0.44757, .white_y = 0.40745, .white_Y = 1
@@ -42,338 +47,470 @@
 	.red_x   = 0.6400, .red_y   = 0.3300, .red_Y   = 0.212656,\
 	.green_x = 0.3000, .green_y = 0.6000, .green_Y = 0.715158,\
 	.blue_x  = 0.1500, .blue_y  = 0.0600, .blue_Y  = 0.072186,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_SRGB, 0}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the Adobe RGB (1998) colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_ADOBE_RGB_INITIALISER {\
 	.red_x   = 0.6400, .red_y   = 0.3300, .red_Y   = 0.297361,\
 	.green_x = 0.2100, .green_y = 0.7100, .green_Y = 0.627355,\
 	.blue_x  = 0.1500, .blue_y  = 0.0600, .blue_Y  = 0.075285,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the Apple RGB colour space
  * 
- * This colour space's gamma is 1.8. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 1.8. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_APPLE_RGB_INITIALISER {\
 	.red_x   = 0.6250, .red_y   = 0.3400, .red_Y   = 0.244634,\
 	.green_x = 0.2800, .green_y = 0.5950, .green_Y = 0.672034,\
 	.blue_x  = 0.1550, .blue_y  = 0.0700, .blue_Y  = 0.083332,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 1.8}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the Best RGB colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_BEST_RGB_INITIALISER {\
 	.red_x   = 0.7347, .red_y   = 0.2653, .red_Y   = 0.228457,\
 	.green_x = 0.2150, .green_y = 0.7750, .green_Y = 0.737352,\
 	.blue_x  = 0.1300, .blue_y  = 0.0350, .blue_Y  = 0.034191,\
-	LIBCLUT_ILLUMINANT_D50}
+	LIBCLUT_ILLUMINANT_D50,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the Beta RGB colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_BETA_RGB_INITIALISER {\
 	.red_x   = 0.6888, .red_y   = 0.3112, .red_Y   = 0.303273,\
 	.green_x = 0.1986, .green_y = 0.7551, .green_Y = 0.663786,\
 	.blue_x  = 0.1265, .blue_y  = 0.0352, .blue_Y  = 0.032941,\
-	LIBCLUT_ILLUMINANT_D50}
+	LIBCLUT_ILLUMINANT_D50,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the Bruce RGB colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_BRUCE_RGB_INITIALISER {\
 	.red_x   = 0.6400, .red_y   = 0.3300, .red_Y   = 0.240995,\
 	.green_x = 0.2800, .green_y = 0.6500, .green_Y = 0.683554,\
 	.blue_x  = 0.1500, .blue_y  = 0.0600, .blue_Y  = 0.075452,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the CIE RGB colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_CIE_RGB_INITIALISER {\
 	.red_x   = 0.7350, .red_y   = 0.2650, .red_Y   = 0.176204,\
 	.green_x = 0.2740, .green_y = 0.7170, .green_Y = 0.812985,\
 	.blue_x  = 0.1670, .blue_y  = 0.0090, .blue_Y  = 0.010811,\
-	LIBCLUT_ILLUMINANT_E}
+	LIBCLUT_ILLUMINANT_E,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the ColorMatch RGB colour space
  * 
- * This colour space's gamma is 1.8. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 1.8. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_COLORMATCH_RGB_INITIALISER {\
 	.red_x   = 0.6300, .red_y   = 0.3400, .red_Y   = 0.274884,\
 	.green_x = 0.2950, .green_y = 0.6050, .green_Y = 0.658132,\
 	.blue_x  = 0.1500, .blue_y  = 0.0750, .blue_Y  = 0.066985,\
-	LIBCLUT_ILLUMINANT_D50}
+	LIBCLUT_ILLUMINANT_D50,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 1.8}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the DCI-P3 D65 colour space
  * 
- * This colour space's gamma is 2.6. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.6. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_DCI_P3_D65_INITIALISER {\
 	.red_x   = 0.680, .red_y   = 0.320, .red_Y   = 0.22897344,\
 	.green_x = 0.265, .green_y = 0.690, .green_Y = 0.69175166,\
 	.blue_x  = 0.150, .blue_y  = 0.060, .blue_Y  = 0.07927490,\
-	LIBCLUT_ILLUMINANT_D50}
+	LIBCLUT_ILLUMINANT_D50,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.6}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the DCI-P3 Theater colour space
  * 
- * This colour space's gamma is 2.6. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.6. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_DCI_P3_THEATER_INITIALISER {\
 	.red_x   = 0.680, .red_y   = 0.320, .red_Y   = 0.20949168,\
 	.green_x = 0.265, .green_y = 0.690, .green_Y = 0.72159525,\
 	.blue_x  = 0.150, .blue_y  = 0.060, .blue_Y  = 0.06891307,\
-	.white_x = 0.314, .white_y = 0.351, .white_Y = 1}
+	.white_x = 0.314, .white_y = 0.351, .white_Y = 1,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.6}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the Don RGB 4 colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_DON_RGB_4_INITIALISER {\
 	.red_x   = 0.6960, .red_y   = 0.3000, .red_Y   = 0.278350,\
 	.green_x = 0.2150, .green_y = 0.7650, .green_Y = 0.687970,\
 	.blue_x  = 0.1300, .blue_y  = 0.0350, .blue_Y  = 0.033680,\
-	LIBCLUT_ILLUMINANT_D50}
+	LIBCLUT_ILLUMINANT_D50,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the ECI RGB v2 colour space
  * 
- * This colour space's used the L* gamma function. It cannot
- * be used with RGB colour space conversion unless the values are
- * tranlated into using the sRGB gamma function.
+ * This colour space uses the L* gamma function. It is described by the
+ * `transfer` member, but `libclut_convert_rgb`,
+ * `libclut_convert_rgb_inplace`, and `libclut_model_convert_rgb`
+ * assume the sRGB gamma function; use `libclut_convert_rgb_transfer`
+ * to convert values in this colour space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_ECI_RGB_V2_INITIALISER {\
 	.red_x   = 0.6700, .red_y   = 0.3300, .red_Y   = 0.320250,\
 	.green_x = 0.2100, .green_y = 0.7100, .green_Y = 0.602071,\
 	.blue_x  = 0.1400, .blue_y  = 0.0800, .blue_Y  = 0.077679,\
-	LIBCLUT_ILLUMINANT_D50}
+	LIBCLUT_ILLUMINANT_D50,\
+	.transfer = {LIBCLUT_TRANSFER_L_STAR, 0}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the Ekta Space PS5 colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_EKTA_SPACE_PS5_INITIALISER {\
 	.red_x   = 0.6950, .red_y   = 0.3050, .red_Y   = 0.260629,\
 	.green_x = 0.2600, .green_y = 0.7000, .green_Y = 0.734946,\
 	.blue_x  = 0.1100, .blue_y  = 0.0050, .blue_Y  = 0.004425,\
-	LIBCLUT_ILLUMINANT_D50}
+	LIBCLUT_ILLUMINANT_D50,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the ITU-R Recommendation BT.601 (ITU-R BT.601), 625 line colour
  * space
  * 
- * This colour space uses a custom gamma function. It cannot be used
- * with RGB colour space conversion unless the values are tranlated
- * into using the sRGB gamma function.
+ * This colour space uses a custom gamma function. It is described by
+ * the `transfer` member, but `libclut_convert_rgb`,
+ * `libclut_convert_rgb_inplace`, and `libclut_model_convert_rgb`
+ * assume the sRGB gamma function; use `libclut_convert_rgb_transfer`
+ * to convert values in this colour space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_601_625_LINE_INITIALISER {\
 	.red_x   = 0.640, .red_y   = 0.330, .red_Y   = 0.2220023,\
 	.green_x = 0.290, .green_y = 0.600, .green_Y = 0.7066689,\
 	.blue_x  = 0.150, .blue_y  = 0.060, .blue_Y  = 0.0713288,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_BT_709, 0}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the ITU-R Recommendation BT.601 (ITU-R BT.601), 525 line colour
  * space
  * 
- * This colour space uses a custom gamma function. It cannot be used
- * with RGB colour space conversion unless the values are tranlated
- * into using the sRGB gamma function.
+ * This colour space uses a custom gamma function. It is described by
+ * the `transfer` member, but `libclut_convert_rgb`,
+ * `libclut_convert_rgb_inplace`, and `libclut_model_convert_rgb`
+ * assume the sRGB gamma function; use `libclut_convert_rgb_transfer`
+ * to convert values in this colour space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_601_525_LINE_INITIALISER {\
 	.red_x   = 0.630, .red_y   = 0.340, .red_Y   = 0.2220023,\
 	.green_x = 0.310, .green_y = 0.595, .green_Y = 0.7066689,\
 	.blue_x  = 0.155, .blue_y  = 0.070, .blue_Y  = 0.0713288,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_BT_709, 0}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the ITU-R Recommendation BT.709 (ITU-R BT.709) colour space
  * 
- * This colour space's gamma is 2._. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space uses a custom gamma function. It is described by
+ * the `transfer` member, but `libclut_convert_rgb`,
+ * `libclut_convert_rgb_inplace`, and `libclut_model_convert_rgb`
+ * assume the sRGB gamma function; use `libclut_convert_rgb_transfer`
+ * to convert values in this colour space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_709_INITIALISER {\
 	.red_x   = 0.6400, .red_y   = 0.3300, .red_Y   = 0.212656,\
 	.green_x = 0.3000, .green_y = 0.6000, .green_Y = 0.715158,\
 	.blue_x  = 0.1500, .blue_y  = 0.0600, .blue_Y  = 0.072186,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_BT_709, 0}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the ITU-R Recommendation BT.2020 (ITU-R BT.2020) colour space
  * 
- * This colour space uses a custom gamma function. It cannot be used
- * with RGB colour space conversion unless the values are tranlated
- * into using the sRGB gamma function.
+ * This colour space uses a custom gamma function. It is described by
+ * the `transfer` member, but `libclut_convert_rgb`,
+ * `libclut_convert_rgb_inplace`, and `libclut_model_convert_rgb`
+ * assume the sRGB gamma function; use `libclut_convert_rgb_transfer`
+ * to convert values in this colour space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_2020_INITIALISER {\
 	.red_x   = 0.7080, .red_y   = 0.2920, .red_Y   = 0.2627296,\
 	.green_x = 0.1700, .green_y = 0.7970, .green_Y = 0.6767483,\
 	.blue_x  = 0.1310, .blue_y  = 0.0460, .blue_Y  = 0.0605221,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_BT_709, 0}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the ITU-R Recommendation BT.2100 (ITU-R BT.2100) colour space
  * 
- * This colour space uses a custom gamma function. It cannot be used
- * with RGB colour space conversion unless the values are tranlated
- * into using the sRGB gamma function.
+ * This colour space uses the SMPTE ST 2084 (PQ) transfer function,
+ * which is described by the `transfer` member. Set `.transfer.type`
+ * to `LIBCLUT_TRANSFER_HLG` for hybrid log-gamma. `libclut_convert_rgb`,
+ * `libclut_convert_rgb_inplace`, and `libclut_model_convert_rgb` assume
+ * the sRGB gamma function; use `libclut_convert_rgb_transfer` to
+ * convert values in this colour space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_2100_INITIALISER {\
 	.red_x   = 0.7080, .red_y   = 0.2920, .red_Y   = 0.2627296,\
 	.green_x = 0.1700, .green_y = 0.7970, .green_Y = 0.6767483,\
 	.blue_x  = 0.1310, .blue_y  = 0.0460, .blue_Y  = 0.0605221,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_PQ, 0}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the Lightroom RGB colour space
  * 
- * This colour space's gamma is 1 (linear). It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 1 (linear). It is described by the
+ * `transfer` member, but `libclut_convert_rgb`,
+ * `libclut_convert_rgb_inplace`, and `libclut_model_convert_rgb`
+ * assume the sRGB gamma function; use `libclut_convert_rgb_transfer`
+ * to convert values in this colour space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_LIGHTROOM_RGB_INITIALISER {\
 	.red_x   = 0.7347, .red_y   = 0.2653, .red_Y   = 0.288040,\
 	.green_x = 0.1596, .green_y = 0.8404, .green_Y = 0.711874,\
 	.blue_x  = 0.0366, .blue_y  = 0.0001, .blue_Y  = 0.000086,\
-	LIBCLUT_ILLUMINANT_D50}
+	LIBCLUT_ILLUMINANT_D50,\
+	.transfer = {LIBCLUT_TRANSFER_LINEAR, 0}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the NTSC RGB colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_NTSC_RGB_INITIALISER {\
 	.red_x   = 0.6700, .red_y   = 0.3300, .red_Y   = 0.298839,\
 	.green_x = 0.2100, .green_y = 0.7100, .green_Y = 0.586811,\
 	.blue_x  = 0.1400, .blue_y  = 0.0800, .blue_Y  = 0.114350,\
-	LIBCLUT_ILLUMINANT_C}
+	LIBCLUT_ILLUMINANT_C,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the PAL/SECAM RGB colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_PAL_SECAM_RGB_INITIALISER {\
 	.red_x   = 0.6400, .red_y   = 0.3300, .red_Y   = 0.222021,\
 	.green_x = 0.2900, .green_y = 0.6000, .green_Y = 0.706645,\
 	.blue_x  = 0.1500, .blue_y  = 0.0600, .blue_Y  = 0.071334,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the ProPhoto RGB colour space
  * 
- * This colour space's gamma is 1.8. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 1.8. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_PROPHOTO_RGB_INITIALISER {\
 	.red_x   = 0.7347, .red_y   = 0.2653, .red_Y   = 0.288040,\
 	.green_x = 0.1596, .green_y = 0.8404, .green_Y = 0.711874,\
 	.blue_x  = 0.0366, .blue_y  = 0.0001, .blue_Y  = 0.000086,\
-	LIBCLUT_ILLUMINANT_D50}
+	LIBCLUT_ILLUMINANT_D50,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 1.8}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the SMPTE-C RGB colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_SMPTE_C_RGB_INITIALISER {\
 	.red_x   = 0.6300, .red_y   = 0.3400, .red_Y   = 0.212395,\
 	.green_x = 0.3100, .green_y = 0.5950, .green_Y = 0.701049,\
 	.blue_x  = 0.1550, .blue_y  = 0.0700, .blue_Y  = 0.086556,\
-	LIBCLUT_ILLUMINANT_D65}
+	LIBCLUT_ILLUMINANT_D65,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
 
 /**
  * Initialiser for `struct libclut_rgb_colour_space` with the values
  * of the Wide Gamut RGB colour space
  * 
- * This colour space's gamma is 2.2. It cannot be used with
- * RGB colour space conversion unless the values are tranlated into
- * using the sRGB gamma function.
+ * This colour space's gamma is 2.2. It is described by the `transfer`
+ * member, but `libclut_convert_rgb`, `libclut_convert_rgb_inplace`,
+ * and `libclut_model_convert_rgb` assume the sRGB gamma function; use
+ * `libclut_convert_rgb_transfer` to convert values in this colour
+ * space.
  */
 #define LIBCLUT_RGB_COLOUR_SPACE_WIDE_GAMUT_RGB_INITIALISER {\
 	.red_x   = 0.7350, .red_y   = 0.2650, .red_Y   = 0.258187,\
 	.green_x = 0.1150, .green_y = 0.8260, .green_Y = 0.724938,\
 	.blue_x  = 0.1570, .blue_y  = 0.0180, .blue_Y  = 0.016875,\
-	LIBCLUT_ILLUMINANT_D50}
+	LIBCLUT_ILLUMINANT_D50,\
+	.transfer = {LIBCLUT_TRANSFER_GAMMA, 2.2}}
+
+/**
+ * Transfer functions (gamma functions) of RGB colour spaces
+ * 
+ * Each transfer function maps linear values to encoded
+ * values, 0 to 0 and 1 to 1; negative values are mapped
+ * as the negation of the mapping of their absolute value
+ */
+typedef enum libclut_transfer_function_type {
+  /**
+   * The sRGB transfer function, see
+   * `libclut_model_linear_to_standard1`
+   */
+  LIBCLUT_TRANSFER_SRGB = 0,
+  
+  /**
+   * The identity function
+   */
+  LIBCLUT_TRANSFER_LINEAR,
+  
+  /**
+   * A pure power function, the encoded value
+   * is the linear value to the power of the
+   * reciprocal of `.gamma`
+   */
+  LIBCLUT_TRANSFER_GAMMA,
+  
+  /**
+   * The transfer function of ITU-R BT.601,
+   * ITU-R BT.709, and ITU-R BT.2020
+   */
+  LIBCLUT_TRANSFER_BT_709,
+  
+  /**
+   * The SMPTE ST 2084 perceptual quantizer, used
+   * by ITU-R BT.2100, where the linear value 1
+   * is 10000 cd/m²
+   */
+  LIBCLUT_TRANSFER_PQ,
+  
+  /**
+   * The hybrid log-gamma transfer function of
+   * ITU-R BT.2100 and ARIB STD-B67, where the
+   * linear value is the scene light
+   */
+  LIBCLUT_TRANSFER_HLG,
+  
+  /**
+   * The CIE L* function, scaled to [0, 1]
+   */
+  LIBCLUT_TRANSFER_L_STAR
+} libclut_transfer_function_type_t;
 
-/*
- * TODO gamma functions:
- *   https://en.wikipedia.org/wiki/Rec._2020#Transfer_characteristics
- *   http://www.itu.int/dms_pubrec/itu-r/rec/bt/R-REC-BT.2100-0-201607-I!!PDF-E.pdf
- *   https://en.wikipedia.org/wiki/Rec._601
+/**
+ * Transfer function (gamma function) of an RGB colour space
  */
+typedef struct libclut_transfer_function {
+  /**
+   * The type of the function
+   */
+  libclut_transfer_function_type_t type;
+  
+  /**
+   * The gamma if `.type` is `LIBCLUT_TRANSFER_GAMMA`,
+   * unused otherwise
+   */
+  double gamma;
+} libclut_transfer_function_t;
 
 /**
  * RGB colour space structure
@@ -438,6 +575,12 @@ typedef struct libclut_rgb_colour_space {
    * The Y-component of the white point's xyY value
    */
   double white_Y;
+  
+  /**
+   * The transfer function of the colour space,
+   * the sRGB transfer function if zero-initialised
+   */
+  libclut_transfer_function_t transfer;
 } libclut_rgb_colour_space_t;
 
 /**
@@ -445,1010 +588,4222 @@ typedef struct libclut_rgb_colour_space {
  */
 typedef double libclut_colour_space_conversion_matrix_t[3][3];
 
-/* This is to avoid warnings about comparing double, These are only
- * used when it is safe, for example to test whether optimisations
- * are possible. { */
-#if defined(__GNUC__) || defined(__clang__)
-# pragma GCC diagnostic push
-# pragma GCC diagnostic ignored "-Wfloat-equal"
-#endif
-static inline int libclut_eq__(double a, double b)  { return a == b; }
-static inline int libclut_1__(double x)             { return libclut_eq__(x, 1); }
-static inline int libclut_0__(double x)             { return libclut_eq__(x, 0); }
-#if defined(__GNUC__) || defined(__clang__)
-# pragma GCC diagnostic pop
-#endif
-/* } */
-
-#if defined(__clang__)
-# pragma GCC diagnostic push
-# pragma GCC diagnostic ignored "-Wdocumentation"
-#endif
-
 /**
- * Apply contrast correction on the colour curves using sRGB
+ * A reference white for the CIE L*a*b* and CIE L*u*v* conversions,
+ * with the values that the conversions need prepared once, so that
+ * the conversions do not divide by the white point
  * 
- * In this context, contrast is a measure of difference between
- * the whitepoint and blackpoint, if the difference is 0 than
- * they are both grey
- * 
- * None of the parameter may have side-effects
- * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     The contrast parameter for the red curve
- * @param  g     The contrast parameter for the green curve
- * @param  b     The contrast parameter for the blue curve
+ * Initialise `.white_x`, `.white_y`, and `.white_Y`, for example
+ * with `{LIBCLUT_ILLUMINANT_D65}`, and call
+ * `libclut_model_prepare_white_point` to set the other members
  */
-#define libclut_rgb_contrast(clut, max, type, r, g, b)\
-	do {\
-		const double h__ = (double)5 / 10;\
-		if (!libclut_1__(r)) libclut__(clut, red,   type, (LIBCLUT_VALUE - (max) * h__) * (r) + (max) * h__);\
-		if (!libclut_1__(g)) libclut__(clut, green, type, (LIBCLUT_VALUE - (max) * h__) * (g) + (max) * h__);\
-		if (!libclut_1__(b)) libclut__(clut, blue,  type, (LIBCLUT_VALUE - (max) * h__) * (b) + (max) * h__);\
-	} while (0)
+typedef struct libclut_white_point {
+  /**
+   * The x-value (CIE xyY) of the white point
+   */
+  double white_x;
+  
+  /**
+   * The y-value (CIE xyY) of the white point
+   */
+  double white_y;
+  
+  /**
+   * The Y-value (CIE xyY) of the white point
+   */
+  double white_Y;
+  
+  /**
+   * The X-value (CIE XYZ) of the white point
+   */
+  double Xn;
+  
+  /**
+   * The Y-value (CIE XYZ) of the white point
+   */
+  double Yn;
+  
+  /**
+   * The Z-value (CIE XYZ) of the white point
+   */
+  double Zn;
+  
+  /**
+   * The reciprocal of `.Xn`
+   */
+  double rXn;
+  
+  /**
+   * The reciprocal of `.Yn`
+   */
+  double rYn;
+  
+  /**
+   * The reciprocal of `.Zn`
+   */
+  double rZn;
+  
+  /**
+   * The u'-value (CIE 1976 UCS) of the white point
+   */
+  double un;
+  
+  /**
+   * The v'-value (CIE 1976 UCS) of the white point
+   */
+  double vn;
+} libclut_white_point_t;
 
 /**
- * Apply contrast correction on the colour curves using CIE xyY
- * 
- * In this context, contrast is a measure of difference between
- * the whitepoint and blackpoint, if the difference is 0 than
- * they are both grey
- * 
- * None of the parameter may have side-effects
+ * A transfer function, with tables prepared by
+ * `libclut_model_prepare_transfer_table` for
+ * fast evaluation of the function and its
+ * inverse on many values
  * 
- * Requires linking with '-lclut'
- * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     The contrast parameter for the red curve
- * @param  g     The contrast parameter for the green curve
- * @param  b     The contrast parameter for the blue curve
+ * The tables are sampled at 128 points per
+ * octave for the values in [2⁻¹⁶, 1]
  */
-#define libclut_cie_contrast(clut, max, type, r, g, b)\
-	do {\
-		const double h__ = (double)5 / 10;\
-		libclut_cie__(clut, max, type, libclut_eq__((r), (g)) && libclut_eq__((g), (b)),\
-		              !libclut_1__(r), !libclut_1__(g), !libclut_1__(b),\
-		              (Y__ - h__) * (r) + h__, (Y__ - h__) * (g) + h__, (Y__ - h__) * (b) + h__);\
-	} while (0)
+typedef struct libclut_transfer_table {
+  /**
+   * The transfer function
+   */
+  libclut_transfer_function_t function;
+  
+  /**
+   * The linear values of the samples of
+   * encoded values, intended for internal use
+   */
+  double decode[16 * 128 + 1];
+  
+  /**
+   * The encoded values of the samples of
+   * linear values, intended for internal use
+   */
+  double encode[16 * 128 + 1];
+} libclut_transfer_table_t;
 
 /**
- * Apply brightness correction on the colour curves using sRGB
- *  
- * In this context, brightness is a measure of the whiteness of the whitepoint
- * 
- * None of the parameter may have side-effects
- * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     The brightness parameter for the red curve
- * @param  g     The brightness parameter for the green curve
- * @param  b     The brightness parameter for the blue curve
+ * Chromatic adaptation transforms for
+ * `libclut_model_get_adapted_rgb_conversion_matrix`
  */
-#define libclut_rgb_brightness(clut, max, type, r, g, b)\
-	do {\
-		if (!libclut_1__(r)) libclut__(clut, red,   type, LIBCLUT_VALUE * (r));\
-		if (!libclut_1__(g)) libclut__(clut, green, type, LIBCLUT_VALUE * (g));\
-		if (!libclut_1__(b)) libclut__(clut, blue,  type, LIBCLUT_VALUE * (b));\
-	} while (0)
+typedef enum libclut_chromatic_adaptation {
+  /**
+   * No adaptation, the white point of the
+   * input is not mapped to the white point
+   * of the output
+   */
+  LIBCLUT_ADAPTATION_NONE = 0,
+  
+  /**
+   * Scaling of the CIE XYZ values
+   */
+  LIBCLUT_ADAPTATION_XYZ_SCALING,
+  
+  /**
+   * von Kries transform, with the
+   * Hunt-Pointer-Estévez cone responses
+   */
+  LIBCLUT_ADAPTATION_VON_KRIES,
+  
+  /**
+   * Bradford transform, as used by ICC profiles
+   */
+  LIBCLUT_ADAPTATION_BRADFORD,
+  
+  /**
+   * CIECAM02 transform
+   */
+  LIBCLUT_ADAPTATION_CAT02
+} libclut_chromatic_adaptation_t;
 
 /**
- * Apply brightness correction on the colour curves using CIE xyY
- *  
- * In this context, brightness is a measure of the whiteness of the whitepoint
+ * Pixel formats supported by `libclut_apply_pixels`
  * 
- * None of the parameter may have side-effects
- * 
- * Requires linking with '-lclut'
- * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     The brightness parameter for the red curve
- * @param  g     The brightness parameter for the green curve
- * @param  b     The brightness parameter for the blue curve
+ * The packed formats are stored as native-endian integers
  */
-#define libclut_cie_brightness(clut, max, type, r, g, b)\
-	libclut_cie__(clut, max, type, libclut_eq__((r), (g)) && libclut_eq__((g), (b)),\
-	              !libclut_1__(r), !libclut_1__(g), !libclut_1__(b),\
-	              Y__ * (r), Y__ * (g), Y__ * (b))
+typedef enum libclut_pixel_format {
+  /**
+   * 8 bits per channel, stored as the bytes red,
+   * green, blue, and alpha, in that order
+   */
+  LIBCLUT_PIXEL_RGBA8888,
+  
+  /**
+   * 8 bits per channel, stored as the bytes blue,
+   * green, red, and alpha, in that order
+   */
+  LIBCLUT_PIXEL_BGRA8888,
+  
+  /**
+   * 16-bit integer, with red in the 5 most significant
+   * bits, green in the following 6 bits, and blue in
+   * the 5 least significant bits
+   */
+  LIBCLUT_PIXEL_RGB565,
+  
+  /**
+   * 32-bit integer, with 2 unused bits, followed by
+   * red, green, and blue, 10 bits each, with blue
+   * in the least significant bits
+   */
+  LIBCLUT_PIXEL_XRGB2101010,
+  
+  /**
+   * 32-bit integer, with 2 unused bits, followed by
+   * blue, green, and red, 10 bits each, with red
+   * in the least significant bits
+   */
+  LIBCLUT_PIXEL_XBGR2101010
+} libclut_pixel_format_t;
 
 /**
- * Convert the curves from formatted in standard RGB to linear sRGB
- * 
- * None of the parameter may have side-effects
- * 
- * Requires linking with '-lclut', or '-lm' if
- * `libclut_model_standard_to_linear1` is not undefined
- * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     Whether to convert the red colour curve
- * @param  g     Whether to convert the green colour curve
- * @param  b     Whether to convert the blue colour curve
+ * Data types for the stops in ramps that are not
+ * known at compile-time, see `LIBCLUT_ELEMENT_TYPE`
  */
-#define libclut_linearise(clut, max, type, r, g, b)\
-	do {\
-		double m__ = (double)(max);\
-		if (r) libclut__(clut, red,   type, m__ * libclut_model_standard_to_linear1(LIBCLUT_VALUE / m__));\
-		if (g) libclut__(clut, green, type, m__ * libclut_model_standard_to_linear1(LIBCLUT_VALUE / m__));\
-		if (b) libclut__(clut, blue,  type, m__ * libclut_model_standard_to_linear1(LIBCLUT_VALUE / m__));\
-	} while (0)
+typedef enum libclut_element_type {
+  /**
+   * `uint8_t`
+   */
+  LIBCLUT_ELEMENT_UINT8 = 1,
+  
+  /**
+   * `uint16_t`
+   */
+  LIBCLUT_ELEMENT_UINT16,
+  
+  /**
+   * `uint32_t`
+   */
+  LIBCLUT_ELEMENT_UINT32,
+  
+  /**
+   * `uint64_t`
+   */
+  LIBCLUT_ELEMENT_UINT64,
+  
+  /**
+   * `float`
+   */
+  LIBCLUT_ELEMENT_FLOAT,
+  
+  /**
+   * `double`
+   */
+  LIBCLUT_ELEMENT_DOUBLE
+} libclut_element_type_t;
 
 /**
- * Convert the curves from formatted in linear sRGB to standard RGB
+ * Gamma ramps mapped into memory from a file,
+ * with `libclut_map_ramps_file`
+ */
+typedef struct libclut_mapped_ramps {
+  /**
+   * The data type used for each stop in the ramps
+   */
+  libclut_element_type_t type;
+  
+  /**
+   * The maximum value on each stop in the ramps
+   */
+  double max;
+  
+  /**
+   * The number of stops in the red ramp
+   */
+  size_t red_size;
+  
+  /**
+   * The number of stops in the green ramp
+   */
+  size_t green_size;
+  
+  /**
+   * The number of stops in the blue ramp
+   */
+  size_t blue_size;
+  
+  /**
+   * The red ramp, points into the mapping
+   */
+  void *red;
+  
+  /**
+   * The green ramp, points into the mapping
+   */
+  void *green;
+  
+  /**
+   * The blue ramp, points into the mapping
+   */
+  void *blue;
+  
+  /**
+   * Whether the file specifies the colour
+   * space that the ramps are calibrated for
+   */
+  int has_colour_space;
+  
+  /**
+   * The colour space that the ramps are calibrated
+   * for, only set if `.has_colour_space` is nonzero
+   */
+  libclut_rgb_colour_space_t colour_space;
+  
+  /**
+   * The mapping, intended for internal use
+   */
+  void *map;
+  
+  /**
+   * The size of `.map`, intended for internal use
+   */
+  size_t map_size;
+} libclut_mapped_ramps_t;
+
+/**
+ * A set of gamma ramps of any size, data type and maximum
+ * value, for use as a stage in `libclut_compose`
+ * 
+ * Can be initialised with `LIBCLUT_RAMPS_INITIALISER`
+ */
+typedef struct libclut_ramps {
+  /**
+   * The data type used for each stop in the ramps
+   */
+  libclut_element_type_t type;
+  
+  /**
+   * The maximum value on each stop in the ramps
+   */
+  double max;
+  
+  /**
+   * The number of stops in the red ramp
+   */
+  size_t red_size;
+  
+  /**
+   * The number of stops in the green ramp
+   */
+  size_t green_size;
+  
+  /**
+   * The number of stops in the blue ramp
+   */
+  size_t blue_size;
+  
+  /**
+   * The red ramp
+   */
+  const void *red;
+  
+  /**
+   * The green ramp
+   */
+  const void *green;
+  
+  /**
+   * The blue ramp
+   */
+  const void *blue;
+} libclut_ramps_t;
+
+/**
+ * A curve in an ICC profile, see `libclut_icc_t`
+ * 
+ * The curve points into the buffer the profile was parsed
+ * from, so it must not be used after that buffer is freed
+ */
+typedef struct libclut_icc_curve {
+  /**
+   * `LIBCLUT_ICC_CURVE_NONE` if the profile does not have the curve,
+   * `LIBCLUT_ICC_CURVE_TABLE` if the curve is a lookup table,
+   * `LIBCLUT_ICC_CURVE_PARAMETRIC` if the curve is an ICC parametric
+   * curve, and `LIBCLUT_ICC_CURVE_FORMULA` if the curve is a `vcgt`
+   * formula, that is, `min + (max - min) * pow(x, gamma)`
+   */
+  enum {
+    LIBCLUT_ICC_CURVE_NONE = 0,
+    LIBCLUT_ICC_CURVE_TABLE,
+    LIBCLUT_ICC_CURVE_PARAMETRIC,
+    LIBCLUT_ICC_CURVE_FORMULA
+  } kind;
+  
+  /**
+   * The ICC parametric curve function type, 0 to 4, for
+   * `LIBCLUT_ICC_CURVE_PARAMETRIC`; a `curv` tag with a
+   * single gamma value is represented as function type 0
+   */
+  int function;
+  
+  /**
+   * The number of entries in the table,
+   * for `LIBCLUT_ICC_CURVE_TABLE`
+   */
+  size_t size;
+  
+  /**
+   * The number of bytes per entry in the table, 1 or 2,
+   * for `LIBCLUT_ICC_CURVE_TABLE`
+   */
+  size_t entry_size;
+  
+  /**
+   * The table, as big-endian unsigned integers,
+   * for `LIBCLUT_ICC_CURVE_TABLE`
+   */
+  const unsigned char *table;
+  
+  /**
+   * The parameters for `LIBCLUT_ICC_CURVE_PARAMETRIC`,
+   * in the order specified by ICC, starting with the
+   * gamma; and gamma, min, and max, in that order, for
+   * `LIBCLUT_ICC_CURVE_FORMULA`
+   */
+  double params[7];
+} libclut_icc_curve_t;
+
+/**
+ * The parts of an ICC profile, parsed with `libclut_icc_parse`,
+ * that map onto gamma ramps and RGB colour spaces
+ */
+typedef struct libclut_icc {
+  /**
+   * The video card gamma tables, from the `vcgt` tag,
+   * for the red, green, and blue channels
+   */
+  libclut_icc_curve_t vcgt[3];
+  
+  /**
+   * The tone reproduction curves, from the `rTRC`,
+   * `gTRC`, and `bTRC` tags, which map encoded
+   * values to linear values
+   */
+  libclut_icc_curve_t trc[3];
+  
+  /**
+   * Whether the profile has the `rXYZ`, `gXYZ`,
+   * `bXYZ`, and `wtpt` tags, and `.colour_space`
+   * is set
+   */
+  int has_colour_space;
+  
+  /**
+   * The colour space of the display, from the `rXYZ`,
+   * `gXYZ`, `bXYZ`, and `wtpt` tags, with the chromatic
+   * adaptation in the `chad` tag, if any, undone
+   */
+  libclut_rgb_colour_space_t colour_space;
+} libclut_icc_t;
+
+/**
+ * The maximum length of a line in a .cube file, other
+ * than comment lines and `TITLE` lines, and the
+ * maximum length of the title, including the NUL byte
+ */
+#define LIBCLUT_CUBE_LINE_MAX  256
+
+/**
+ * A .cube (Adobe/Resolve) lookup table file,
+ * parsed with `libclut_cube_parse` or `libclut_cube_load`
+ * 
+ * The structure can be used directly as gamma ramps and
+ * as a 3D colour lookup table, with the maximum value 1
+ * and the data type `double`; however, `libclut_cube_ramps`
+ * also applies the input domain of the file
+ */
+typedef struct libclut_cube {
+  /**
+   * The title of the lookup table, empty if unspecified,
+   * truncated if longer than `LIBCLUT_CUBE_LINE_MAX - 1`
+   * bytes
+   */
+  char title[LIBCLUT_CUBE_LINE_MAX];
+  
+  /**
+   * The lower bound of the input domain, for
+   * the red, green, and blue channels, 0 by default
+   */
+  double domain_min[3];
+  
+  /**
+   * The upper bound of the input domain, for
+   * the red, green, and blue channels, 1 by default
+   */
+  double domain_max[3];
+  
+  /**
+   * The number of stops in the red ramp, 0
+   * if the file does not have a 1D lookup table
+   */
+  size_t red_size;
+  
+  /**
+   * The number of stops in the green ramp,
+   * same as `.red_size`
+   */
+  size_t green_size;
+  
+  /**
+   * The number of stops in the blue ramp,
+   * same as `.red_size`
+   */
+  size_t blue_size;
+  
+  /**
+   * The red ramp of the 1D lookup table
+   */
+  double *red;
+  
+  /**
+   * The green ramp of the 1D lookup table
+   */
+  double *green;
+  
+  /**
+   * The blue ramp of the 1D lookup table
+   */
+  double *blue;
+  
+  /**
+   * The number of lattice points along each axis in the
+   * 3D lookup table, 0 if the file does not have one
+   */
+  size_t size;
+  
+  /**
+   * The 3D lookup table, see `libclut_3d_index`
+   */
+  double *data;
+  
+  /**
+   * The number of entries parsed so far,
+   * intended for internal use
+   */
+  size_t count;
+  
+  /**
+   * The error that stopped the parser, zero
+   * if none, intended for internal use
+   */
+  int error;
+  
+  /**
+   * The length of the line being read, which is
+   * incomplete, intended for internal use
+   */
+  size_t line_length;
+  
+  /**
+   * The beginning of the line being read,
+   * intended for internal use
+   */
+  char line[LIBCLUT_CUBE_LINE_MAX];
+} libclut_cube_t;
+
+/**
+ * A bounded cache of computed gamma ramps, keyed by a hash of the
+ * input ramps and a hash of the operations that were applied to them,
+ * see `libclut_cache_init`
+ * 
+ * The least recently used ramps are evicted when the cache is full.
+ * The cache is not thread-safe.
+ */
+typedef struct libclut_cache {
+  /**
+   * The maximum number of ramp sets in the cache
+   */
+  size_t capacity;
+  
+  /**
+   * The number of lookups that found the ramps in the cache
+   */
+  uint64_t hits;
+  
+  /**
+   * The number of lookups that did not find the ramps in the cache
+   */
+  uint64_t misses;
+  
+  /**
+   * Counter used to find the least recently used
+   * ramps, intended for internal use
+   */
+  uint64_t tick;
+  
+  /**
+   * The cached ramps, intended for internal use
+   */
+  struct libclut_cache_entry {
+    uint64_t input;
+    uint64_t operation;
+    uint64_t last_used;
+    libclut_element_type_t type;
+    double max;
+    size_t red_size;
+    size_t green_size;
+    size_t blue_size;
+    void *ramps;
+  } *entries;
+} libclut_cache_t;
+
+/**
+ * A per-channel affine operation, `factor * x + offset`, on the stops
+ * of a set of gamma ramps, that a run of `libclut_rgb_brightness`,
+ * `libclut_rgb_contrast`, and `libclut_rgb_limits` can be folded into
+ * so that the ramps are only walked and rounded once, see
+ * `libclut_rgb_affine`
+ * 
+ * Initialise with `LIBCLUT_AFFINE_IDENTITY_INITIALISER`. The offsets
+ * are in the same unit as the stops, that is, [0, `max`].
+ */
+typedef struct libclut_affine {
+  /**
+   * The factor the red stops shall be multiplied by
+   */
+  double red_factor;
+  
+  /**
+   * The value to add to the red stops after the multiplication
+   */
+  double red_offset;
+  
+  /**
+   * The factor the green stops shall be multiplied by
+   */
+  double green_factor;
+  
+  /**
+   * The value to add to the green stops after the multiplication
+   */
+  double green_offset;
+  
+  /**
+   * The factor the blue stops shall be multiplied by
+   */
+  double blue_factor;
+  
+  /**
+   * The value to add to the blue stops after the multiplication
+   */
+  double blue_offset;
+} libclut_affine_t;
+
+/**
+ * Initialiser for `libclut_affine_t` that does not change the stops
+ */
+#define LIBCLUT_AFFINE_IDENTITY_INITIALISER {1, 0, 1, 0, 1, 0}
+
+/* This is to avoid warnings about comparing double, These are only
+ * used when it is safe, for example to test whether optimisations
+ * are possible. { */
+#if defined(__GNUC__) || defined(__clang__)
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wfloat-equal"
+#endif
+static inline int libclut_eq__(double a, double b)  { return a == b; }
+static inline int libclut_1__(double x)             { return libclut_eq__(x, 1); }
+static inline int libclut_0__(double x)             { return libclut_eq__(x, 0); }
+#if defined(__GNUC__) || defined(__clang__)
+# pragma GCC diagnostic pop
+#endif
+/* } */
+
+#if defined(__clang__)
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wdocumentation"
+#endif
+
+/**
+ * Apply contrast correction on the colour curves using sRGB
+ * 
+ * In this context, contrast is a measure of difference between
+ * the whitepoint and blackpoint, if the difference is 0 than
+ * they are both grey
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     The contrast parameter for the red curve
+ * @param  g     The contrast parameter for the green curve
+ * @param  b     The contrast parameter for the blue curve
+ */
+#define libclut_rgb_contrast(clut, max, type, r, g, b)\
+	do {\
+		const double h__ = (double)5 / 10;\
+		if (!libclut_1__(r)) libclut__(clut, red,   type, (LIBCLUT_VALUE - (max) * h__) * (r) + (max) * h__);\
+		if (!libclut_1__(g)) libclut__(clut, green, type, (LIBCLUT_VALUE - (max) * h__) * (g) + (max) * h__);\
+		if (!libclut_1__(b)) libclut__(clut, blue,  type, (LIBCLUT_VALUE - (max) * h__) * (b) + (max) * h__);\
+	} while (0)
+
+/**
+ * Apply contrast correction on the colour curves using sRGB,
+ * without any floating-point arithmetics on each stop
+ * 
+ * This is a fixed-point variant of `libclut_rgb_contrast`,
+ * intended for machines with poor floating-point performance.
+ * Unlike `libclut_rgb_contrast`, the result is rounded to the
+ * nearest value rather than truncated, and it is saturated
+ * to [0, `max`]
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps, must
+ *               be an unsigned integer type of at most 16 bits
+ * @param  r     The contrast parameter for the red curve
+ * @param  g     The contrast parameter for the green curve
+ * @param  b     The contrast parameter for the blue curve
+ */
+#define libclut_rgb_contrast_fixed(clut, max, type, r, g, b)\
+	do {\
+		const double h__ = (double)5 / 10;\
+		if (!libclut_1__(r)) libclut_fixed__(clut, red,   max, type, (r), (max) * h__ * (1 - (r)));\
+		if (!libclut_1__(g)) libclut_fixed__(clut, green, max, type, (g), (max) * h__ * (1 - (g)));\
+		if (!libclut_1__(b)) libclut_fixed__(clut, blue,  max, type, (b), (max) * h__ * (1 - (b)));\
+	} while (0)
+
+/**
+ * Apply contrast correction on the colour curves using CIE xyY
+ * 
+ * In this context, contrast is a measure of difference between
+ * the whitepoint and blackpoint, if the difference is 0 than
+ * they are both grey
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     The contrast parameter for the red curve
+ * @param  g     The contrast parameter for the green curve
+ * @param  b     The contrast parameter for the blue curve
+ */
+#define libclut_cie_contrast(clut, max, type, r, g, b)\
+	do {\
+		const double h__ = (double)5 / 10;\
+		libclut_cie__(clut, max, type, libclut_eq__((r), (g)) && libclut_eq__((g), (b)),\
+		              !libclut_1__(r), !libclut_1__(g), !libclut_1__(b),\
+		              (Y__ - h__) * (r) + h__, (Y__ - h__) * (g) + h__, (Y__ - h__) * (b) + h__);\
+	} while (0)
+
+/**
+ * Apply brightness correction on the colour curves using sRGB
+ *  
+ * In this context, brightness is a measure of the whiteness of the whitepoint
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     The brightness parameter for the red curve
+ * @param  g     The brightness parameter for the green curve
+ * @param  b     The brightness parameter for the blue curve
+ */
+#define libclut_rgb_brightness(clut, max, type, r, g, b)\
+	do {\
+		if (!libclut_1__(r)) libclut__(clut, red,   type, LIBCLUT_VALUE * (r));\
+		if (!libclut_1__(g)) libclut__(clut, green, type, LIBCLUT_VALUE * (g));\
+		if (!libclut_1__(b)) libclut__(clut, blue,  type, LIBCLUT_VALUE * (b));\
+	} while (0)
+
+/**
+ * Apply brightness correction on the colour curves using sRGB,
+ * without any floating-point arithmetics on each stop
+ * 
+ * This is a fixed-point variant of `libclut_rgb_brightness`,
+ * intended for machines with poor floating-point performance.
+ * Unlike `libclut_rgb_brightness`, the result is rounded to the
+ * nearest value rather than truncated, and it is saturated
+ * to [0, `max`]
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps, must
+ *               be an unsigned integer type of at most 16 bits
+ * @param  r     The brightness parameter for the red curve
+ * @param  g     The brightness parameter for the green curve
+ * @param  b     The brightness parameter for the blue curve
+ */
+#define libclut_rgb_brightness_fixed(clut, max, type, r, g, b)\
+	do {\
+		if (!libclut_1__(r)) libclut_fixed__(clut, red,   max, type, (r), 0);\
+		if (!libclut_1__(g)) libclut_fixed__(clut, green, max, type, (g), 0);\
+		if (!libclut_1__(b)) libclut_fixed__(clut, blue,  max, type, (b), 0);\
+	} while (0)
+
+/**
+ * Apply brightness correction on the colour curves using CIE xyY
+ *  
+ * In this context, brightness is a measure of the whiteness of the whitepoint
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     The brightness parameter for the red curve
+ * @param  g     The brightness parameter for the green curve
+ * @param  b     The brightness parameter for the blue curve
+ */
+#define libclut_cie_brightness(clut, max, type, r, g, b)\
+	libclut_cie__(clut, max, type, libclut_eq__((r), (g)) && libclut_eq__((g), (b)),\
+	              !libclut_1__(r), !libclut_1__(g), !libclut_1__(b),\
+	              Y__ * (r), Y__ * (g), Y__ * (b))
+
+/**
+ * Shift the white point of the colour curves to the
+ * colour of a blackbody, using sRGB, in one pass
+ * 
+ * The white point is scaled so that its brightest channel is
+ * at full brightness; 6500 K leaves the curves almost unchanged
+ * and lower temperatures make the display redder
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut', and with '-lm' if
+ * `libclut_model_linear_to_standard1` is not undefined
+ * 
+ * @param  clut         Pointer to the gamma ramps, must have the arrays
+ *                      `red`, `green`, and `blue`, and the scalars
+ *                      `red_size`, `green_size`, and `blue_size`. Ramp
+ *                      structures from libgamma or libcoopgamma can be used.
+ * @param  max          The maximum value on each stop in the ramps
+ * @param  type         The data type used for each stop in the ramps
+ * @param  temperature  The colour temperature, in kelvins,
+ *                      clamped to [1000, 25000]
+ */
+#define libclut_rgb_temperature(clut, max, type, temperature)\
+	do {\
+		double x_t__, y_t__, X_t__, Z_t__, r_t__, g_t__, b_t__, m_t__;\
+		libclut_model_cct_to_ciexy((temperature), &x_t__, &y_t__);\
+		libclut_model_ciexyy_to_ciexyz(x_t__, y_t__, 1, &X_t__, &Z_t__);\
+		libclut_model_ciexyz_to_linear(X_t__, 1, Z_t__, &r_t__, &g_t__, &b_t__);\
+		r_t__ = r_t__ > 0 ? r_t__ : 0;\
+		g_t__ = g_t__ > 0 ? g_t__ : 0;\
+		b_t__ = b_t__ > 0 ? b_t__ : 0;\
+		m_t__ = r_t__ > g_t__ ? r_t__ : g_t__;\
+		m_t__ = m_t__ > b_t__ ? m_t__ : b_t__;\
+		r_t__ /= m_t__, g_t__ /= m_t__, b_t__ /= m_t__;\
+		libclut_model_linear_to_standard(&r_t__, &g_t__, &b_t__);\
+		libclut_rgb_brightness(clut, max, type, r_t__, g_t__, b_t__);\
+	} while (0)
+
+/**
+ * Convert the curves from formatted in standard RGB to linear sRGB
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut', or '-lm' if
+ * `libclut_model_standard_to_linear1` is not undefined
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     Whether to convert the red colour curve
+ * @param  g     Whether to convert the green colour curve
+ * @param  b     Whether to convert the blue colour curve
+ */
+#define libclut_linearise(clut, max, type, r, g, b)\
+	do {\
+		double m__ = (double)(max);\
+		if (r) libclut__(clut, red,   type, m__ * libclut_model_standard_to_linear1(LIBCLUT_VALUE / m__));\
+		if (g) libclut__(clut, green, type, m__ * libclut_model_standard_to_linear1(LIBCLUT_VALUE / m__));\
+		if (b) libclut__(clut, blue,  type, m__ * libclut_model_standard_to_linear1(LIBCLUT_VALUE / m__));\
+	} while (0)
+
+/**
+ * Convert the curves from formatted in linear sRGB to standard RGB
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut', or '-lm' if
+ * `libclut_model_linear_to_standard1` is not undefined
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     Whether to convert the red colour curve
+ * @param  g     Whether to convert the green colour curve
+ * @param  b     Whether to convert the blue colour curve
+ */
+#define libclut_standardise(clut, max, type, r, g, b)\
+	do {\
+		double m__ = (double)(max);\
+		if (r) libclut__(clut, red,   type, m__ * libclut_model_linear_to_standard1(LIBCLUT_VALUE / m__));\
+		if (g) libclut__(clut, green, type, m__ * libclut_model_linear_to_standard1(LIBCLUT_VALUE / m__));\
+		if (b) libclut__(clut, blue,  type, m__ * libclut_model_linear_to_standard1(LIBCLUT_VALUE / m__));\
+	} while (0)
+
+/**
+ * Convert the curves from encoded with a transfer function to linear
+ * 
+ * This is a generalisation of `libclut_linearise` to any transfer
+ * function, using the tables in `table` rather than evaluating
+ * the function for each stop
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  clut   Pointer to the gamma ramps, must have the arrays
+ *                `red`, `green`, and `blue`, and the scalars
+ *                `red_size`, `green_size`, and `blue_size`. Ramp
+ *                structures from libgamma or libcoopgamma can be used.
+ * @param  max    The maximum value on each stop in the ramps
+ * @param  type   The data type used for each stop in the ramps
+ * @param  table  The transfer function, prepared with
+ *                `libclut_model_prepare_transfer_table`
+ * @param  r      Whether to convert the red colour curve
+ * @param  g      Whether to convert the green colour curve
+ * @param  b      Whether to convert the blue colour curve
+ */
+#define libclut_decode_transfer(clut, max, type, table, r, g, b)\
+	do {\
+		if (r) libclut_batch__(clut, max, type, red,   libclut_model_transfer_decode_batch, table);\
+		if (g) libclut_batch__(clut, max, type, green, libclut_model_transfer_decode_batch, table);\
+		if (b) libclut_batch__(clut, max, type, blue,  libclut_model_transfer_decode_batch, table);\
+	} while (0)
+
+/**
+ * Convert the curves from linear to encoded with a transfer function
+ * 
+ * This is a generalisation of `libclut_standardise` to any transfer
+ * function, using the tables in `table` rather than evaluating
+ * the function for each stop
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  clut   Pointer to the gamma ramps, must have the arrays
+ *                `red`, `green`, and `blue`, and the scalars
+ *                `red_size`, `green_size`, and `blue_size`. Ramp
+ *                structures from libgamma or libcoopgamma can be used.
+ * @param  max    The maximum value on each stop in the ramps
+ * @param  type   The data type used for each stop in the ramps
+ * @param  table  The transfer function, prepared with
+ *                `libclut_model_prepare_transfer_table`
+ * @param  r      Whether to convert the red colour curve
+ * @param  g      Whether to convert the green colour curve
+ * @param  b      Whether to convert the blue colour curve
+ */
+#define libclut_encode_transfer(clut, max, type, table, r, g, b)\
+	do {\
+		if (r) libclut_batch__(clut, max, type, red,   libclut_model_transfer_encode_batch, table);\
+		if (g) libclut_batch__(clut, max, type, green, libclut_model_transfer_encode_batch, table);\
+		if (b) libclut_batch__(clut, max, type, blue,  libclut_model_transfer_encode_batch, table);\
+	} while (0)
+
+/**
+ * Convert the curves between two RGB colour spaces
+ * 
+ * Both RGB colour spaces must have same gamma functions as sRGB,
+ * regardless of their `transfer` members, see
+ * `libclut_convert_rgb_transfer` for other transfer functions
+ * 
+ * Requires that `clut->red_size`, `clut->green_size`
+ * and `clut->blue_size` are equal
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut', or '-lm' if
+ * `libclut_model_linear_to_standard1`,
+ * `libclut_model_standard_to_linear1`, or
+ * `libclut_model_convert_rgb` is not undefined
+ * 
+ * @param  clut   Pointer to the gamma ramps, must have the arrays
+ *                `red`, `green`, and `blue`, and the scalars
+ *                `red_size`, `green_size`, and `blue_size`. Ramp
+ *                structures from libgamma or libcoopgamma can be used.
+ * @param  max    The maximum value on each stop in the ramps
+ * @param  type   The data type used for each stop in the ramps
+ * @param  m      Conversion matrix. Can be created with
+ *                `libclut_model_get_rgb_conversion_matrix`
+ * @param  trunc  Truncate values that are out of gamut
+ */
+#define libclut_convert_rgb_inplace(clut, max, type, m, trunc)\
+	do {\
+		double m__ = (double)(max), r__, g__, b__;\
+		size_t i__, n__ = (clut)->red_size;\
+		for (i__ = 0; i__ < n__; i__++) {\
+			r__ = (clut)->red[i__] / m__;\
+			g__ = (clut)->green[i__] / m__;\
+			b__ = (clut)->blue[i__] / m__;\
+			libclut_model_convert_rgb(r__, g__, b__, m, &r__, &g__, &b__);\
+			r__ *= m__;\
+			g__ *= m__;\
+			b__ *= m__;\
+			if (trunc) {\
+				if (r__ < 0)\
+					r__ = 0;\
+				else if (r__ > m__)\
+					r__ = m__;\
+				if (g__ < 0)\
+					g__ = 0;\
+				else if (g__ > m__)\
+					g__ = m__;\
+				if (b__ < 0)\
+					b__ = 0;\
+				else if (b__ > m__)\
+					b__ = m__;\
+			}\
+			(clut)->red[i__] = (type)r__;\
+			(clut)->green[i__] = (type)g__;\
+			(clut)->blue[i__] = (type)b__;\
+		}\
+	} while (0)
+
+/**
+ * Convert the curves between two RGB colour spaces
+ * 
+ * Both RGB colour spaces must have same gamma functions as sRGB,
+ * regardless of their `transfer` members, see
+ * `libclut_convert_rgb_transfer` for other transfer functions
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut' if
+ * `libclut_model_linear_to_standard1`,
+ * `libclut_model_standard_to_linear1`, or
+ * `libclut_model_convert_rgb` is not undefined.
+ * Always requires linking with '-lm'.
+ * 
+ * @param  clut   Pointer to the input gamma ramps, must have the
+ *                arrays `red`, `green`, and `blue`, and the scalars
+ *                `red_size`, `green_size`, and `blue_size`. Ramp
+ *                structures from libgamma or libcoopgamma can be used.
+ * @param  max    The maximum value on each stop in the ramps
+ * @param  type   The data type used for each stop in the ramps
+ * @param  m      Conversion matrix. Can be created with
+ *                `libclut_model_get_rgb_conversion_matrix`
+ * @param  trunc  Truncate values that are out of gamut
+ * @param  out    Pointer to the output gamma ramps, must have the
+ *                arrays `red`, `green`, and `blue`, and the scalars
+ *                `red_size`, `green_size`, and `blue_size`. Ramp
+ *                structures from libgamma or libcoopgamma can be used.
+ */
+#define libclut_convert_rgb(clut, max, type, m, trunc, out)\
+	do {\
+		double m__ = (double)(max), r__, g__, b__, x__, y__;\
+		size_t rn__ = (clut)->red_size;\
+		size_t gn__ = (clut)->green_size;\
+		size_t bn__ = (clut)->blue_size;\
+		double w__;\
+		size_t i__, j__, jj__;\
+		for (i__ = 0; i__ < rn__; i__++) {\
+			w__ = (double)i__ * (double)gn__ / (double)rn__;\
+			j__ = (size_t)w__;\
+			jj__ = j__ + 1 < gn__ ? j__ + 1 : j__;\
+			w__ -= (double)j__;\
+			x__ = (clut)->green[j__] / m__;\
+			y__ = (clut)->green[jj__] / m__;\
+			x__ = libclut_model_standard_to_linear1(x__);\
+			y__ = libclut_model_standard_to_linear1(y__);\
+			g__ = x__ * (1 - w__) + y__ * w__;\
+			\
+			w__ = (double)i__ * (double)bn__ / (double)rn__;\
+			j__ = (size_t)w__;\
+			jj__ = j__ + 1 < bn__ ? j__ + 1 : j__;\
+			w__ -= (double)j__;\
+			x__ = (clut)->blue[j__] / m__;\
+			y__ = (clut)->blue[jj__] / m__;\
+			x__ = libclut_model_standard_to_linear1(x__);\
+			y__ = libclut_model_standard_to_linear1(y__);\
+			b__ = x__ * (1 - w__) + y__ * w__;\
+			\
+			r__ = (clut)->red[i__] / m__;\
+			r__ = libclut_model_standard_to_linear1(r__);\
+			r__ = (m)[0][0] * r__ + (m)[0][1] * g__ + (m)[0][2] * b__;\
+			r__ = libclut_model_linear_to_standard1(r__);\
+			r__ *= m__;\
+			if (trunc) {\
+				if (r__ < 0)\
+					r__ = 0;\
+				else if (r__ > m__)\
+					r__ = m__;\
+			}\
+			(out)->red[i__] = (type)r__;\
+		}\
+		for (i__ = 0; i__ < gn__; i__++) {\
+			w__ = (double)i__ * (double)rn__ / (double)gn__;\
+			j__ = (size_t)w__;\
+			jj__ = j__ + 1 < rn__ ? j__ + 1 : j__;\
+			w__ -= (double)j__;\
+			x__ = (clut)->red[j__] / m__;\
+			y__ = (clut)->red[jj__] / m__;\
+			x__ = libclut_model_standard_to_linear1(x__);\
+			y__ = libclut_model_standard_to_linear1(y__);\
+			r__ = x__ * (1 - w__) + y__ * w__;\
+			\
+			w__ = (double)i__ * (double)bn__ / (double)gn__;\
+			j__ = (size_t)w__;\
+			jj__ = j__ + 1 < bn__ ? j__ + 1 : j__;\
+			w__ -= (double)j__;\
+			x__ = (clut)->blue[j__] / m__;\
+			y__ = (clut)->blue[jj__] / m__;\
+			x__ = libclut_model_standard_to_linear1(x__);\
+			y__ = libclut_model_standard_to_linear1(y__);\
+			b__ = x__ * (1 - w__) + y__ * w__;\
+			\
+			g__ = (clut)->green[i__] / m__;\
+			g__ = libclut_model_standard_to_linear1(g__);\
+			g__ = (m)[1][0] * r__ + (m)[1][1] * g__ + (m)[1][2] * b__;\
+			g__ = libclut_model_linear_to_standard1(g__);\
+			g__ *= m__;\
+			if (trunc) {\
+				if (g__ < 0)\
+					g__ = 0;\
+				else if (g__ > m__)\
+					g__ = m__;\
+			}\
+			(out)->green[i__] = (type)g__;\
+		}\
+		for (i__ = 0; i__ < bn__; i__++) {\
+			w__ = (double)i__ * (double)rn__ / (double)bn__;\
+			j__ = (size_t)w__;\
+			jj__ = j__ + 1 < rn__ ? j__ + 1 : j__;\
+			w__ -= (double)j__;\
+			x__ = (clut)->red[j__] / m__;\
+			y__ = (clut)->red[jj__] / m__;\
+			x__ = libclut_model_standard_to_linear1(x__);\
+			y__ = libclut_model_standard_to_linear1(y__);\
+			r__ = x__ * (1 - w__) + y__ * w__;\
+			\
+			w__ = (double)i__ * (double)gn__ / (double)bn__;\
+			j__ = (size_t)w__;\
+			jj__ = j__ + 1 < gn__ ? j__ + 1 : j__;\
+			w__ -= (double)j__;\
+			x__ = (clut)->green[j__] / m__;\
+			y__ = (clut)->green[jj__] / m__;\
+			x__ = libclut_model_standard_to_linear1(x__);\
+			y__ = libclut_model_standard_to_linear1(y__);\
+			g__ = x__ * (1 - w__) + y__ * w__;\
+			\
+			b__ = (clut)->blue[i__] / m__;\
+			b__ = libclut_model_standard_to_linear1(b__);\
+			b__ = (m)[2][0] * r__ + (m)[2][1] * g__ + (m)[2][2] * b__;\
+			b__ = libclut_model_linear_to_standard1(b__);\
+			b__ *= m__;\
+			if (trunc) {\
+				if (b__ < 0)\
+					b__ = 0;\
+				else if (b__ > m__)\
+					b__ = m__;\
+			}\
+			(out)->blue[i__] = (type)b__;\
+		}\
+	} while (0)
+
+/**
+ * Convert the curves between two RGB colour spaces with
+ * any transfer functions, in one pass over the curves
+ * 
+ * Each stop is decoded with the input colour space's transfer
+ * function, multiplied by the conversion matrix, and encoded
+ * with the output colour space's transfer function, in chunks
+ * of `LIBCLUT_BATCH_SIZE` stops, so the curves are read and
+ * written once rather than once per step
+ * 
+ * Requires that `clut->red_size`, `clut->green_size`
+ * and `clut->blue_size` are equal, and that `out` has
+ * at least as many stops in each curve as `clut`
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  clut   Pointer to the input gamma ramps, must have the
+ *                arrays `red`, `green`, and `blue`, and the scalars
+ *                `red_size`, `green_size`, and `blue_size`. Ramp
+ *                structures from libgamma or libcoopgamma can be used.
+ * @param  max    The maximum value on each stop in the ramps
+ * @param  type   The data type used for each stop in the ramps
+ * @param  m      Conversion matrix. Can be created with
+ *                `libclut_model_get_rgb_conversion_matrix`
+ * @param  trunc  Truncate values that are out of gamut
+ * @param  out    Pointer to the output gamma ramps, must have the
+ *                arrays `red`, `green`, and `blue`, may be `clut`
+ * @param  from   The transfer function of the input colour space,
+ *                prepared with `libclut_model_prepare_transfer_table`
+ * @param  to     The transfer function of the output colour space,
+ *                prepared with `libclut_model_prepare_transfer_table`
+ */
+#define libclut_convert_rgb_transfer(clut, max, type, m, trunc, out, from, to)\
+	do {\
+		double m__ = (double)(max), im__ = 1 / m__, x__, y__, z__;\
+		double r__[LIBCLUT_BATCH_SIZE], g__[LIBCLUT_BATCH_SIZE], b__[LIBCLUT_BATCH_SIZE];\
+		size_t i__, j__, k__, n__ = (clut)->red_size;\
+		for (i__ = 0; i__ < n__; i__ += k__) {\
+			k__ = n__ - i__ < LIBCLUT_BATCH_SIZE ? n__ - i__ : LIBCLUT_BATCH_SIZE;\
+			for (j__ = 0; j__ < k__; j__++) {\
+				r__[j__] = (double)(clut)->red[i__ + j__] * im__;\
+				g__[j__] = (double)(clut)->green[i__ + j__] * im__;\
+				b__[j__] = (double)(clut)->blue[i__ + j__] * im__;\
+			}\
+			libclut_model_transfer_decode_batch(r__, r__, k__, from);\
+			libclut_model_transfer_decode_batch(g__, g__, k__, from);\
+			libclut_model_transfer_decode_batch(b__, b__, k__, from);\
+			for (j__ = 0; j__ < k__; j__++) {\
+				x__ = r__[j__], y__ = g__[j__], z__ = b__[j__];\
+				r__[j__] = (m)[0][0] * x__ + (m)[0][1] * y__ + (m)[0][2] * z__;\
+				g__[j__] = (m)[1][0] * x__ + (m)[1][1] * y__ + (m)[1][2] * z__;\
+				b__[j__] = (m)[2][0] * x__ + (m)[2][1] * y__ + (m)[2][2] * z__;\
+			}\
+			libclut_model_transfer_encode_batch(r__, r__, k__, to);\
+			libclut_model_transfer_encode_batch(g__, g__, k__, to);\
+			libclut_model_transfer_encode_batch(b__, b__, k__, to);\
+			for (j__ = 0; j__ < k__; j__++) {\
+				x__ = r__[j__] * m__, y__ = g__[j__] * m__, z__ = b__[j__] * m__;\
+				if (trunc) {\
+					x__ = x__ < 0 ? 0 : x__ > m__ ? m__ : x__;\
+					y__ = y__ < 0 ? 0 : y__ > m__ ? m__ : y__;\
+					z__ = z__ < 0 ? 0 : z__ > m__ ? m__ : z__;\
+				}\
+				(out)->red[i__ + j__] = (type)x__;\
+				(out)->green[i__ + j__] = (type)y__;\
+				(out)->blue[i__ + j__] = (type)z__;\
+			}\
+		}\
+	} while (0)
+
+/**
+ * Convert an image between two RGB colour spaces, in place
+ * 
+ * The image is processed in tiles of `LIBCLUT_TILE_SIZE__`
+ * pixels, each tile is linearised into a small buffer on the
+ * stack, multiplied by the conversion matrix, and delinearised
+ * back into the image, so no intermediate image is allocated
+ * and the working set stays in the cache regardless of the size
+ * of the image. For integer pixel types whose `pmax` is at most
+ * `LIBCLUT_IMAGE_TABLE_MAX__`, linearisation is a table lookup,
+ * and delinearisation is a binary search in a table of the linear
+ * values half way between consecutive levels, which is exact.
+ * Otherwise, both are done with a polynomial approximation, with
+ * a relative error less than 10⁻⁹, which is about as fast as `pow`,
+ * so for such pixel types this is no faster than converting each
+ * pixel with `libclut_model_convert_rgb`.
+ * 
+ * Each pixel must store its red, green, and blue values, in that
+ * order, in its first three elements; any further elements, such
+ * as alpha or padding, are left unmodified. For integer pixel types,
+ * the result is rounded to nearest and out of gamut values are
+ * always truncated.
+ * 
+ * The rows are processed independently, so a large image can be
+ * split into bands of rows, by adjusting `pixels` and `height`,
+ * that are processed concurrently by different threads. The tables
+ * and the tile are stored on the stack, and use at most 22 KiB.
+ * 
+ * Both RGB colour spaces must have same gamma functions as sRGB
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut', or '-lm' if
+ * `libclut_model_standard_to_linear1` is not undefined
+ * 
+ * @param  pixels  Pointer to the first pixel in the image
+ * @param  pmax    The maximum value on each channel in the pixels
+ * @param  ptype   The data type used for each channel in the pixels,
+ *                 for example `uint8_t`, `uint16_t`, or `float`
+ * @param  width   The number of pixels per row
+ * @param  height  The number of rows
+ * @param  stride  The number of bytes between the first pixel of a
+ *                 row and the first pixel of the next row
+ * @param  step    The number of elements (`ptype`s) per pixel, at least 3
+ * @param  m       Conversion matrix. Can be created, once for any number
+ *                 of images, with `libclut_model_get_rgb_conversion_matrix`
+ * @param  trunc   Truncate values that are out of gamut
+ */
+#define libclut_convert_rgb_image(pixels, pmax, ptype, width, height, stride, step, m, trunc)\
+	do {\
+		double pm__ = (double)(pmax), ipm__ = 1 / pm__, rnd__ = (ptype)0.5 > 0 ? 0 : 0.5;\
+		double r__, g__, b__, v__;\
+		double buf__[3 * LIBCLUT_TILE_SIZE__], *q__;\
+		int clip__ = (trunc) || rnd__ > 0;\
+		size_t x__, y__, i__, k__, t__, tn__ = (ptype)0.5 <= 0 && (double)(pmax) <= LIBCLUT_IMAGE_TABLE_MAX__ ? (size_t)(pmax) + 1 : 1;\
+		size_t lo__, n__, h__;\
+		double lin__[tn__], thr__[tn__];\
+		ptype *p__;\
+		for (k__ = 0; tn__ > 1 && k__ < tn__; k__++) {\
+			lin__[k__] = libclut_model_standard_to_linear1((double)k__ * ipm__);\
+			thr__[k__] = libclut_model_standard_to_linear1(((double)k__ + 0.5) * ipm__);\
+		}\
+		for (y__ = 0; y__ < (size_t)(height); y__++) {\
+			for (x__ = 0; x__ < (size_t)(width); x__ += t__) {\
+				t__ = (size_t)(width) - x__;\
+				t__ = t__ < LIBCLUT_TILE_SIZE__ ? t__ : LIBCLUT_TILE_SIZE__;\
+				p__ = (ptype *)(void *)((char *)(pixels) + y__ * (size_t)(stride)) + x__ * (size_t)(step);\
+				if (tn__ > 1) {\
+					for (i__ = 0, q__ = buf__; i__ < t__; i__++, p__ += (step), q__ += 3)\
+						for (k__ = 0; k__ < 3; k__++)\
+							q__[k__] = lin__[(double)p__[k__] < (double)tn__ ? (size_t)p__[k__] : tn__ - 1];\
+				} else {\
+					for (i__ = 0, q__ = buf__; i__ < t__; i__++, p__ += (step), q__ += 3)\
+						for (k__ = 0; k__ < 3; k__++)\
+							q__[k__] = libclut_standard_to_linear__((double)p__[k__] * ipm__);\
+				}\
+				for (i__ = 0, q__ = buf__; i__ < t__; i__++, q__ += 3) {\
+					r__ = q__[0], g__ = q__[1], b__ = q__[2];\
+					q__[0] = (m)[0][0] * r__ + (m)[0][1] * g__ + (m)[0][2] * b__;\
+					q__[1] = (m)[1][0] * r__ + (m)[1][1] * g__ + (m)[1][2] * b__;\
+					q__[2] = (m)[2][0] * r__ + (m)[2][1] * g__ + (m)[2][2] * b__;\
+				}\
+				p__ -= t__ * (size_t)(step);\
+				for (i__ = 0, q__ = buf__; i__ < t__; i__++, p__ += (step), q__ += 3) {\
+					for (k__ = 0; k__ < 3; k__++) {\
+						if (tn__ > 1) {\
+							for (lo__ = 0, n__ = tn__ - 1; n__ > 1; n__ -= h__) {\
+								h__ = n__ / 2;\
+								lo__ = thr__[lo__ + h__] < q__[k__] ? lo__ + h__ : lo__;\
+							}\
+							p__[k__] = (ptype)(lo__ + (thr__[lo__] < q__[k__]));\
+							continue;\
+						}\
+						v__ = libclut_linear_to_standard__(q__[k__]) * pm__;\
+						if (clip__)\
+							v__ = v__ > 0 ? (v__ < pm__ ? v__ : pm__) : 0;\
+						p__[k__] = (ptype)(v__ + rnd__);\
+					}\
+				}\
+			}\
+		}\
+	} while (0)
+
+/**
+ * The number of pixels per tile in `libclut_convert_rgb_image`
+ * 
+ * Intended for internal use
+ */
+#define LIBCLUT_TILE_SIZE__  256
+
+/**
+ * The greatest `pmax` for which `libclut_convert_rgb_image`
+ * uses tables, which are stored on the stack, rather than
+ * a polynomial approximation of the transfer function
+ * 
+ * Intended for internal use
+ */
+#define LIBCLUT_IMAGE_TABLE_MAX__  1023
+
+/**
+ * Apply gamma correction on the colour curves
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lm'
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     The gamma parameter the red colour curve
+ * @param  g     The gamma parameter the green colour curve
+ * @param  b     The gamma parameter the blue colour curve
+ */
+#define libclut_gamma(clut, max, type, r, g, b)\
+	do {\
+		double m__ = (double)(max);\
+		if (!libclut_1__(r)) libclut__(clut, red,   type, m__ * pow(LIBCLUT_VALUE / m__, 1 / (double)(r)));\
+		if (!libclut_1__(g)) libclut__(clut, green, type, m__ * pow(LIBCLUT_VALUE / m__, 1 / (double)(g)));\
+		if (!libclut_1__(b)) libclut__(clut, blue,  type, m__ * pow(LIBCLUT_VALUE / m__, 1 / (double)(b)));\
+	} while (0)
+
+/**
+ * Apply gamma correction on the colour curves, using a
+ * polynomial approximation of the power function
+ * 
+ * This is a faster variant of `libclut_gamma`. The relative
+ * error of each stop is less than 10⁻⁹, so the result will
+ * differ from the result of `libclut_gamma` by at most one
+ * step for ramps with up to 32-bit precision. If the three
+ * ramps have the same size, all channels are adjusted in
+ * one pass, and the logarithm of a stop is reused by the
+ * next channel if it has the same value. Requires that
+ * `double` is an IEEE 754 binary64.
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     The gamma parameter the red colour curve
+ * @param  g     The gamma parameter the green colour curve
+ * @param  b     The gamma parameter the blue colour curve
+ */
+#define libclut_gamma_fast(clut, max, type, r, g, b)\
+	do {\
+		double m__ = (double)(max), im__ = 1 / m__;\
+		double re__ = 1 / (double)(r), ge__ = 1 / (double)(g), be__ = 1 / (double)(b);\
+		int rt__ = !libclut_1__(r), gt__ = !libclut_1__(g), bt__ = !libclut_1__(b);\
+		double x__, y__, z__, lx__, ly__, lz__;\
+		size_t i__, n__ = (clut)->red_size;\
+		if (n__ == (clut)->green_size && n__ == (clut)->blue_size) {\
+			if (!rt__ && !gt__ && !bt__)\
+				break;\
+			for (i__ = 0; i__ < n__; i__++) {\
+				x__ = (clut)->red[i__] * im__;\
+				y__ = (clut)->green[i__] * im__;\
+				z__ = (clut)->blue[i__] * im__;\
+				lx__ = libclut_log2__(x__ > 0 ? x__ : 1);\
+				ly__ = libclut_eq__(y__, x__) ? lx__ : libclut_log2__(y__ > 0 ? y__ : 1);\
+				lz__ = libclut_eq__(z__, y__) ? ly__ : libclut_log2__(z__ > 0 ? z__ : 1);\
+				if (rt__) (clut)->red[i__]   = (type)(x__ > 0 ? m__ * libclut_exp2__(re__ * lx__) : 0);\
+				if (gt__) (clut)->green[i__] = (type)(y__ > 0 ? m__ * libclut_exp2__(ge__ * ly__) : 0);\
+				if (bt__) (clut)->blue[i__]  = (type)(z__ > 0 ? m__ * libclut_exp2__(be__ * lz__) : 0);\
+			}\
+		} else {\
+			if (rt__) libclut__(clut, red,   type, m__ * libclut_pow__(LIBCLUT_VALUE * im__, re__));\
+			if (gt__) libclut__(clut, green, type, m__ * libclut_pow__(LIBCLUT_VALUE * im__, ge__));\
+			if (bt__) libclut__(clut, blue,  type, m__ * libclut_pow__(LIBCLUT_VALUE * im__, be__));\
+		}\
+	} while (0)
+
+/**
+ * Reverse the colour curves (negative image with gamma preservation)
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps.
+ *               This parameter is not used, it is just a dummy, to unify
+ *               the API with the other functions
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     Whether to invert the red colour curve
+ * @param  g     Whether to invert the green colour curve
+ * @param  b     Whether to invert the blue colour curve
+ */
+#define libclut_negative(clut, max, type, r, g, b)\
+	do {\
+		size_t i__, n__;\
+		type t__;\
+		if (r) {\
+			for (i__ = 0, n__ = (clut)->red_size; i__ < (n__ >> 1); i__++) {\
+				t__ = (clut)->red[i__];\
+				(clut)->red[i__] = (clut)->red[n__ - i__ - 1];\
+				(clut)->red[n__ - i__ - 1] = t__;\
+			}\
+		}\
+		if (g) {\
+			for (i__ = 0, n__ = (clut)->green_size; i__ < (n__ >> 1); i__++) {\
+				t__ = (clut)->green[i__];\
+				(clut)->green[i__] = (clut)->green[n__ - i__ - 1];\
+				(clut)->green[n__ - i__ - 1] = t__;\
+			}\
+		}\
+		if (b) {\
+			for (i__ = 0, n__ = (clut)->blue_size; i__ < (n__ >> 1); i__++)	{\
+				t__ = (clut)->blue[i__];\
+				(clut)->blue[i__] = (clut)->blue[n__ - i__ - 1];\
+				(clut)->blue[n__ - i__ - 1] = t__;\
+			}\
+		}\
+	} while (0)
+
+/**
+ * Invert the colour curves (negative image with gamma invertion), using sRGB
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     Whether to invert the red colour curve
+ * @param  g     Whether to invert the green colour curve
+ * @param  b     Whether to invert the blue colour curve
+ */
+#define libclut_rgb_invert(clut, max, type, r, g, b)\
+	do {\
+		if (r) libclut__(clut, red,   type, (max) - LIBCLUT_VALUE);\
+		if (g) libclut__(clut, green, type, (max) - LIBCLUT_VALUE);\
+		if (b) libclut__(clut, blue,  type, (max) - LIBCLUT_VALUE);\
+	} while (0)
+
+/**
+ * Invert the colour curves (negative image with gamma invertion), using CIE xyY
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     Whether to invert the red colour curve
+ * @param  g     Whether to invert the green colour curve
+ * @param  b     Whether to invert the blue colour curve
+ */
+#define libclut_cie_invert(clut, max, type, r, g, b)\
+	libclut_cie__(clut, max, type, (r) && (g) && (b), r, g, b, 1 - Y__, 1 - Y__, 1 - Y__)
+
+/**
+ * Apply S-curve correction on the colour curves.
+ * This is intended for fine tuning LCD monitors,
+ * 4.5 is good value start start testing at.
+ * You would probably like to use rgb_limits before
+ * this to adjust the blackpoint as that is the
+ * only way to adjust the blackpoint on many LCD
+ * monitors.
+ * 
+ * For integer ramps with a `max` of at most 4095, the
+ * logarithm is tabulated once for each possible value
+ * and shared by the channels
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lm'
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  rp    Pointer to the sigmoid parameter for the red curve. `NULL` for no adjustment
+ * @param  gp    Pointer to the sigmoid parameter for the green curve. `NULL` for no adjustment
+ * @param  bp    Pointer to the sigmoid parameter for the blue curve. `NULL` for no adjustment
+ */
+#define libclut_sigmoid(clut, max, type, rp, gp, bp)\
+	do {\
+		double *gcc_6_1_1_workaround, m__ = (double)(max);\
+		const double h__ = (double)5 / 10;\
+		size_t tn__ = 0, ti__;\
+		gcc_6_1_1_workaround = rp;\
+		if (gcc_6_1_1_workaround)\
+			tn__ += (clut)->red_size;\
+		gcc_6_1_1_workaround = gp;\
+		if (gcc_6_1_1_workaround)\
+			tn__ += (clut)->green_size;\
+		gcc_6_1_1_workaround = bp;\
+		if (gcc_6_1_1_workaround)\
+			tn__ += (clut)->blue_size;\
+		tn__ = (libclut_tabulate__(type, max) && tn__ > (size_t)(max)) ? (size_t)(max) + 1 : 1;\
+		{\
+			double t__[tn__]; /* Do not use alloca! */\
+			for (ti__ = 0; tn__ > 1 && ti__ < tn__; ti__++)\
+				t__[ti__] = libclut_logit__(m__, (double)ti__);\
+			gcc_6_1_1_workaround = rp;\
+			if (gcc_6_1_1_workaround)\
+				libclut_sigmoid__(clut, max, type, red);\
+			gcc_6_1_1_workaround = gp;\
+			if (gcc_6_1_1_workaround)\
+				libclut_sigmoid__(clut, max, type, green);\
+			gcc_6_1_1_workaround = bp;\
+			if (gcc_6_1_1_workaround)\
+				libclut_sigmoid__(clut, max, type, blue);\
+		}\
+	}\
+	while (0)
+
+/**
+ * Apply S-curve correction on the colour curves.
+ * This is intended for fine tuning LCD monitors,
+ * 4.5 is good value start start testing at.
+ * You would probably like to use rgb_limits before
+ * this to adjust the blackpoint as that is the
+ * only way to adjust the blackpoint on many LCD
+ * monitors.
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lm'
+ * 
+ * Intended for internal use
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ */
+#define libclut_sigmoid__(clut, max, type, channel)\
+	do {\
+		double k__ = 1 / *gcc_6_1_1_workaround, l__;\
+		size_t i__;\
+		for (i__ = 0; i__ < (clut)->channel##_size; i__++) {\
+			l__ = (tn__ > 1 && (size_t)(clut)->channel[i__] < tn__)\
+				? t__[(size_t)(clut)->channel[i__]]\
+				: libclut_logit__(m__, (double)(clut)->channel[i__]);\
+			(clut)->channel[i__] = (type)(m__ * (h__ - l__ * k__));\
+		}\
+	} while (0)
+
+/**
+ * Calculate the logit term used by `libclut_sigmoid`
+ * 
+ * Values that are out of the domain are mapped to
+ * ±37.024483 rather than to infinity or NaN
+ * 
+ * Requires linking with '-lm'
+ * 
+ * Intended for internal use
+ * 
+ * @param   m  The maximum value on each stop in the ramps
+ * @param   x  The current value of the stop
+ * @return     `log(m / x - 1)`
+ */
+static inline double
+libclut_logit__(double m, double x)
+{
+	double t = m / x - 1;
+	double l = log(t > 0 ? t : 1);
+	l = t < HUGE_VAL ? l : 37.024483;
+	return t > 0 ? l : -37.024483;
+}
+
+/**
+ * Calculate the base-2 logarithm of a positive, normal value,
+ * using an odd polynomial in (m - 1) / (m + 1), where m is the
+ * mantissa scaled to [√½, √2)
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
+ * 
+ * Intended for internal use
+ * 
+ * @param   x  The value, must be positive and normal
+ * @return     log₂ x, with an absolute error less than 10⁻¹⁰
+ */
+static inline double
+libclut_log2__(double x)
+{
+	uint64_t u, big;
+	double m, z, z2, e;
+	memcpy(&u, &x, sizeof(u));
+	big = (u & UINT64_C(0x000FFFFFFFFFFFFF)) > UINT64_C(0x0006A09E667F3BCC);
+	e = (double)((int64_t)(u >> 52) - 1023 + (int64_t)big);
+	u = (u & UINT64_C(0x000FFFFFFFFFFFFF)) | ((UINT64_C(0x3FF) - big) << 52);
+	memcpy(&m, &u, sizeof(m));
+	z = (m - 1) / (m + 1);
+	z2 = z * z;
+	return e + z * (2.8853900817779268 + z2 * (0.9617966939259756 + z2 * (0.5770780163555853 +
+	           z2 * (0.4121985831111324 + z2 * (0.3205988979753252 + z2 * 0.2623081892525388)))));
+}
+
+/**
+ * Calculate two raised to a power, using a polynomial
+ * over the fractional part of the exponent
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
+ * and that the rounding mode is round to nearest
+ * 
+ * Intended for internal use
+ * 
+ * @param   y  The exponent, values outside [-1022, 1023]
+ *             are saturated
+ * @return     2 to the power of `y`, with a relative
+ *             error less than 10⁻¹⁰
+ */
+static inline double
+libclut_exp2__(double y)
+{
+	const double round__ = 6755399441055744.; /* 1.5 ⋅ 2⁵², adding and subtracting it rounds to integer */
+	double n, f, p;
+	uint64_t u;
+	y = y < -1022 ? -1022 : y > 1023 ? 1023 : y;
+	n = (y + round__) - round__;
+	f = y - n;
+	f = 1 + f * (0.6931471805599453 + f * (0.2402265069591007 + f * (0.055504108664821576 +
+	        f * (0.009618129107628477 + f * (0.0013333558146428441 + f * (0.00015403530393381606 +
+	        f * (1.5252733804059838e-05 + f * (1.3215486790144305e-06 + f * 1.0178086009239696e-07))))))));
+	u = (uint64_t)((int64_t)n + 1023) << 52;
+	memcpy(&p, &u, sizeof(p));
+	return f * p;
+}
+
+/**
+ * Raise a value to a power, as needed by `libclut_gamma_fast`
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
+ * 
+ * Intended for internal use
+ * 
+ * @param   x  The base, values that are not positive yield zero,
+ *             must not be subnormal or infinite
+ * @param   e  The exponent
+ * @return     `x` to the power of `e`
+ */
+static inline double
+libclut_pow__(double x, double e)
+{
+	double p = libclut_exp2__(e * libclut_log2__(x > 0 ? x : 1));
+	return x > 0 ? p : 0;
+}
+
+/**
+ * Convert one component from [0, 1] linear sRGB to [0, 1] sRGB,
+ * like `libclut_model_linear_to_standard1`, but using
+ * `libclut_pow__` instead of `pow`
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
+ * 
+ * Intended for internal use
+ * 
+ * @param   c  The linear sRGB value
+ * @return     Corresponding sRGB value
+ */
+static inline double
+libclut_linear_to_standard__(double c)
+{
+	return c <= 0.0031308 ? 12.92 * c : 1.055 * libclut_pow__(c, 1 / 2.4) - 0.055;
+}
+
+/**
+ * Convert one component from [0, 1] sRGB to [0, 1] linear sRGB,
+ * like `libclut_model_standard_to_linear1`, but using
+ * `libclut_pow__` instead of `pow`
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
+ * 
+ * Intended for internal use
+ * 
+ * @param   c  The sRGB value
+ * @return     Corresponding linear sRGB value
+ */
+static inline double
+libclut_standard_to_linear__(double c)
+{
+	return c <= 0.04045 ? c / 12.92 : libclut_pow__((c + 0.055) / 1.055, 2.4);
+}
+
+/**
+ * The greatest `max` for which operations on integer ramps
+ * may use a lookup table indexed by the stop values, rather
+ * than evaluate the expensive part of the operation for
+ * each stop. The table is allocated on the stack.
+ * 
+ * Intended for internal use
+ */
+#define LIBCLUT_TABLE_MAX__  4095
+
+/**
+ * Check whether an operation may use a lookup table
+ * indexed by the stop values
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Intended for internal use
+ * 
+ * @param   type  The data type used for each stop in the ramps
+ * @param   max   The maximum value on each stop in the ramps
+ * @return        Whether `type` is an integer type and `max`
+ *                is at most `LIBCLUT_TABLE_MAX__`
+ */
+#define libclut_tabulate__(type, max)\
+	((type)0.5 <= 0 && (double)(max) <= LIBCLUT_TABLE_MAX__)
+
+/**
+ * The greatest number of samples `libclut_manipulate_sampled` and
+ * `libclut_cie_manipulate_sampled` evaluate the functions at; the
+ * samples are stored on the stack, so if more are requested, the
+ * functions are evaluated exactly instead
+ */
+#define LIBCLUT_SAMPLES_MAX  1024
+
+/**
+ * Changes the blackpoint and the whitepoint, using sRGB
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  rmin  The red component value of the blackpoint
+ * @param  rmax  The red component value of the whitepoint
+ * @param  gmin  The green component value of the blackpoint
+ * @param  gmax  The green component value of the whitepoint
+ * @param  bmin  The blue component value of the blackpoint
+ * @param  bmax  The blue component value of the whitepoint
+ */
+#define libclut_rgb_limits(clut, max, type, rmin, rmax, gmin, gmax, bmin, bmax)\
+	do {\
+		double diff__;\
+		if (!libclut_0__(rmin) || !libclut_1__(rmax)) {\
+			diff__ = (double)(rmax) - (double)(rmin);\
+			libclut__(clut, red, type, LIBCLUT_VALUE / (double)(max) * diff__ + (rmin));\
+		}\
+		if (!libclut_0__(gmin) || !libclut_1__(gmax)) {\
+			diff__ = (double)(gmax) - (double)(gmin);\
+			libclut__(clut, green, type, LIBCLUT_VALUE / (double)(max) * diff__ + (gmin));\
+		}\
+		if (!libclut_0__(bmin) || !libclut_1__(bmax)) {\
+			diff__ = (double)(bmax) - (double)(bmin);\
+			libclut__(clut, blue, type, LIBCLUT_VALUE / (double)(max) * diff__ + (bmin));\
+		}\
+	} while (0)
+
+/**
+ * Changes the blackpoint and the whitepoint, using sRGB,
+ * without any floating-point arithmetics on each stop
+ * 
+ * This is a fixed-point variant of `libclut_rgb_limits`,
+ * intended for machines with poor floating-point performance.
+ * Unlike `libclut_rgb_limits`, the result is rounded to the
+ * nearest value rather than truncated, and it is saturated
+ * to [0, `max`]
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps, must
+ *               be an unsigned integer type of at most 16 bits
+ * @param  rmin  The red component value of the blackpoint
+ * @param  rmax  The red component value of the whitepoint
+ * @param  gmin  The green component value of the blackpoint
+ * @param  gmax  The green component value of the whitepoint
+ * @param  bmin  The blue component value of the blackpoint
+ * @param  bmax  The blue component value of the whitepoint
+ */
+#define libclut_rgb_limits_fixed(clut, max, type, rmin, rmax, gmin, gmax, bmin, bmax)\
+	do {\
+		if (!libclut_0__(rmin) || !libclut_1__(rmax))\
+			libclut_fixed__(clut, red,   max, type, ((double)(rmax) - (double)(rmin)) / (double)(max), (rmin));\
+		if (!libclut_0__(gmin) || !libclut_1__(gmax))\
+			libclut_fixed__(clut, green, max, type, ((double)(gmax) - (double)(gmin)) / (double)(max), (gmin));\
+		if (!libclut_0__(bmin) || !libclut_1__(bmax))\
+			libclut_fixed__(clut, blue,  max, type, ((double)(bmax) - (double)(bmin)) / (double)(max), (bmin));\
+	} while (0)
+
+/**
+ * Changes the blackpoint and the whitepoint, using CIE xyY
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  rmin  The red component value of the blackpoint
+ * @param  rmax  The red component value of the whitepoint
+ * @param  gmin  The green component value of the blackpoint
+ * @param  gmax  The green component value of the whitepoint
+ * @param  bmin  The blue component value of the blackpoint
+ * @param  bmax  The blue component value of the whitepoint
+ */
+#define libclut_cie_limits(clut, max, type, rmin, rmax, gmin, gmax, bmin, bmax)\
+	do {\
+		double rd__ = (rmax) - (rmin), gd__ = (gmax) - (gmin), bd__ = (bmax) - (bmin);\
+		libclut_cie__(clut, max, type,\
+		              libclut_eq__((rmin), (gmin)) && libclut_eq__((gmin), (bmin)) &&\
+	                      libclut_eq__((rmax), (gmax)) && libclut_eq__((gmax), (bmax)),\
+		              !libclut_0__(rmin) || !libclut_1__(rmax),\
+		              !libclut_0__(gmin) || !libclut_1__(gmax),\
+		              !libclut_0__(bmin) || !libclut_1__(bmax),\
+		              Y__ * rd__ + (rmin), Y__ * gd__ + (gmin), Y__ * bd__ + (bmin));\
+	} while (0)
+
+/**
+ * Append brightness correction using sRGB, as done by
+ * `libclut_rgb_brightness`, to an affine operation
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  op  Pointer to the `libclut_affine_t`, that shall be updated
+ *             to do what it did before and then the correction
+ * @param  r   The brightness parameter for the red curve
+ * @param  g   The brightness parameter for the green curve
+ * @param  b   The brightness parameter for the blue curve
+ */
+#define libclut_affine_brightness(op, r, g, b)\
+	do {\
+		libclut_affine__(op, red,   (r), 0);\
+		libclut_affine__(op, green, (g), 0);\
+		libclut_affine__(op, blue,  (b), 0);\
+	} while (0)
+
+/**
+ * Append contrast correction using sRGB, as done by
+ * `libclut_rgb_contrast`, to an affine operation
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  op   Pointer to the `libclut_affine_t`, that shall be updated
+ *              to do what it did before and then the correction
+ * @param  max  The maximum value on each stop in the ramps
+ * @param  r    The contrast parameter for the red curve
+ * @param  g    The contrast parameter for the green curve
+ * @param  b    The contrast parameter for the blue curve
+ */
+#define libclut_affine_contrast(op, max, r, g, b)\
+	do {\
+		const double h__ = (double)(max) * 5 / 10;\
+		libclut_affine__(op, red,   (r), h__ * (1 - (r)));\
+		libclut_affine__(op, green, (g), h__ * (1 - (g)));\
+		libclut_affine__(op, blue,  (b), h__ * (1 - (b)));\
+	} while (0)
+
+/**
+ * Append a change of the blackpoint and the whitepoint using
+ * sRGB, as done by `libclut_rgb_limits`, to an affine operation
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  op    Pointer to the `libclut_affine_t`, that shall be updated
+ *               to do what it did before and then the change
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  rmin  The red component value of the blackpoint
+ * @param  rmax  The red component value of the whitepoint
+ * @param  gmin  The green component value of the blackpoint
+ * @param  gmax  The green component value of the whitepoint
+ * @param  bmin  The blue component value of the blackpoint
+ * @param  bmax  The blue component value of the whitepoint
+ */
+#define libclut_affine_limits(op, max, rmin, rmax, gmin, gmax, bmin, bmax)\
+	do {\
+		libclut_affine__(op, red,   ((double)(rmax) - (double)(rmin)) / (double)(max), (rmin));\
+		libclut_affine__(op, green, ((double)(gmax) - (double)(gmin)) / (double)(max), (gmin));\
+		libclut_affine__(op, blue,  ((double)(bmax) - (double)(bmin)) / (double)(max), (bmin));\
+	} while (0)
+
+/**
+ * Append an affine operation to another affine operation
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  op    Pointer to the `libclut_affine_t`, that shall be updated
+ *               to do what it did before and then what `next` does
+ * @param  next  Pointer to the `libclut_affine_t` to append, may be `op`
+ */
+#define libclut_affine_compose(op, next)\
+	do {\
+		libclut_affine_t n__ = *(next);\
+		libclut_affine__(op, red,   n__.red_factor,   n__.red_offset);\
+		libclut_affine__(op, green, n__.green_factor, n__.green_offset);\
+		libclut_affine__(op, blue,  n__.blue_factor,  n__.blue_offset);\
+	} while (0)
+
+/**
+ * Apply an affine operation on the colour curves in one pass
+ * 
+ * The result is the same as applying the operations the affine
+ * operation was built from one by one, except that the stops are
+ * only rounded once, and channels that the operation does not
+ * change are not touched
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  op    Pointer to the `libclut_affine_t`
+ */
+#define libclut_rgb_affine(clut, max, type, op)\
+	do {\
+		const libclut_affine_t *op__ = (op);\
+		double a__, b__;\
+		if (!libclut_1__(op__->red_factor) || !libclut_0__(op__->red_offset)) {\
+			a__ = op__->red_factor, b__ = op__->red_offset;\
+			libclut__(clut, red, type, LIBCLUT_VALUE * a__ + b__);\
+		}\
+		if (!libclut_1__(op__->green_factor) || !libclut_0__(op__->green_offset)) {\
+			a__ = op__->green_factor, b__ = op__->green_offset;\
+			libclut__(clut, green, type, LIBCLUT_VALUE * a__ + b__);\
+		}\
+		if (!libclut_1__(op__->blue_factor) || !libclut_0__(op__->blue_offset)) {\
+			a__ = op__->blue_factor, b__ = op__->blue_offset;\
+			libclut__(clut, blue, type, LIBCLUT_VALUE * a__ + b__);\
+		}\
+	} while (0)
+
+/**
+ * Apply an affine operation on the colour curves in one pass,
+ * without any floating-point arithmetics on each stop
+ * 
+ * This is a fixed-point variant of `libclut_rgb_affine`,
+ * intended for machines with poor floating-point performance.
+ * Unlike `libclut_rgb_affine`, the result is rounded to the
+ * nearest value rather than truncated, and it is saturated
+ * to [0, `max`]
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps, must
+ *               be an unsigned integer type of at most 16 bits
+ * @param  op    Pointer to the `libclut_affine_t`
+ */
+#define libclut_rgb_affine_fixed(clut, max, type, op)\
+	do {\
+		const libclut_affine_t *op__ = (op);\
+		if (!libclut_1__(op__->red_factor) || !libclut_0__(op__->red_offset))\
+			libclut_fixed__(clut, red,   max, type, op__->red_factor,   op__->red_offset);\
+		if (!libclut_1__(op__->green_factor) || !libclut_0__(op__->green_offset))\
+			libclut_fixed__(clut, green, max, type, op__->green_factor, op__->green_offset);\
+		if (!libclut_1__(op__->blue_factor) || !libclut_0__(op__->blue_offset))\
+			libclut_fixed__(clut, blue,  max, type, op__->blue_factor,  op__->blue_offset);\
+	} while (0)
+
+/**
+ * Manipulate the colour curves using a function on the sRGB colour space
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     Function to manipulate the red colour curve, should either
+ *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param  g     Function to manipulate the green colour curve, should either
+ *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param  b     Function to manipulate the blue colour curve, should either
+ *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ */
+#define libclut_manipulate(clut, max, type, r, g, b)\
+	do {\
+		double m__ = (double)(max);\
+		double (*gcc_6_1_1_workaround__)(double);\
+		gcc_6_1_1_workaround__ = r;\
+		if (gcc_6_1_1_workaround__)\
+			libclut__(clut, red,   type, m__ * (gcc_6_1_1_workaround__)(LIBCLUT_VALUE / m__));\
+		gcc_6_1_1_workaround__ = g;\
+		if (gcc_6_1_1_workaround__)\
+			libclut__(clut, green, type, m__ * (gcc_6_1_1_workaround__)(LIBCLUT_VALUE / m__));\
+		gcc_6_1_1_workaround__ = b;\
+		if (gcc_6_1_1_workaround__)\
+			libclut__(clut, blue,  type, m__ * (gcc_6_1_1_workaround__)(LIBCLUT_VALUE / m__));\
+	} while (0)
+
+/**
+ * Manipulate the colour curves using a function on the CIE xyY colour space
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     Function to manipulate the red colour curve, should either
+ *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param  g     Function to manipulate the green colour curve, should either
+ *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param  b     Function to manipulate the blue colour curve, should either
+ *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ */
+#define libclut_cie_manipulate(clut, max, type, r, g, b)\
+	do {\
+		double (*rf__)(double) = (r), (*gf__)(double) = (g), (*bf__)(double) = (b);\
+		libclut_cie__(clut, max, type, rf__ && gf__ && bf__, rf__, gf__, bf__, rf__(Y__), gf__(Y__), bf__(Y__));\
+	} while (0)
+
+/**
+ * Manipulate the colour curves using a function on the sRGB colour
+ * space, like `libclut_manipulate`, but evaluate the functions fewer
+ * times, which is useful if the functions are expensive
+ * 
+ * If `samples` is 0, the result is identical to `libclut_manipulate`,
+ * but each function is only evaluated once per distinct stop value:
+ * for integer ramps with a small `max`, the results are memoised in a
+ * table indexed by the stop value, otherwise a result is reused for
+ * consecutive stops with the same value, which covers all repeated
+ * values in monotonic ramps.
+ * 
+ * If `samples` is at least 2, each function is only evaluated at
+ * `samples` evenly spaced points in [0, 1], and the stops are
+ * interpolated linearly between them. The error is at most an eighth
+ * of the greatest magnitude of the function's second derivative times
+ * the squared distance between the points, `1 / (samples - 1)`; use
+ * more samples for more accuracy. The samples are stored on the stack,
+ * if `samples` is greater than `LIBCLUT_SAMPLES_MAX`, it is treated as 0.
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut     Pointer to the gamma ramps, must have the arrays
+ *                  `red`, `green`, and `blue`, and the scalars
+ *                  `red_size`, `green_size`, and `blue_size`. Ramp
+ *                  structures from libgamma or libcoopgamma can be used.
+ * @param  max      The maximum value on each stop in the ramps
+ * @param  type     The data type used for each stop in the ramps
+ * @param  r        Function to manipulate the red colour curve, should either
+ *                  be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param  g        Function to manipulate the green colour curve, should either
+ *                  be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param  b        Function to manipulate the blue colour curve, should either
+ *                  be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param  samples  The number of points to evaluate each function at,
+ *                  0 to evaluate them exactly for each distinct value
+ */
+#define libclut_manipulate_sampled(clut, max, type, r, g, b, samples)\
+	do {\
+		double (*gcc_6_1_1_workaround__)(double);\
+		size_t k__ = (samples) <= LIBCLUT_SAMPLES_MAX ? (size_t)(samples) : 0, tn__;\
+		tn__ = k__ > 1 ? k__ : libclut_tabulate__(type, max) ? (size_t)(max) + 1 : 1;\
+		{\
+			double t__[tn__]; /* Do not use alloca! */\
+			char d__[tn__];\
+			gcc_6_1_1_workaround__ = r;\
+			if (gcc_6_1_1_workaround__)\
+				libclut_sampled__(clut, max, type, red,   gcc_6_1_1_workaround__);\
+			gcc_6_1_1_workaround__ = g;\
+			if (gcc_6_1_1_workaround__)\
+				libclut_sampled__(clut, max, type, green, gcc_6_1_1_workaround__);\
+			gcc_6_1_1_workaround__ = b;\
+			if (gcc_6_1_1_workaround__)\
+				libclut_sampled__(clut, max, type, blue,  gcc_6_1_1_workaround__);\
+		}\
+	} while (0)
+
+/**
+ * Manipulate the colour curves using a function on the sRGB colour
+ * space, like `libclut_manipulate`, but pass many stops to each call
+ * to the functions, so that the functions are not called once per
+ * stop and can be vectorised
+ * 
+ * The stops are passed in chunks of at most `LIBCLUT_BATCH_SIZE`
+ * stops, so each function may be called multiple times per ramp.
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     Function to manipulate the red colour curve, should either be
+ *               `NULL` or a `void (*)(const double *in, double *out, size_t n,
+ *               void *user)` that maps each of the `n` [0, 1] values in `in`
+ *               to a [0, 1] value stored in the same position in `out`;
+ *               `in` and `out` do not overlap and are suitably aligned
+ *               for `double`
+ * @param  g     Function to manipulate the green colour curve, see `r`
+ * @param  b     Function to manipulate the blue colour curve, see `r`
+ * @param  user  Pointer passed as the last argument to the functions
+ */
+#define libclut_manipulate_batch(clut, max, type, r, g, b, user)\
+	do {\
+		void (*gcc_6_1_1_workaround__)(const double *, double *, size_t, void *);\
+		gcc_6_1_1_workaround__ = r;\
+		if (gcc_6_1_1_workaround__)\
+			libclut_batch__(clut, max, type, red,   gcc_6_1_1_workaround__, user);\
+		gcc_6_1_1_workaround__ = g;\
+		if (gcc_6_1_1_workaround__)\
+			libclut_batch__(clut, max, type, green, gcc_6_1_1_workaround__, user);\
+		gcc_6_1_1_workaround__ = b;\
+		if (gcc_6_1_1_workaround__)\
+			libclut_batch__(clut, max, type, blue,  gcc_6_1_1_workaround__, user);\
+	} while (0)
+
+/**
+ * The greatest number of stops passed to each call
+ * to the functions in `libclut_manipulate_batch`
+ */
+#define LIBCLUT_BATCH_SIZE  256
+
+/**
+ * Manipulate the colour curves using a function on the CIE xyY colour
+ * space, like `libclut_cie_manipulate`, but only evaluate each function
+ * at `samples` evenly spaced points in [0, 1], and interpolate linearly
+ * between them, see `libclut_manipulate_sampled` for the accuracy
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  clut     Pointer to the gamma ramps, must have the arrays
+ *                  `red`, `green`, and `blue`, and the scalars
+ *                  `red_size`, `green_size`, and `blue_size`. Ramp
+ *                  structures from libgamma or libcoopgamma can be used.
+ * @param  max      The maximum value on each stop in the ramps
+ * @param  type     The data type used for each stop in the ramps
+ * @param  r        Function to manipulate the red colour curve, should either
+ *                  be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param  g        Function to manipulate the green colour curve, should either
+ *                  be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param  b        Function to manipulate the blue colour curve, should either
+ *                  be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param  samples  The number of points to evaluate each function at,
+ *                  if less than 2 or greater than `LIBCLUT_SAMPLES_MAX`,
+ *                  the functions are evaluated exactly as with
+ *                  `libclut_cie_manipulate`
+ */
+#define libclut_cie_manipulate_sampled(clut, max, type, r, g, b, samples)\
+	do {\
+		double (*rf__)(double) = (r), (*gf__)(double) = (g), (*bf__)(double) = (b);\
+		size_t k__ = (samples) > 1 && (samples) <= LIBCLUT_SAMPLES_MAX ? (size_t)(samples) : 1, j__;\
+		double rt__[k__], gt__[k__], bt__[k__]; /* Do not use alloca! */\
+		if (k__ < 2) {\
+			libclut_cie__(clut, max, type, rf__ && gf__ && bf__, rf__, gf__, bf__,\
+			              rf__(Y__), gf__(Y__), bf__(Y__));\
+			break;\
+		}\
+		for (j__ = 0; j__ < k__; j__++) {\
+			if (rf__)  rt__[j__] = rf__((double)j__ / (double)(k__ - 1));\
+			if (gf__)  gt__[j__] = gf__((double)j__ / (double)(k__ - 1));\
+			if (bf__)  bt__[j__] = bf__((double)j__ / (double)(k__ - 1));\
+		}\
+		libclut_cie__(clut, max, type, rf__ && gf__ && bf__, rf__, gf__, bf__,\
+		              libclut_interpolate__(rt__, k__, Y__),\
+		              libclut_interpolate__(gt__, k__, Y__),\
+		              libclut_interpolate__(bt__, k__, Y__));\
+	} while (0)
+
+/**
+ * Resets colour curvers to linear mappings
+ * (Identity mapping if imaginged to map from [0, 1] to [0, 1])
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     Whether to reset the red colour curve
+ * @param  g     Whether to reset the green colour curve
+ * @param  b     Whether to reset the blue colour curve
+ */
+#define libclut_start_over(clut, max, type, r, g, b)\
+	do {\
+		size_t i__;\
+		double m__, max__ = (double)(max);\
+		if (r) {\
+			m__ = (double)((clut)->red_size - 1);\
+			for (i__ = 0; i__ < (clut)->red_size; i__++)\
+				(clut)->red[i__] = (type)(((double)i__ / m__) * max__);\
+		}\
+		if (g) {\
+			m__ = (double)((clut)->green_size - 1);\
+			for (i__ = 0; i__ < (clut)->green_size; i__++)\
+				(clut)->green[i__] = (type)(((double)i__ / m__) * max__);\
+		}\
+		if (b) {\
+			m__ = (double)((clut)->blue_size - 1);\
+			for (i__ = 0; i__ < (clut)->blue_size; i__++)\
+				(clut)->blue[i__] = (type)(((double)i__ / m__) * max__);\
+		}\
+	} while (0)
+
+/**
+ * Clip colour curves to only map to values between the minimum and maximum.
+ * This should be done, before apply the curves, and before applying changes
+ * with limited domain.
+ * 
+ * Values below 0 are set to 0, and values above `max` are set to `max`
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  r     Whether to clip the red colour curve
+ * @param  g     Whether to clip the green colour curve
+ * @param  b     Whether to clip the blue colour curve
+ */
+#define libclut_clip(clut, max, type, r, g, b)\
+	do {\
+		if (r) libclut__(clut, red,   type, libclut_clip__(0, LIBCLUT_VALUE, max));\
+		if (g) libclut__(clut, green, type, libclut_clip__(0, LIBCLUT_VALUE, max));\
+		if (b) libclut__(clut, blue,  type, libclut_clip__(0, LIBCLUT_VALUE, max));\
+	} while (0)
+
+/**
+ * Truncates a value to fit a boundary
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Intended for internal use
+ * 
+ * @param   min  The minimum allowed value
+ * @param   val  The current value
+ * @param   max  The maximum allowed value
+ * @return       The value truncated into its boundary
+ */
+#define libclut_clip__(min, val, max)\
+	(LIBCLUT_VALUE < (min) ? (min) : LIBCLUT_VALUE > (max) ? (max) : LIBCLUT_VALUE)
+
+/**
+ * Emulates low colour resolution
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ * @param  rx    The desired emulated red encoding resolution, 0 for unchanged
+ * @param  ry    The desired emulated red output resolution, 0 for unchanged
+ * @param  gx    The desired emulated green encoding resolution, 0 for unchanged
+ * @param  gy    The desired emulated green output resolution, 0 for unchanged
+ * @param  bx    The desired emulated blue encoding resolution, 0 for unchanged
+ * @param  by    The desired emulated blue output resolution, 0 for unchanged
+ */
+#define libclut_lower_resolution(clut, max, type, rx, ry, gx, gy, bx, by)\
+	do {\
+		libclut_lower_resolution__(clut, red,   max, type, rx, ry);\
+		libclut_lower_resolution__(clut, green, max, type, gx, gy);\
+		libclut_lower_resolution__(clut, blue,  max, type, bx, by);\
+	} while (0)
+
+/**
+ * Emulates low colour resolution of a channel
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Intended for internal use
+ * 
+ * @param  clut     Pointer to the gamma ramps, must have the arrays
+ *                  `red`, `green`, and `blue`, and the scalars
+ *                  `red_size`, `green_size`, and `blue_size`. Ramp
+ *                  structures from libgamma or libcoopgamma can be used.
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ * @param  max      The maximum value on each stop in the ramps
+ * @param  type     The data type used for each stop in the ramps
+ * @param  x        The desired emulated encoding resolution, 0 for unchanged
+ * @param  y        The desired emulated output resolution, 0 for unchanged
+ */
+#define libclut_lower_resolution__(clut, channel, max, type, x, y)\
+	do {\
+		if ((x) || (y)) {\
+			size_t x__, y__, i__, n__ = (clut)->channel##_size;\
+			double xm__ = (double)((x) - 1), ym__ = (double)((y) - 1);\
+			double m__ = (double)(max), nm__ = (double)(n__ - 1);\
+			type c__[n__]; /* Do not use alloca! */\
+			const double h__ = (double)5 / 10;\
+			for (i__ = 0; i__ < n__; i__++) {\
+				if ((x__ = i__), (x)) {\
+					x__ = (size_t)((double)i__ * (double)(x) / (double)n__);\
+					x__ = (size_t)((double)x__ * nm__ / xm__);\
+				}\
+				if (!(y)) {\
+					c__[i__] = (clut)->channel[x__];\
+				} else {\
+					y__ = (size_t)((double)((clut)->channel[x__]) / (max) * ym__ + h__);\
+					c__[i__] = (type)((double)y__ / ym__ * m__);\
+				}\
+			}\
+			memcpy((clut)->channel, c__, n__ * sizeof(type));\
+		}\
+	} while (0)
+
+/**
+ * Translates a gamma ramp structure to another gamma ramp structure type
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  dclut  Pointer to the desired gamma ramps, must have the arrays
+ *                `red`, `green`, and `blue`, and the scalars `red_size`,
+ *                `green_size`, and `blue_size`. Ramp structures from
+ *                libgamma or libcoopgamma can be used.
+ * @param  dmax   The maximum value on each stop in the ramps in `dclut`
+ * @param  dtype  The data type used for each stop in the ramps in `dclut`
+ * @param  sclut  Pointer to the set gamma ramps, must have the arrays
+ *                `red`, `green`, and `blue`, and the scalars `red_size`,
+ *                `green_size`, and `blue_size`. Ramp structures from
+ *                libgamma or libcoopgamma can be used
+ * @param  smax   The maximum value on each stop in the ramps in `sclut`
+ * @param  stype  The data type used for each stop in the ramps in `sclut`
+ *                (Not actually used)
+ */
+#define libclut_translate(dclut, dmax, dtype, sclut, smax, stype)\
+	do {\
+		libclut_translate__(dclut, dmax, dtype, sclut, smax, stype, red);\
+		libclut_translate__(dclut, dmax, dtype, sclut, smax, stype, green);\
+		libclut_translate__(dclut, dmax, dtype, sclut, smax, stype, blue);\
+	} while (0)
+
+/**
+ * Translates a gamma ramp structure to another gamma ramp structure type
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * This is intended for internal use
+ * 
+ * @param  dclut    Pointer to the desired gamma ramps, must have the arrays
+ *                  `red`, `green`, and `blue`, and the scalars `red_size`,
+ *                  `green_size`, and `blue_size`. Ramp structures from
+ *                  libgamma or libcoopgamma can be used.
+ * @param  dmax     The maximum value on each stop in the ramps in `dclut`
+ * @param  dtype    The data type used for each stop in the ramps in `dclut`
+ * @param  sclut    Pointer to the set gamma ramps, must have the arrays
+ *                  `red`, `green`, and `blue`, and the scalars `red_size`,
+ *                  `green_size`, and `blue_size`. Ramp structures from
+ *                  libgamma or libcoopgamma can be used.
+ * @param  smax     The maximum value on each stop in the ramps in `sclut`
+ * @param  stype    The data type used for each stop in the ramps in `sclut`.
+ *                  (Not actually used)
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ */
+#define libclut_translate__(dclut, dmax, dtype, sclut, smax, stype, channel)\
+	do {\
+		size_t di__, si__, sj__;\
+		size_t dn__ = (dclut)->channel##_size;\
+		size_t sn__ = (sclut)->channel##_size;\
+		double dm__ = (double)(dmax);\
+		double sm__ = (double)(smax);\
+		double dmsm__ = dm__ / sm__;\
+		double x__, y__;\
+		if (dn__ == sn__) {\
+			for (di__ = 0; di__ < dn__; di__++) {\
+				y__ = (double)((sclut)->channel[di__]) * dmsm__;\
+				(dclut)->channel[di__] = (dtype)y__;\
+			}\
+		} else {\
+			for (di__ = 0; di__ < dn__; di__++) {\
+				x__ = (double)di__ / (double)(dn__ - 1) * (double)(sn__ - 1);\
+				si__ = (size_t)(x__);\
+				sj__ = si__ + (si__ + 1 < sn__);\
+				x__ -= (double)si__;\
+				y__  = (double)((sclut)->channel[si__]) * (1 - x__);\
+				y__ += (double)((sclut)->channel[sj__]) * (x__);\
+				y__ *= dmsm__;\
+				(dclut)->channel[di__] = (dtype)y__;\
+			}\
+		}\
+	} while (0)
+
+/**
+ * Calculate the inverse of monotone gamma ramps, so that applying
+ * the inverse with `libclut_apply` undoes the original ramps
+ * 
+ * The source ramps are interpolated linearly between the stops.
+ * Where a source ramp is flat, the inverse takes the first stop,
+ * in the direction the ramp increases, that has the value, and
+ * values outside the range of a source ramp map to the end of
+ * the ramp closest to them. Each channel is calculated in one
+ * pass over both ramps. For integer types, the result is
+ * rounded to the nearest value.
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  dclut  Pointer to the output gamma ramps, must have the arrays
+ *                `red`, `green`, and `blue`, and the scalars `red_size`,
+ *                `green_size`, and `blue_size`. Ramp structures from
+ *                libgamma or libcoopgamma can be used. Must not be `sclut`.
+ * @param  dmax   The maximum value on each stop in the ramps in `dclut`
+ * @param  dtype  The data type used for each stop in the ramps in `dclut`
+ * @param  sclut  Pointer to the gamma ramps to invert, must have the arrays
+ *                `red`, `green`, and `blue`, and the scalars `red_size`,
+ *                `green_size`, and `blue_size`. Ramp structures from
+ *                libgamma or libcoopgamma can be used. Each ramp should
+ *                be either non-decreasing or non-increasing.
+ * @param  smax   The maximum value on each stop in the ramps in `sclut`
+ * @param  stype  The data type used for each stop in the ramps in `sclut`
+ *                (Not actually used)
+ */
+#define libclut_invert_mapping(dclut, dmax, dtype, sclut, smax, stype)\
+	do {\
+		libclut_invert_mapping__(dclut, dmax, dtype, sclut, smax, stype, red);\
+		libclut_invert_mapping__(dclut, dmax, dtype, sclut, smax, stype, green);\
+		libclut_invert_mapping__(dclut, dmax, dtype, sclut, smax, stype, blue);\
+	} while (0)
+
+/**
+ * Calculate the inverse of a monotone gamma ramp
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * This is intended for internal use
+ * 
+ * @param  dclut    Pointer to the output gamma ramps
+ * @param  dmax     The maximum value on each stop in the ramps in `dclut`
+ * @param  dtype    The data type used for each stop in the ramps in `dclut`
+ * @param  sclut    Pointer to the gamma ramps to invert
+ * @param  smax     The maximum value on each stop in the ramps in `sclut`
+ * @param  stype    The data type used for each stop in the ramps in `sclut`
+ *                  (Not actually used)
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ */
+#define libclut_invert_mapping__(dclut, dmax, dtype, sclut, smax, stype, channel)\
+	do {\
+		size_t di__, k__ = 0;\
+		size_t dn__ = (dclut)->channel##_size;\
+		size_t sn__ = (sclut)->channel##_size;\
+		double dm__ = (double)(dmax), sm__ = (double)(smax);\
+		const double h__ = (double)5 / 10;\
+		double x__, y__, a__, b__;\
+		int dec__ = sn__ > 1 && (sclut)->channel[sn__ - 1] < (sclut)->channel[0];\
+		for (di__ = 0; di__ < dn__ && sn__; di__++) {\
+			y__ = dn__ > 1 ? (double)di__ / (double)(dn__ - 1) * sm__ : 0;\
+			while (k__ + 1 < sn__ && (double)((sclut)->channel[dec__ ? sn__ - 2 - k__ : k__ + 1]) < y__)\
+				k__++;\
+			a__ = (double)((sclut)->channel[dec__ ? sn__ - 1 - k__ : k__]);\
+			if (k__ + 1 >= sn__) {\
+				x__ = sn__ > 1 ? 1 : 0;\
+			} else if (a__ >= y__) {\
+				x__ = 0;\
+			} else {\
+				b__ = (double)((sclut)->channel[dec__ ? sn__ - 2 - k__ : k__ + 1]);\
+				x__ = ((double)k__ + (y__ - a__) / (b__ - a__)) / (double)(sn__ - 1);\
+			}\
+			x__ = (dec__ ? 1 - x__ : x__) * dm__;\
+			(dclut)->channel[di__] = (dtype)((dtype)0.5 > 0 ? x__ : x__ + h__);\
+		}\
+	} while (0)
+
+/**
+ * Applies a filter or calibration
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  clut    Pointer to the gamma ramps, must have the arrays
+ *                 `red`, `green`, and `blue`, and the scalars
+ *                 `red_size`, `green_size`, and `blue_size`. Ramp
+ *                 structures from libgamma or libcoopgamma can be used.
+ * @param  max     The maximum value on each stop in the ramps
+ * @param  type    The data type used for each stop in the ramps
+ * @param  filter  Same as `clut`, but for the filter to apply
+ * @param  fmax    Same as `max`, but for the filter to apply
+ * @param  ftype   Same as `type`, but for the filter to apply (Not actually used)
+ * @param  r       Whether to apply the filter for the red curve
+ * @param  g       Whether to apply the filter for the green curve
+ * @param  b       Whether to apply the filter for the blue curve
+ */
+#define libclut_apply(clut, max, type, filter, fmax, ftype, r, g, b)\
+	do {\
+		if (r) libclut_apply__(clut, max, type, filter, fmax, ftype, red);\
+		if (g) libclut_apply__(clut, max, type, filter, fmax, ftype, green);\
+		if (b) libclut_apply__(clut, max, type, filter, fmax, ftype, blue);\
+	} while (0)
+
+/**
+ * Applies a filter or calibration for one channel
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Intended for internal use
+ * 
+ * @param  clut     Pointer to the gamma ramps, must have the arrays
+ *                  `red`, `green`, and `blue`, and the scalars
+ *                  `red_size`, `green_size`, and `blue_size`. Ramp
+ *                  structures from libgamma or libcoopgamma can be used.
+ * @param  max      The maximum value on each stop in the ramps
+ * @param  type     The data type used for each stop in the ramps
+ * @param  filter   Same as `clut`, but for the filter to apply
+ * @param  fmax     Same as `max`, but for the filter to apply
+ * @param  ftype    Same as `type`, but for the filter to apply (Not actually used)
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ */
+#define libclut_apply__(clut, max, type, filter, fmax, ftype, channel)\
+	do {\
+		size_t i__, rn__ = (clut)->channel##_size, fn__ = (filter)->channel##_size - 1;\
+		double x__, rm__ = (double)(max), m__ = (double)(max) / (double)(fmax);\
+		for (i__ = 0; i__ < rn__; i__++) {\
+			x__ = (double)((clut)->channel[i__]) / rm__ * (double)fn__;\
+			(clut)->channel[i__] = (type)((double)((filter)->channel[(size_t)x__]) * m__);\
+		}\
+	} while (0)
+
+/**
+ * Applies a filter or calibration, using CIE xyY
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  clut    Pointer to the gamma ramps, must have the arrays
+ *                 `red`, `green`, and `blue`, and the scalars
+ *                 `red_size`, `green_size`, and `blue_size`. Ramp
+ *                 structures from libgamma or libcoopgamma can be used.
+ * @param  max     The maximum value on each stop in the ramps
+ * @param  type    The data type used for each stop in the ramps
+ * @param  filter  Same as `clut`, but for the filter to apply
+ * @param  fmax    Same as `max`, but for the filter to apply
+ * @param  ftype   Same as `type`, but for the filter to apply (Not actually used)
+ * @param  r       Whether to apply the filter for the red curve
+ * @param  g       Whether to apply the filter for the green curve
+ * @param  b       Whether to apply the filter for the blue curve
+ */
+#define libclut_cie_apply(clut, max, type, filter, fmax, ftype, r, g, b)\
+	do {\
+		size_t rfn__ = (filter)->red_size - 1, gfn__ = (filter)->green_size - 1;\
+		size_t bfn__ = (filter)->blue_size - 1, x__;\
+		size_t rm__ = (double)(max), fm__ = (double)(fmax);\
+		libclut_cie__(clut, max, type, 0, r, g, b,\
+		              (x__ = (size_t)(Y__ / rm__ * rfn__), (double)((filter)->red[x__])   / fm__),\
+		              (x__ = (size_t)(Y__ / rm__ * gfn__), (double)((filter)->green[x__]) / fm__),\
+		              (x__ = (size_t)(Y__ / rm__ * bfn__), (double)((filter)->blue[x__])  / fm__));\
+	} while (0)
+
+/**
+ * Get the `libclut_element_type_t` for a data type
+ * 
+ * This is a constant expression
+ * 
+ * @param   type  The data type, must be `uint8_t`, `uint16_t`,
+ *                `uint32_t`, `uint64_t`, `float`, or `double`
+ * @return        The `libclut_element_type_t` value for `type`
+ */
+#define LIBCLUT_ELEMENT_TYPE(type)\
+	((type)0.5 > 0 ? (sizeof(type) == sizeof(float) ? LIBCLUT_ELEMENT_FLOAT : LIBCLUT_ELEMENT_DOUBLE) :\
+	 sizeof(type) == 1 ? LIBCLUT_ELEMENT_UINT8 :\
+	 sizeof(type) == 2 ? LIBCLUT_ELEMENT_UINT16 :\
+	 sizeof(type) == 4 ? LIBCLUT_ELEMENT_UINT32 : LIBCLUT_ELEMENT_UINT64)
+
+/**
+ * Save gamma ramps to a binary ramp file, which
+ * can be loaded with `libclut_map_ramps`
+ * 
+ * The file is written in the native byte order and
+ * can only be loaded on machines with the same byte
+ * order. See `libclut_save_ramps_file` for details.
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param   fd    File descriptor for the file to write, at
+ *                its beginning, must not be nonblocking
+ * @param   clut  Pointer to the gamma ramps, must have the arrays
+ *                `red`, `green`, and `blue`, and the scalars
+ *                `red_size`, `green_size`, and `blue_size`. Ramp
+ *                structures from libgamma or libcoopgamma can be used.
+ * @param   max   The maximum value on each stop in the ramps
+ * @param   type  The data type used for each stop in the ramps, must
+ *                be `uint8_t`, `uint16_t`, `uint32_t`, `uint64_t`,
+ *                `float`, or `double`
+ * @param   cs    The colour space the ramps are calibrated for,
+ *                `NULL` if unspecified
+ * @return        Zero on success, -1 on error
+ * 
+ * @throws  Any error specified for write(3)
+ */
+#define libclut_save_ramps(fd, clut, max, type, cs)\
+	libclut_save_ramps_file(fd, LIBCLUT_ELEMENT_TYPE(type), (double)(max),\
+	                        (clut)->red_size, (clut)->red, (clut)->green_size, (clut)->green,\
+	                        (clut)->blue_size, (clut)->blue, cs)
+
+/**
+ * Map gamma ramps from a binary ramp file, created with
+ * `libclut_save_ramps`, into memory, and set a ramp
+ * structure to point directly into the mapping, so the
+ * ramps are not copied
+ * 
+ * The mapping is private, so the ramps can be modified
+ * without modifying the file, and is shared with other
+ * processes that map the same file until it is modified.
+ * The ramps must not be used after `libclut_unmap_ramps`
+ * has been called for `mapping`
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param   fd       File descriptor for the file to read
+ * @param   clut     Pointer to the gamma ramps, must have the arrays
+ *                   `red`, `green`, and `blue`, and the scalars
+ *                   `red_size`, `green_size`, and `blue_size`. Ramp
+ *                   structures from libgamma or libcoopgamma can be used.
+ *                   The arrays are set to point into the mapping.
+ * @param   type     The data type used for each stop in the ramps, must
+ *                   be `uint8_t`, `uint16_t`, `uint32_t`, `uint64_t`,
+ *                   `float`, or `double`
+ * @param   mapping  Pointer to a `libclut_mapped_ramps_t` that is set to
+ *                   describe the mapping, including the maximum value
+ *                   on each stop and the colour space, if specified
+ * @return           Zero on success, -1 on error
+ * 
+ * @throws  EINVAL   See `libclut_map_ramps_file`
+ * @throws  ENOTSUP  See `libclut_map_ramps_file`
+ * @throws           Any error specified for fstat(3) or mmap(3)
+ */
+#define libclut_map_ramps(fd, clut, type, mapping)\
+	(libclut_map_ramps_file(fd, LIBCLUT_ELEMENT_TYPE(type), mapping) ? -1 :\
+	 ((clut)->red_size   = (mapping)->red_size,   (clut)->red   = (mapping)->red,\
+	  (clut)->green_size = (mapping)->green_size, (clut)->green = (mapping)->green,\
+	  (clut)->blue_size  = (mapping)->blue_size,  (clut)->blue  = (mapping)->blue, 0))
+
+/**
+ * Save gamma ramps to a binary ramp file
+ * 
+ * The file starts with a header in the native byte order,
+ * containing, in order: the magic "LIBCLUT\x1A", a 32-bit
+ * format version (2), the 32-bit value 0x01020304 that is
+ * used to detect the byte order, the 32-bit element type, a
+ * 32-bit element size, the 64-bit sizes of the red, green, and
+ * blue ramps, the 64-bit offsets of the red, green, and blue
+ * ramps, the maximum value on each stop as a `double`, a
+ * 32-bit value that is 1 if the header specifies a colour
+ * space and 0 otherwise, the colour space's 32-bit transfer
+ * function type, the colour space as twelve `double`s in the
+ * order of the members of `libclut_rgb_colour_space_t`, and
+ * the gamma of the transfer function as a `double`. The header
+ * is followed by the ramps, each beginning at a multiple of
+ * 64 bytes. Version 1 of the format did not have the transfer
+ * function, which was always sRGB, and those fields were zero.
+ * 
+ * @param   fd          File descriptor for the file to write, at
+ *                      its beginning, must not be nonblocking
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         The red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       The green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        The blue ramp
+ * @param   cs          The colour space the ramps are calibrated for,
+ *                      `NULL` if unspecified
+ * @return              Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `type` is invalid
+ * @throws          Any error specified for write(3)
+ */
+int libclut_save_ramps_file(int, libclut_element_type_t, double, size_t, const void *, size_t, const void *,
+                            size_t, const void *, const libclut_rgb_colour_space_t *);
+
+/**
+ * Map gamma ramps from a binary ramp file into memory,
+ * see `libclut_save_ramps_file` for the file format
+ * 
+ * @param   fd       File descriptor for the file to read
+ * @param   type     The data type the ramps must have, 0 for any
+ * @param   mapping  Output parameter for the mapping
+ * @return           Zero on success, -1 on error
+ * 
+ * @throws  EINVAL   The file is not a valid binary ramp file,
+ *                   or its ramps are not of the type `type`
+ * @throws  ENOTSUP  The file was created on a machine with another
+ *                   byte order, or with a newer version of the file
+ *                   format, or memory mapping is not supported on
+ *                   this platform
+ * @throws           Any error specified for fstat(3) or mmap(3)
+ */
+int libclut_map_ramps_file(int, libclut_element_type_t, libclut_mapped_ramps_t *);
+
+/**
+ * Unmap gamma ramps mapped with `libclut_map_ramps`
+ * or `libclut_map_ramps_file`
+ * 
+ * @param  mapping  The mapping
+ */
+void libclut_unmap_ramps(libclut_mapped_ramps_t *);
+
+/**
+ * Set gamma ramps from the `vcgt` tag of an ICC profile
+ * 
+ * A `vcgt` table is resampled to the size of the ramps, with
+ * linear interpolation as done by `libclut_translate`, directly
+ * from the profile without copying the table, and a `vcgt`
+ * formula is evaluated for each stop. The ramps are not
+ * modified if the profile does not have a `vcgt` tag.
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut' and '-lm'
+ * 
+ * @param  icc   Pointer to the parsed profile, a `libclut_icc_t`
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ */
+#define libclut_icc_vcgt_ramps(icc, clut, max, type)\
+	do {\
+		const libclut_icc_curve_t *c__ = (icc)->vcgt;\
+		if (c__[0].kind == LIBCLUT_ICC_CURVE_TABLE) {\
+			libclut_icc_table__(clut, red,   max, type, &c__[0]);\
+			libclut_icc_table__(clut, green, max, type, &c__[1]);\
+			libclut_icc_table__(clut, blue,  max, type, &c__[2]);\
+		} else if (c__[0].kind != LIBCLUT_ICC_CURVE_NONE) {\
+			libclut_icc_curve__(clut, red,   max, type, &c__[0]);\
+			libclut_icc_curve__(clut, green, max, type, &c__[1]);\
+			libclut_icc_curve__(clut, blue,  max, type, &c__[2]);\
+		}\
+	} while (0)
+
+/**
+ * Set gamma ramps to the tone reproduction curves of
+ * an ICC profile, which map encoded values to linear
+ * values; for example, use `libclut_icc_trc_ramps`
+ * followed by `libclut_standardise` to get ramps that
+ * compensate for the display's response curves
+ * 
+ * The curves are evaluated for each stop. The ramps for
+ * channels whose curve is missing are not modified.
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param  icc   Pointer to the parsed profile, a `libclut_icc_t`
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ * @param  max   The maximum value on each stop in the ramps
+ * @param  type  The data type used for each stop in the ramps
+ */
+#define libclut_icc_trc_ramps(icc, clut, max, type)\
+	do {\
+		libclut_icc_curve__(clut, red,   max, type, &(icc)->trc[0]);\
+		libclut_icc_curve__(clut, green, max, type, &(icc)->trc[1]);\
+		libclut_icc_curve__(clut, blue,  max, type, &(icc)->trc[2]);\
+	} while (0)
+
+/**
+ * Set a ramp to a curve from an ICC profile
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Intended for internal use
+ * 
+ * @param  clut     Pointer to the gamma ramps
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ * @param  max      The maximum value on each stop in the ramps
+ * @param  type     The data type used for each stop in the ramps
+ * @param  curve    Pointer to the `libclut_icc_curve_t`
+ */
+#define libclut_icc_curve__(clut, channel, max, type, curve)\
+	do {\
+		size_t i__, n__ = (clut)->channel##_size;\
+		double d__ = (double)(n__ - 1), max__ = (double)(max);\
+		if ((curve)->kind != LIBCLUT_ICC_CURVE_NONE)\
+			for (i__ = 0; i__ < n__; i__++)\
+				(clut)->channel[i__] = (type)(max__ * libclut_icc_curve(curve, (double)i__ / d__));\
+	} while (0)
+
+/**
+ * Resample the table of an ICC curve to a ramp, with linear
+ * interpolation, as done by `libclut_translate`
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Intended for internal use
+ * 
+ * @param  clut     Pointer to the gamma ramps
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ * @param  max      The maximum value on each stop in the ramps
+ * @param  type     The data type used for each stop in the ramps
+ * @param  curve    Pointer to the `libclut_icc_curve_t`, must
+ *                  be a `LIBCLUT_ICC_CURVE_TABLE`
+ */
+#define libclut_icc_table__(clut, channel, max, type, curve)\
+	do {\
+		size_t i__, si__, sj__, n__ = (clut)->channel##_size, sn__ = (curve)->size;\
+		double m__ = (double)(max) / ((curve)->entry_size == 1 ? UINT8_MAX : UINT16_MAX), x__, y__;\
+		for (i__ = 0; i__ < n__; i__++) {\
+			if (n__ == sn__) {\
+				y__ = libclut_icc_table_entry__(curve, i__);\
+			} else {\
+				x__ = n__ > 1 ? (double)i__ / (double)(n__ - 1) * (double)(sn__ - 1) : 0;\
+				si__ = (size_t)(x__);\
+				sj__ = si__ + (si__ + 1 < sn__);\
+				x__ -= (double)si__;\
+				y__  = libclut_icc_table_entry__(curve, si__) * (1 - x__);\
+				y__ += libclut_icc_table_entry__(curve, sj__) * (x__);\
+			}\
+			(clut)->channel[i__] = (type)(y__ * m__);\
+		}\
+	} while (0)
+
+/**
+ * Get an entry in the table of an ICC curve
+ * 
+ * Intended for internal use
  * 
- * None of the parameter may have side-effects
+ * @param   curve  The curve, must be a `LIBCLUT_ICC_CURVE_TABLE`
+ * @param   i      The index of the entry
+ * @return         The value of the entry
+ */
+static inline double
+libclut_icc_table_entry__(const libclut_icc_curve_t *curve, size_t i)
+{
+	const unsigned char *p = curve->table + i * curve->entry_size;
+	return curve->entry_size == 1 ? (double)p[0] : (double)((unsigned)p[0] << 8 | (unsigned)p[1]);
+}
+
+/**
+ * Parse the parts of an ICC profile that map onto gamma ramps
+ * and RGB colour spaces: the `vcgt`, `rXYZ`, `gXYZ`, `bXYZ`,
+ * `wtpt`, `chad`, `rTRC`, `gTRC`, and `bTRC` tags
  * 
- * Requires linking with '-lclut', or '-lm' if
- * `libclut_model_linear_to_standard1` is not undefined
+ * Nothing is allocated, the curves in `icc` point into `data`,
+ * and other tags are ignored. Tags with unsupported types are
+ * treated as missing.
+ * 
+ * @param   data  The ICC profile
+ * @param   size  The size of `data`, in bytes
+ * @param   icc   Output parameter for the parsed profile
+ * @return        Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `data` is not a valid ICC profile
+ */
+int libclut_icc_parse(const void *, size_t, libclut_icc_t *);
+
+/**
+ * Evaluate a curve from an ICC profile
+ * 
+ * Tables are interpolated linearly
+ * 
+ * @param   curve  The curve, must not be `LIBCLUT_ICC_CURVE_NONE`
+ * @param   x      The input value, in [0, 1]
+ * @return         The output value, normally in [0, 1]
+ */
+double libclut_icc_curve(const libclut_icc_curve_t *, double);
+
+/**
+ * Set gamma ramps from the 1D lookup table of a .cube file
+ * 
+ * Each stop `i` in the ramps is mapped to the input value `i / (size - 1)`,
+ * which is mapped through the input domain of the file to a position in
+ * the lookup table, which is interpolated linearly. Input values outside
+ * the domain are clipped to it, and so are output values outside [0, 1].
+ * The ramps are not modified if the file does not have a 1D lookup table.
+ * 
+ * None of the parameter may have side-effects
  * 
+ * @param  cube  Pointer to the parsed file, a `libclut_cube_t`
  * @param  clut  Pointer to the gamma ramps, must have the arrays
  *               `red`, `green`, and `blue`, and the scalars
  *               `red_size`, `green_size`, and `blue_size`. Ramp
  *               structures from libgamma or libcoopgamma can be used.
  * @param  max   The maximum value on each stop in the ramps
  * @param  type  The data type used for each stop in the ramps
- * @param  r     Whether to convert the red colour curve
- * @param  g     Whether to convert the green colour curve
- * @param  b     Whether to convert the blue colour curve
  */
-#define libclut_standardise(clut, max, type, r, g, b)\
+#define libclut_cube_ramps(cube, clut, max, type)\
 	do {\
-		double m__ = (double)(max);\
-		if (r) libclut__(clut, red,   type, m__ * libclut_model_linear_to_standard1(LIBCLUT_VALUE / m__));\
-		if (g) libclut__(clut, green, type, m__ * libclut_model_linear_to_standard1(LIBCLUT_VALUE / m__));\
-		if (b) libclut__(clut, blue,  type, m__ * libclut_model_linear_to_standard1(LIBCLUT_VALUE / m__));\
+		if ((cube)->red_size) {\
+			libclut_cube_ramp__(cube, clut, max, type, red,   0);\
+			libclut_cube_ramp__(cube, clut, max, type, green, 1);\
+			libclut_cube_ramp__(cube, clut, max, type, blue,  2);\
+		}\
 	} while (0)
 
 /**
- * Convert the curves between two RGB colour spaces
- * 
- * Both RGB colour spaces must have same gamma functions as sRGB
- * 
- * Requires that `clut->red_size`, `clut->green_size`
- * and `clut->blue_size` are equal
+ * Set one ramp from the 1D lookup table of a .cube file
  * 
  * None of the parameter may have side-effects
  * 
- * Requires linking with '-lclut', or '-lm' if
- * `libclut_model_linear_to_standard1`,
- * `libclut_model_standard_to_linear1`, or
- * `libclut_model_convert_rgb` is not undefined
+ * Intended for internal use
  * 
- * @param  clut   Pointer to the gamma ramps, must have the arrays
- *                `red`, `green`, and `blue`, and the scalars
- *                `red_size`, `green_size`, and `blue_size`. Ramp
- *                structures from libgamma or libcoopgamma can be used.
- * @param  max    The maximum value on each stop in the ramps
- * @param  type   The data type used for each stop in the ramps
- * @param  m      Conversion matrix. Can be created with
- *                `libclut_model_get_rgb_conversion_matrix`
- * @param  trunc  Truncate values that are out of gamut
+ * @param  cube     Pointer to the parsed file, a `libclut_cube_t`
+ * @param  clut     Pointer to the gamma ramps
+ * @param  max      The maximum value on each stop in the ramps
+ * @param  type     The data type used for each stop in the ramps
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ * @param  index    The index of the channel in the domain, 0, 1, or 2
  */
-#define libclut_convert_rgb_inplace(clut, max, type, m, trunc)\
+#define libclut_cube_ramp__(cube, clut, max, type, channel, index)\
 	do {\
-		double m__ = (double)(max), r__, g__, b__;\
-		size_t i__, n__ = (clut)->red_size;\
+		size_t i__, j__, n__ = (clut)->channel##_size, m__ = (cube)->channel##_size - 1;\
+		double lo__ = (cube)->domain_min[index], max__ = (double)(max), x__, y__;\
+		double s__ = (double)m__ / ((cube)->domain_max[index] - lo__), d__ = (double)(n__ - 1);\
 		for (i__ = 0; i__ < n__; i__++) {\
-			r__ = (clut)->red[i__] / m__;\
-			g__ = (clut)->green[i__] / m__;\
-			b__ = (clut)->blue[i__] / m__;\
-			libclut_model_convert_rgb(r__, g__, b__, m, &r__, &g__, &b__);\
-			r__ *= m__;\
-			g__ *= m__;\
-			b__ *= m__;\
-			if (trunc) {\
-				if (r__ < 0)\
-					r__ = 0;\
-				else if (r__ > m__)\
-					r__ = m__;\
-				if (g__ < 0)\
-					g__ = 0;\
-				else if (g__ > m__)\
-					g__ = m__;\
-				if (b__ < 0)\
-					b__ = 0;\
-				else if (b__ > m__)\
-					b__ = m__;\
-			}\
-			(clut)->red[i__] = (type)r__;\
-			(clut)->green[i__] = (type)g__;\
-			(clut)->blue[i__] = (type)b__;\
+			x__ = ((n__ > 1 ? (double)i__ / d__ : 0) - lo__) * s__;\
+			x__ = x__ < 0 ? 0 : x__ > (double)m__ ? (double)m__ : x__;\
+			j__ = (size_t)x__;\
+			j__ -= j__ == m__;\
+			x__ -= (double)j__;\
+			y__ = (cube)->channel[j__] * (1 - x__) + (cube)->channel[j__ + 1] * x__;\
+			(clut)->channel[i__] = (type)((y__ < 0 ? 0 : y__ > 1 ? 1 : y__) * max__);\
 		}\
 	} while (0)
 
 /**
- * Convert the curves between two RGB colour spaces
- * 
- * Both RGB colour spaces must have same gamma functions as sRGB
+ * Set a 3D colour lookup table from the 3D lookup table of
+ * a .cube file, the input domain of the file is ignored
  * 
  * None of the parameter may have side-effects
  * 
- * Requires linking with '-lclut' if
- * `libclut_model_linear_to_standard1`,
- * `libclut_model_standard_to_linear1`, or
- * `libclut_model_convert_rgb` is not undefined.
- * Always requires linking with '-lm'.
- * 
- * @param  clut   Pointer to the input gamma ramps, must have the
- *                arrays `red`, `green`, and `blue`, and the scalars
- *                `red_size`, `green_size`, and `blue_size`. Ramp
- *                structures from libgamma or libcoopgamma can be used.
- * @param  max    The maximum value on each stop in the ramps
- * @param  type   The data type used for each stop in the ramps
- * @param  m      Conversion matrix. Can be created with
- *                `libclut_model_get_rgb_conversion_matrix`
+ * @param  cube   Pointer to the parsed file, a `libclut_cube_t`
+ * @param  lut    Pointer to the 3D lookup table, must have the array
+ *                `data` and the scalar `size`, see `libclut_3d_index`;
+ *                `size` must be equal to `cube->size`
+ * @param  max    The maximum value on each element in the lookup table
+ * @param  type   The data type used for each element in the lookup table
  * @param  trunc  Truncate values that are out of gamut
- * @param  out    Pointer to the output gamma ramps, must have the
- *                arrays `red`, `green`, and `blue`, and the scalars
- *                `red_size`, `green_size`, and `blue_size`. Ramp
- *                structures from libgamma or libcoopgamma can be used.
  */
-#define libclut_convert_rgb(clut, max, type, m, trunc, out)\
+#define libclut_cube_3d(cube, lut, max, type, trunc)\
 	do {\
-		double m__ = (double)(max), r__, g__, b__, x__, y__;\
-		size_t rn__ = (clut)->red_size;\
-		size_t gn__ = (clut)->green_size;\
-		size_t bn__ = (clut)->blue_size;\
-		double w__;\
-		size_t i__, j__, jj__;\
-		for (i__ = 0; i__ < rn__; i__++) {\
-			w__ = (double)i__ * (double)gn__ / (double)rn__;\
-			j__ = (size_t)w__;\
-			jj__ = j__ == gn__ ? j__ : (j__ + 1);\
-			w__ -= (double)j__;\
-			x__ = (clut)->green[j__] / m__;\
-			y__ = (clut)->green[jj__] / m__;\
-			x__ = libclut_model_standard_to_linear1(x__);\
-			y__ = libclut_model_standard_to_linear1(y__);\
-			g__ = x__ * (1 - w__) + y__ * w__;\
-			\
-			w__ = (double)i__ * (double)bn__ / (double)rn__;\
-			j__ = (size_t)w__;\
-			jj__ = j__ == bn__ ? j__ : (j__ + 1);\
-			w__ -= (double)j__;\
-			x__ = (clut)->blue[j__] / m__;\
-			y__ = (clut)->blue[jj__] / m__;\
-			x__ = libclut_model_standard_to_linear1(x__);\
-			y__ = libclut_model_standard_to_linear1(y__);\
-			b__ = x__ * (1 - w__) + y__ * w__;\
-			\
-			r__ = (clut)->red[i__] / m__;\
-			r__ = (M)[0][0] * r__ + (M)[0][1] * g__ + (M)[0][2] * b__;\
-			r__ = libclut_model_linear_to_standard1(r__);\
-			r__ *= m__;\
-			if (trunc) {\
-				if (r__ < 0)\
-					r__ = 0;\
-				else if (r__ > m__)\
-					r__ = m__;\
-			}\
-			(out)->red[i__] = (type)r__;\
-		}\
-		for (i__ = 0; i__ < gn__; i__++) {\
-			w__ = (double)i__ * (double)rn__ / (double)gn__;\
-			j__ = (size_t)w__;\
-			jj__ = j__ == rn__ ? j__ : (j__ + 1);\
-			w__ -= (double)j__;\
-			x__ = (clut)->red[j__] / m__;\
-			y__ = (clut)->red[jj__] / m__;\
-			x__ = libclut_model_standard_to_linear1(x__);\
-			y__ = libclut_model_standard_to_linear1(y__);\
-			r__ = x__ * (1 - w__) + y__ * w__;\
-			\
-			w__ = (double)i__ * (double)bn__ / (double)gn__;\
-			j__ = (size_t)w__;\
-			jj__ = j__ == bn__ ? j__ : (j__ + 1);\
-			w__ -= (double)j__;\
-			x__ = (clut)->blue[j__] / m__;\
-			y__ = (clut)->blue[jj__] / m__;\
-			x__ = libclut_model_standard_to_linear1(x__);\
-			y__ = libclut_model_standard_to_linear1(y__);\
-			b__ = x__ * (1 - w__) + y__ * w__;\
-			\
-			g__ = (clut)->green[i__] / m__;\
-			g__ = (M)[1][0] * r__ + (M)[1][1] * g__ + (M)[1][2] * b__;\
-			g__ = libclut_model_linear_to_standard1(g__);\
-			g__ *= m__;\
-			if (trunc) {\
-				if (g__ < 0)\
-					g__ = 0;\
-				else if (g__ > m__)\
-					g__ = m__;\
-			}\
-			(out)->green[i__] = (type)g__;\
-		}\
-		for (i__ = 0; i__ < bn__; i__++) {\
-			w__ = (double)i__ * (double)rn__ / (double)bn__;\
-			j__ = (size_t)w__;\
-			jj__ = j__ == rn__ ? j__ : (j__ + 1);\
-			w__ -= (double)j__;\
-			x__ = (clut)->red[j__] / m__;\
-			y__ = (clut)->red[jj__] / m__;\
-			x__ = libclut_model_standard_to_linear1(x__);\
-			y__ = libclut_model_standard_to_linear1(y__);\
-			r__ = x__ * (1 - w__) + y__ * w__;\
-			\
-			w__ = (double)i__ * (double)gn__ / (double)bn__;\
-			j__ = (size_t)w__;\
-			jj__ = j__ == gn__ ? j__ : (j__ + 1);\
-			w__ -= (double)j__;\
-			x__ = (clut)->green[j__] / m__;\
-			y__ = (clut)->green[jj__] / m__;\
-			x__ = libclut_model_standard_to_linear1(x__);\
-			y__ = libclut_model_standard_to_linear1(y__);\
-			g__ = x__ * (1 - w__) + y__ * w__;\
-			\
-			b__ = (clut)->blue[i__] / m__;\
-			b__ = (M)[2][0] * r__ + (M)[2][1] * g__ + (M)[2][2] * b__;\
-			b__ = libclut_model_linear_to_standard1(b__);\
-			b__ *= m__;\
-			if (trunc) {\
-				if (b__ < 0)\
-					b__ = 0;\
-				else if (b__ > m__)\
-					b__ = m__;\
-			}\
-			(out)->blue[i__] = (type)b__;\
-		}\
+		size_t i__, n__ = 3 * (cube)->size * (cube)->size * (cube)->size;\
+		double m__ = (double)(max);\
+		for (i__ = 0; i__ < n__; i__++)\
+			libclut_3d_store__((lut)->data[i__], (cube)->data[i__] * m__, m__, type, trunc);\
 	} while (0)
 
 /**
- * Apply gamma correction on the colour curves
+ * Save gamma ramps as the 1D lookup table of a .cube file,
+ * which can be loaded with `libclut_cube_load`
  * 
  * None of the parameter may have side-effects
  * 
- * Requires linking with '-lm'
+ * Requires linking with '-lclut'
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     The gamma parameter the red colour curve
- * @param  g     The gamma parameter the green colour curve
- * @param  b     The gamma parameter the blue colour curve
+ * @param   fd     File descriptor for the file to write,
+ *                 must not be nonblocking
+ * @param   clut   Pointer to the gamma ramps, must have the arrays
+ *                 `red`, `green`, and `blue`, and the scalars
+ *                 `red_size`, `green_size`, and `blue_size`. Ramp
+ *                 structures from libgamma or libcoopgamma can be used.
+ *                 All ramps must have the same size, at least 2.
+ * @param   max    The maximum value on each stop in the ramps
+ * @param   type   The data type used for each stop in the ramps, must
+ *                 be `uint8_t`, `uint16_t`, `uint32_t`, `uint64_t`,
+ *                 `float`, or `double`
+ * @param   title  The title of the lookup table, `NULL` if none
+ * @return         Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  See `libclut_cube_save_ramps_file`
+ * @throws          Any error specified for write(3)
  */
-#define libclut_gamma(clut, max, type, r, g, b)\
-	do {\
-		double m__ = (double)(max);\
-		if (!libclut_1__(r)) libclut__(clut, red,   type, m__ * pow(LIBCLUT_VALUE / m__, 1 / (double)(r)));\
-		if (!libclut_1__(g)) libclut__(clut, green, type, m__ * pow(LIBCLUT_VALUE / m__, 1 / (double)(g)));\
-		if (!libclut_1__(b)) libclut__(clut, blue,  type, m__ * pow(LIBCLUT_VALUE / m__, 1 / (double)(b)));\
-	} while (0)
+#define libclut_cube_save_ramps(fd, clut, max, type, title)\
+	libclut_cube_save_ramps_file(fd, LIBCLUT_ELEMENT_TYPE(type), (double)(max),\
+	                             (clut)->red_size, (clut)->red, (clut)->green_size, (clut)->green,\
+	                             (clut)->blue_size, (clut)->blue, title)
+
+/**
+ * Save a 3D colour lookup table as the 3D lookup table
+ * of a .cube file, which can be loaded with `libclut_cube_load`
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires linking with '-lclut'
+ * 
+ * @param   fd     File descriptor for the file to write,
+ *                 must not be nonblocking
+ * @param   lut    Pointer to the 3D lookup table, must have the array
+ *                 `data` and the scalar `size`, see `libclut_3d_index`
+ * @param   max    The maximum value on each element in the lookup table
+ * @param   type   The data type used for each element in the lookup table,
+ *                 must be `uint8_t`, `uint16_t`, `uint32_t`, `uint64_t`,
+ *                 `float`, or `double`
+ * @param   title  The title of the lookup table, `NULL` if none
+ * @return         Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  See `libclut_cube_save_3d_file`
+ * @throws          Any error specified for write(3)
+ */
+#define libclut_cube_save_3d(fd, lut, max, type, title)\
+	libclut_cube_save_3d_file(fd, LIBCLUT_ELEMENT_TYPE(type), (double)(max), (lut)->size, (lut)->data, title)
+
+/**
+ * Save a 1D lookup table as a .cube file
+ * 
+ * The values are divided by `max` and written with six decimals,
+ * without using the current locale
+ * 
+ * @param   fd          File descriptor for the file to write,
+ *                      must not be nonblocking
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         The red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       The green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        The blue ramp
+ * @param   title       The title of the lookup table, `NULL` if none
+ * @return              Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `type` is invalid, the ramps do not have the same
+ *                  size, the size is less than 2 or greater than
+ *                  65536, or `title` contains a quotation mark or
+ *                  a line break
+ * @throws          Any error specified for write(3)
+ */
+int libclut_cube_save_ramps_file(int, libclut_element_type_t, double, size_t, const void *, size_t, const void *,
+                                 size_t, const void *, const char *);
+
+/**
+ * Save a 3D lookup table as a .cube file
+ * 
+ * The values are divided by `max` and written with six decimals,
+ * without using the current locale
+ * 
+ * @param   fd     File descriptor for the file to write,
+ *                 must not be nonblocking
+ * @param   type   The data type used for each element in the lookup table
+ * @param   max    The maximum value on each element in the lookup table
+ * @param   size   The number of lattice points along each axis
+ * @param   data   The lookup table, see `libclut_3d_index`
+ * @param   title  The title of the lookup table, `NULL` if none
+ * @return         Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `type` is invalid, `size` is less than 2 or
+ *                  greater than 256, or `title` contains
+ *                  a quotation mark or a line break
+ * @throws          Any error specified for write(3)
+ */
+int libclut_cube_save_3d_file(int, libclut_element_type_t, double, size_t, const void *, const char *);
+
+/**
+ * Initialise a .cube parser
+ * 
+ * @param  cube  The parser, and output parameter for the parsed file
+ */
+void libclut_cube_init(libclut_cube_t *);
+
+/**
+ * Feed the next part of a .cube file to the parser
+ * 
+ * The file can be split at any byte, and is not buffered, so
+ * only memory for the lookup tables is allocated. Numbers
+ * are parsed without using the current locale. A file may
+ * have both a 1D and a 3D lookup table, as used by Resolve,
+ * in which case the 1D lookup table comes first. Unknown
+ * keywords are ignored.
+ * 
+ * Once an error has occurred, the function will fail
+ * with the same error until the parser is reinitialised
+ * 
+ * @param   cube  The parser, initialised with `libclut_cube_init`
+ * @param   data  The next part of the file
+ * @param   n     The size of `data`, 0 at the end of the file
+ * @return        Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  The file is not a valid .cube file
+ * @throws  ENOMEM  Insufficient memory is available
+ */
+int libclut_cube_parse(libclut_cube_t *, const void *, size_t);
+
+/**
+ * Load a .cube file, the file is read and parsed piece by piece
+ * 
+ * @param   fd    File descriptor for the file to read
+ * @param   cube  Output parameter for the parsed file,
+ *                release with `libclut_cube_destroy`
+ * @return        Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  The file is not a valid .cube file
+ * @throws  ENOMEM  Insufficient memory is available
+ * @throws          Any error specified for read(3)
+ */
+int libclut_cube_load(int, libclut_cube_t *);
+
+/**
+ * Release the lookup tables of a .cube parser
+ * 
+ * @param  cube  The parser
+ */
+void libclut_cube_destroy(libclut_cube_t *);
 
 /**
- * Reverse the colour curves (negative image with gamma preservation)
+ * Calculate a 64-bit hash of gamma ramps
+ * 
+ * The hash covers the data type, the maximum value, the size
+ * of each ramp, and the contents of the ramps. It is not a
+ * cryptographic hash, but it is fast and has good dispersion.
  * 
  * None of the parameter may have side-effects
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps.
- *               This parameter is not used, it is just a dummy, to unify
- *               the API with the other functions
- * @param  type  The data type used for each stop in the ramps
- * @param  r     Whether to invert the red colour curve
- * @param  g     Whether to invert the green colour curve
- * @param  b     Whether to invert the blue colour curve
+ * Requires linking with '-lclut'
+ * 
+ * @param   clut  Pointer to the gamma ramps, must have the arrays
+ *                `red`, `green`, and `blue`, and the scalars
+ *                `red_size`, `green_size`, and `blue_size`. Ramp
+ *                structures from libgamma or libcoopgamma can be used.
+ * @param   max   The maximum value on each stop in the ramps
+ * @param   type  The data type used for each stop in the ramps, must
+ *                be `uint8_t`, `uint16_t`, `uint32_t`, `uint64_t`,
+ *                `float`, or `double`
+ * @return        The hash of the ramps
  */
-#define libclut_negative(clut, max, type, r, g, b)\
-	do {\
-		size_t i__, n__;\
-		type t__;\
-		if (r) {\
-			for (i__ = 0, n__ = (clut)->red_size; i__ < (n__ >> 1); i__++) {\
-				t__ = (clut)->red[i__];\
-				(clut)->red[i__] = (clut)->red[n__ - i__ - 1];\
-				(clut)->red[n__ - i__ - 1] = t__;\
-			}\
-		}\
-		if (g) {\
-			for (i__ = 0, n__ = (clut)->green_size; i__ < (n__ >> 1); i__++) {\
-				t__ = (clut)->green[i__];\
-				(clut)->green[i__] = (clut)->green[n__ - i__ - 1];\
-				(clut)->green[n__ - i__ - 1] = t__;\
-			}\
-		}\
-		if (b) {\
-			for (i__ = 0, n__ = (clut)->blue_size; i__ < (n__ >> 1); i__++)	{\
-				t__ = (clut)->blue[i__];\
-				(clut)->blue[i__] = (clut)->blue[n__ - i__ - 1];\
-				(clut)->blue[n__ - i__ - 1] = t__;\
-			}\
-		}\
-	} while (0)
+#define libclut_hash(clut, max, type)\
+	libclut_hash_ramps(LIBCLUT_ELEMENT_TYPE(type), (double)(max),\
+	                   (clut)->red_size, (clut)->red, (clut)->green_size, (clut)->green,\
+	                   (clut)->blue_size, (clut)->blue)
 
 /**
- * Invert the colour curves (negative image with gamma invertion), using sRGB
+ * Store a copy of computed gamma ramps in a cache, replacing
+ * the least recently used ramps if the cache is full
  * 
  * None of the parameter may have side-effects
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     Whether to invert the red colour curve
- * @param  g     Whether to invert the green colour curve
- * @param  b     Whether to invert the blue colour curve
+ * Requires linking with '-lclut'
+ * 
+ * @param   cache      The cache, a `libclut_cache_t *`
+ * @param   input      The hash of the input ramps, see `libclut_hash`
+ * @param   operation  The hash of the operations that were applied to
+ *                     the input ramps, see `libclut_hash_operation`
+ * @param   clut       Pointer to the computed gamma ramps, must have the
+ *                     arrays `red`, `green`, and `blue`, and the scalars
+ *                     `red_size`, `green_size`, and `blue_size`. Ramp
+ *                     structures from libgamma or libcoopgamma can be used.
+ * @param   max        The maximum value on each stop in the ramps
+ * @param   type       The data type used for each stop in the ramps, must
+ *                     be `uint8_t`, `uint16_t`, `uint32_t`, `uint64_t`,
+ *                     `float`, or `double`
+ * @return             Zero on success, -1 on error
+ * 
+ * @throws  ENOMEM  Insufficient memory is available
  */
-#define libclut_rgb_invert(clut, max, type, r, g, b)\
-	do {\
-		if (r) libclut__(clut, red,   type, (max) - LIBCLUT_VALUE);\
-		if (g) libclut__(clut, green, type, (max) - LIBCLUT_VALUE);\
-		if (b) libclut__(clut, blue,  type, (max) - LIBCLUT_VALUE);\
-	} while (0)
+#define libclut_cache_store(cache, input, operation, clut, max, type)\
+	libclut_cache_store_ramps(cache, input, operation, LIBCLUT_ELEMENT_TYPE(type), (double)(max),\
+	                          (clut)->red_size, (clut)->red, (clut)->green_size, (clut)->green,\
+	                          (clut)->blue_size, (clut)->blue)
 
 /**
- * Invert the colour curves (negative image with gamma invertion), using CIE xyY
+ * Copy gamma ramps from a cache, if the cache has ramps for
+ * the input and operations, with the same sizes, maximum
+ * value, and data type as `clut`
  * 
  * None of the parameter may have side-effects
  * 
  * Requires linking with '-lclut'
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     Whether to invert the red colour curve
- * @param  g     Whether to invert the green colour curve
- * @param  b     Whether to invert the blue colour curve
+ * @param   cache      The cache, a `libclut_cache_t *`
+ * @param   input      The hash of the input ramps, see `libclut_hash`
+ * @param   operation  The hash of the operations to apply to the
+ *                     input ramps, see `libclut_hash_operation`
+ * @param   clut       Pointer to the gamma ramps to fill in, must have the
+ *                     arrays `red`, `green`, and `blue`, and the scalars
+ *                     `red_size`, `green_size`, and `blue_size`. Ramp
+ *                     structures from libgamma or libcoopgamma can be used.
+ * @param   max        The maximum value on each stop in the ramps
+ * @param   type       The data type used for each stop in the ramps, must
+ *                     be `uint8_t`, `uint16_t`, `uint32_t`, `uint64_t`,
+ *                     `float`, or `double`
+ * @return             1 if the ramps were copied from the cache,
+ *                     0 if the cache does not have the ramps
  */
-#define libclut_cie_invert(clut, max, type, r, g, b)\
-	libclut_cie__(clut, max, type, (r) && (g) && (b), r, g, b, 1 - Y__, 1 - Y__, 1 - Y__)
+#define libclut_cache_fetch(cache, input, operation, clut, max, type)\
+	libclut_cache_fetch_ramps(cache, input, operation, LIBCLUT_ELEMENT_TYPE(type), (double)(max),\
+	                          (clut)->red_size, (clut)->red, (clut)->green_size, (clut)->green,\
+	                          (clut)->blue_size, (clut)->blue)
 
 /**
- * Apply S-curve correction on the colour curves.
- * This is intended for fine tuning LCD monitors,
- * 4.5 is good value start start testing at.
- * You would probably like to use rgb_limits before
- * this to adjust the blackpoint as that is the
- * only way to adjust the blackpoint on many LCD
- * monitors.
+ * Calculate a 64-bit hash of gamma ramps, see `libclut_hash`
+ * 
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         The red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       The green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        The blue ramp
+ * @return              The hash of the ramps, 0 if `type` is invalid
+ */
+uint64_t libclut_hash_ramps(libclut_element_type_t, double, size_t, const void *, size_t, const void *,
+                            size_t, const void *);
+
+/**
+ * Extend a 64-bit hash of a sequence of operations with
+ * another operation, for use with `libclut_cache_store`
+ * and `libclut_cache_fetch`
+ * 
+ * For example, to describe applying `libclut_gamma` with the
+ * parameters 1.1, 1.2, and 1.3, followed by `libclut_clip`:
+ * 
+ *     double params[] = {1.1, 1.2, 1.3};
+ *     uint64_t h = libclut_hash_operation(0, "gamma", 3, params);
+ *     h = libclut_hash_operation(h, "clip", 0, NULL);
+ * 
+ * The parameters are canonicalised, so that negative and
+ * positive zero hash identically, and so do all NaN values.
+ * 
+ * @param   hash    The hash of the previous operations, 0 if none
+ * @param   name    The name of the operation, should be unique for
+ *                  each function or manipulation that can be described
+ * @param   n       The number of parameters of the operation
+ * @param   params  The parameters of the operation
+ * @return          The hash of the operations
+ */
+uint64_t libclut_hash_operation(uint64_t, const char *, size_t, const double *);
+
+/**
+ * Initialise a gamma ramp cache
  * 
- * None of the parameter may have side-effects
+ * @param   cache     The cache
+ * @param   capacity  The maximum number of ramp sets in the cache
+ * @return            Zero on success, -1 on error
  * 
- * Requires linking with '-lm'
+ * @throws  ENOMEM  Insufficient memory is available
+ */
+int libclut_cache_init(libclut_cache_t *, size_t);
+
+/**
+ * Release all resources in a gamma ramp cache
+ * 
+ * @param  cache  The cache
+ */
+void libclut_cache_destroy(libclut_cache_t *);
+
+/**
+ * Store a copy of computed gamma ramps in a cache,
+ * see `libclut_cache_store`
+ * 
+ * @param   cache       The cache
+ * @param   input       The hash of the input ramps
+ * @param   operation   The hash of the operations that were applied
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         The red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       The green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        The blue ramp
+ * @return              Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `type` is invalid
+ * @throws  ENOMEM  Insufficient memory is available
+ */
+int libclut_cache_store_ramps(libclut_cache_t *, uint64_t, uint64_t, libclut_element_type_t, double,
+                              size_t, const void *, size_t, const void *, size_t, const void *);
+
+/**
+ * Copy gamma ramps from a cache, see `libclut_cache_fetch`
+ * 
+ * @param   cache       The cache
+ * @param   input       The hash of the input ramps
+ * @param   operation   The hash of the operations to apply
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         Output parameter for the red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       Output parameter for the green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        Output parameter for the blue ramp
+ * @return              1 if the ramps were copied from the cache,
+ *                      0 if the cache does not have the ramps
+ */
+int libclut_cache_fetch_ramps(libclut_cache_t *, uint64_t, uint64_t, libclut_element_type_t, double,
+                              size_t, void *, size_t, void *, size_t, void *);
+
+/**
+ * Initialiser for a `libclut_ramps_t` that refers to gamma ramps
+ * 
+ * None of the parameter may have side-effects
  * 
  * @param  clut  Pointer to the gamma ramps, must have the arrays
  *               `red`, `green`, and `blue`, and the scalars
  *               `red_size`, `green_size`, and `blue_size`. Ramp
  *               structures from libgamma or libcoopgamma can be used.
  * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  rp    Pointer to the sigmoid parameter for the red curve. `NULL` for no adjustment
- * @param  gp    Pointer to the sigmoid parameter for the green curve. `NULL` for no adjustment
- * @param  bp    Pointer to the sigmoid parameter for the blue curve. `NULL` for no adjustment
+ * @param  type  The data type used for each stop in the ramps, must
+ *               be `uint8_t`, `uint16_t`, `uint32_t`, `uint64_t`,
+ *               `float`, or `double`
  */
-#define libclut_sigmoid(clut, max, type, rp, gp, bp)\
-	do {\
-		double *gcc_6_1_1_workaround, m__ = (double)(max);\
-		const double h__ = (double)5 / 10;\
-		gcc_6_1_1_workaround = rp;\
-		if (gcc_6_1_1_workaround)\
-			libclut_sigmoid__(clut, max, type, red);\
-		gcc_6_1_1_workaround = gp;\
-		if (gcc_6_1_1_workaround)\
-			libclut_sigmoid__(clut, max, type, green);\
-		gcc_6_1_1_workaround = bp;\
-		if (gcc_6_1_1_workaround)\
-			libclut_sigmoid__(clut, max, type, blue);\
-	}\
-	while (0)
+#define LIBCLUT_RAMPS_INITIALISER(clut, max, type)\
+	{LIBCLUT_ELEMENT_TYPE(type), (double)(max), (clut)->red_size, (clut)->green_size, (clut)->blue_size,\
+	 (clut)->red, (clut)->green, (clut)->blue}
 
 /**
- * Apply S-curve correction on the colour curves.
- * This is intended for fine tuning LCD monitors,
- * 4.5 is good value start start testing at.
- * You would probably like to use rgb_limits before
- * this to adjust the blackpoint as that is the
- * only way to adjust the blackpoint on many LCD
- * monitors.
+ * Replace gamma ramps with the composition of a chain of gamma ramps
  * 
- * None of the parameter may have side-effects
+ * Each stop is passed through every ramp in the chain, in order,
+ * with the ramps interpolated linearly and the value kept in double
+ * precision between the ramps, and the result is written once.
+ * This gives less rounding error than applying the ramps one by
+ * one with `libclut_apply`, and the ramps in the chain can have
+ * any size, data type, and maximum value. For integer types, the
+ * result is rounded to nearest and saturated to [0, `max`].
  * 
- * Requires linking with '-lm'
+ * The ramps in the chain may be `clut` itself. If the chain is
+ * empty, the ramps are reset to linear mappings.
  * 
- * Intended for internal use
+ * None of the parameter may have side-effects
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  channel  The channel, must be either "red", "green", or "blue"
+ * Requires linking with '-lclut'
+ * 
+ * @param   clut    Pointer to the gamma ramps, must have the arrays
+ *                  `red`, `green`, and `blue`, and the scalars
+ *                  `red_size`, `green_size`, and `blue_size`. Ramp
+ *                  structures from libgamma or libcoopgamma can be used.
+ * @param   max     The maximum value on each stop in the ramps
+ * @param   type    The data type used for each stop in the ramps, must
+ *                  be `uint8_t`, `uint16_t`, `uint32_t`, `uint64_t`,
+ *                  `float`, or `double`
+ * @param   n       The number of ramps in the chain
+ * @param   stages  The chain, a `const libclut_ramps_t *`, in the order
+ *                  the ramps shall be applied
+ * @return          Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  A data type is invalid, or a ramp in the chain is
+ *                  empty or does not have a positive maximum value
+ * @throws  ENOMEM  Insufficient memory is available
  */
-#define libclut_sigmoid__(clut, max, type, channel)\
-	do {\
-		double s__ = *gcc_6_1_1_workaround, l__;\
-		size_t i__;\
-		for (i__ = 0; i__ < (clut)->channel##_size; i__++) {\
-			l__ = log(m__ / (clut)->channel[i__] - 1);\
-			if (isnan(l__) || isinf(l__))\
-				l__ = 37.024483 * (isinf(l__) > 0 ? +1 : -1);\
-			(clut)->channel[i__] = (type)(m__ * (h__ - l__ / s__));\
-		}\
-	} while (0)
+#define libclut_compose(clut, max, type, n, stages)\
+	libclut_compose_ramps(LIBCLUT_ELEMENT_TYPE(type), (double)(max), (clut)->red_size, (clut)->red,\
+	                      (clut)->green_size, (clut)->green, (clut)->blue_size, (clut)->blue, n, stages)
 
 /**
- * Changes the blackpoint and the whitepoint, using sRGB
+ * Replace gamma ramps with the composition of a chain
+ * of gamma ramps, see `libclut_compose`
+ * 
+ * @param   type        The data type used for each stop in the ramps
+ * @param   max         The maximum value on each stop in the ramps
+ * @param   red_size    The number of stops in the red ramp
+ * @param   red         The red ramp
+ * @param   green_size  The number of stops in the green ramp
+ * @param   green       The green ramp
+ * @param   blue_size   The number of stops in the blue ramp
+ * @param   blue        The blue ramp
+ * @param   n           The number of ramps in the chain
+ * @param   stages      The chain, in the order the ramps shall be applied
+ * @return              Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  A data type is invalid, or a ramp in the chain is
+ *                  empty or does not have a positive maximum value
+ * @throws  ENOMEM  Insufficient memory is available
+ */
+int libclut_compose_ramps(libclut_element_type_t, double, size_t, void *, size_t, void *, size_t, void *,
+                          size_t, const libclut_ramps_t *);
+
+/**
+ * The number of elements needed in each of the tables
+ * filled in by `libclut_pixel_tables`
+ */
+#define LIBCLUT_PIXEL_TABLE_SIZE  1024
+
+/**
+ * Build tables, from the gamma ramps, that are used by
+ * `libclut_apply_pixel_tables` to apply the ramps to
+ * pixels, like a display's hardware gamma ramps would
+ * 
+ * For each channel, the table has one entry per level
+ * representable in the pixel format, mapping the level
+ * to its new level. The ramps are interpolated linearly
+ * and the result is rounded to nearest, so the size of
+ * the ramps does not have to match the pixel format.
  * 
  * None of the parameter may have side-effects
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  rmin  The red component value of the blackpoint
- * @param  rmax  The red component value of the whitepoint
- * @param  gmin  The green component value of the blackpoint
- * @param  gmax  The green component value of the whitepoint
- * @param  bmin  The blue component value of the blackpoint
- * @param  bmax  The blue component value of the whitepoint
+ * @param  clut    Pointer to the gamma ramps, must have the arrays
+ *                 `red`, `green`, and `blue`, and the scalars
+ *                 `red_size`, `green_size`, and `blue_size`. Ramp
+ *                 structures from libgamma or libcoopgamma can be used.
+ * @param  max     The maximum value on each stop in the ramps
+ * @param  type    The data type used for each stop in the ramps (Not actually used)
+ * @param  format  The pixel format, a `libclut_pixel_format_t`
+ * @param  rtable  Output array for the red table, must have
+ *                 at least `LIBCLUT_PIXEL_TABLE_SIZE` elements
+ * @param  gtable  Output array for the green table, must have
+ *                 at least `LIBCLUT_PIXEL_TABLE_SIZE` elements
+ * @param  btable  Output array for the blue table, must have
+ *                 at least `LIBCLUT_PIXEL_TABLE_SIZE` elements
  */
-#define libclut_rgb_limits(clut, max, type, rmin, rmax, gmin, gmax, bmin, bmax)\
+#define libclut_pixel_tables(clut, max, type, format, rtable, gtable, btable)\
 	do {\
-		double diff__;\
-		if (!libclut_0__(rmin) || !libclut_1__(rmax)) {\
-			diff__ = (double)(rmax) - (double)(rmin);\
-			libclut__(clut, red, type, LIBCLUT_VALUE / (double)(max) * diff__ + (rmin));\
-		}\
-		if (!libclut_0__(gmin) || !libclut_1__(gmax)) {\
-			diff__ = (double)(gmax) - (double)(gmin);\
-			libclut__(clut, green, type, LIBCLUT_VALUE / (double)(max) * diff__ + (gmin));\
-		}\
-		if (!libclut_0__(bmin) || !libclut_1__(bmax)) {\
-			diff__ = (double)(bmax) - (double)(bmin);\
-			libclut__(clut, blue, type, LIBCLUT_VALUE / (double)(max) * diff__ + (bmin));\
-		}\
+		libclut_pixel_table__(clut, red,   max, rtable, (size_t)1 << libclut_pixel_bits__(format, 0));\
+		libclut_pixel_table__(clut, green, max, gtable, (size_t)1 << libclut_pixel_bits__(format, 1));\
+		libclut_pixel_table__(clut, blue,  max, btable, (size_t)1 << libclut_pixel_bits__(format, 2));\
 	} while (0)
 
 /**
- * Changes the blackpoint and the whitepoint, using CIE xyY
+ * Apply the gamma ramps to a buffer of pixels, in place,
+ * like a display's hardware gamma ramps would, for example
+ * for outputs without such hardware
+ * 
+ * This is `libclut_pixel_tables` followed by
+ * `libclut_apply_pixel_tables`; if the ramps are applied
+ * to many buffers, it is faster to build the tables once
+ * and use `libclut_apply_pixel_tables` directly
+ * 
+ * The rows are processed independently, so a large buffer can
+ * be split into bands of rows, by adjusting `pixels` and `height`,
+ * that are processed concurrently by different threads
  * 
  * None of the parameter may have side-effects
  * 
  * Requires linking with '-lclut'
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  rmin  The red component value of the blackpoint
- * @param  rmax  The red component value of the whitepoint
- * @param  gmin  The green component value of the blackpoint
- * @param  gmax  The green component value of the whitepoint
- * @param  bmin  The blue component value of the blackpoint
- * @param  bmax  The blue component value of the whitepoint
+ * @param  clut    Pointer to the gamma ramps, must have the arrays
+ *                 `red`, `green`, and `blue`, and the scalars
+ *                 `red_size`, `green_size`, and `blue_size`. Ramp
+ *                 structures from libgamma or libcoopgamma can be used.
+ * @param  max     The maximum value on each stop in the ramps
+ * @param  type    The data type used for each stop in the ramps
+ * @param  format  The pixel format, a `libclut_pixel_format_t`,
+ *                 the buffer is left unmodified if it is invalid
+ * @param  pixels  Pointer to the first pixel in the buffer,
+ *                 must be aligned for the pixel format
+ * @param  width   The number of pixels per row
+ * @param  height  The number of rows
+ * @param  stride  The number of bytes between the first pixel of a
+ *                 row and the first pixel of the next row
  */
-#define libclut_cie_limits(clut, max, type, rmin, rmax, gmin, gmax, bmin, bmax)\
+#define libclut_apply_pixels(clut, max, type, format, pixels, width, height, stride)\
 	do {\
-		double rd__ = (rmax) - (rmin), gd__ = (gmax) - (gmin), bd__ = (bmax) - (bmin);\
-		libclut_cie__(clut, max, type,\
-		              libclut_eq__((rmin), (gmin)) && libclut_eq__((gmin), (bmin)) &&\
-	                      libclut_eq__((rmax), (gmax)) && libclut_eq__((gmax), (bmax)),\
-		              !libclut_0__(rmin) || !libclut_1__(rmax),\
-		              !libclut_0__(gmin) || !libclut_1__(gmax),\
-		              !libclut_0__(bmin) || !libclut_1__(bmax),\
-		              Y__ * rd__ + (rmin), Y__ * gd__ + (gmin), Y__ * bd__ + (bmin));\
+		uint16_t rt__[LIBCLUT_PIXEL_TABLE_SIZE];\
+		uint16_t gt__[LIBCLUT_PIXEL_TABLE_SIZE];\
+		uint16_t bt__[LIBCLUT_PIXEL_TABLE_SIZE];\
+		libclut_pixel_tables(clut, max, type, format, rt__, gt__, bt__);\
+		libclut_apply_pixel_tables(format, pixels, width, height, stride, rt__, gt__, bt__);\
 	} while (0)
 
 /**
- * Manipulate the colour curves using a function on the sRGB colour space
+ * Apply tables built by `libclut_pixel_tables` to a buffer
+ * of pixels, in place
+ * 
+ * Unused and alpha bits are left unmodified
+ * 
+ * The rows are processed independently, so a large buffer can
+ * be split into bands of rows, by adjusting `pixels` and `height`,
+ * that are processed concurrently by different threads
+ * 
+ * @param   format  The pixel format
+ * @param   pixels  Pointer to the first pixel in the buffer,
+ *                  must be aligned for the pixel format
+ * @param   width   The number of pixels per row
+ * @param   height  The number of rows
+ * @param   stride  The number of bytes between the first pixel of a
+ *                  row and the first pixel of the next row
+ * @param   red     The table for the red channel
+ * @param   green   The table for the green channel
+ * @param   blue    The table for the blue channel
+ * @return          Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `format` is not a supported pixel format
+ */
+int libclut_apply_pixel_tables(libclut_pixel_format_t, void *, size_t, size_t, size_t,
+                               const uint16_t *, const uint16_t *, const uint16_t *);
+
+/**
+ * Get the number of bits used for a channel in a pixel format
  * 
  * None of the parameter may have side-effects
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     Function to manipulate the red colour curve, should either
- *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
- * @param  g     Function to manipulate the green colour curve, should either
- *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
- * @param  b     Function to manipulate the blue colour curve, should either
- *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * Intended for internal use
+ * 
+ * @param   format  The pixel format
+ * @param   c       0 for red, 1 for green, 2 for blue
+ * @return          The number of bits, 8 if `format` is invalid
  */
-#define libclut_manipulate(clut, max, type, r, g, b)\
-	do {\
-		double m__ = (double)(max);\
-		double (*gcc_6_1_1_workaround__)(double);\
-		gcc_6_1_1_workaround__ = r;\
-		if (gcc_6_1_1_workaround__)\
-			libclut__(clut, red,   type, m__ * (gcc_6_1_1_workaround__)(LIBCLUT_VALUE / m__));\
-		gcc_6_1_1_workaround__ = g;\
-		if (gcc_6_1_1_workaround__)\
-			libclut__(clut, green, type, m__ * (gcc_6_1_1_workaround__)(LIBCLUT_VALUE / m__));\
-		gcc_6_1_1_workaround__ = b;\
-		if (gcc_6_1_1_workaround__)\
-			libclut__(clut, blue,  type, m__ * (gcc_6_1_1_workaround__)(LIBCLUT_VALUE / m__));\
+#define libclut_pixel_bits__(format, c)\
+	((format) == LIBCLUT_PIXEL_RGB565 ? ((c) == 1 ? 6 : 5) :\
+	 ((format) == LIBCLUT_PIXEL_XRGB2101010 || (format) == LIBCLUT_PIXEL_XBGR2101010) ? 10 : 8)
+
+/**
+ * Build the table for one channel in `libclut_pixel_tables`
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Intended for internal use
+ * 
+ * @param  clut     Pointer to the gamma ramps
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ * @param  max      The maximum value on each stop in the ramps
+ * @param  table    Output array for the table
+ * @param  levels   The number of levels in the channel
+ */
+#define libclut_pixel_table__(clut, channel, max, table, levels)\
+	do {\
+		size_t i__, j__, n__ = (clut)->channel##_size;\
+		double x__, w__, s__ = (double)(n__ - 1) / (double)((levels) - 1);\
+		double l__ = (double)((levels) - 1), m__ = l__ / (double)(max);\
+		for (i__ = 0; i__ < (levels); i__++) {\
+			x__ = (double)i__ * s__;\
+			j__ = (size_t)x__;\
+			j__ -= (j__ == n__ - 1 && j__);\
+			w__ = n__ > 1 ? x__ - (double)j__ : 0;\
+			x__ = (double)(clut)->channel[j__] * (1 - w__);\
+			x__ += w__ > 0 ? (double)(clut)->channel[j__ + 1] * w__ : 0;\
+			x__ = x__ * m__ + 0.5;\
+			(table)[i__] = (uint16_t)(x__ < 0 ? 0 : x__ > l__ ? l__ : x__);\
+		}\
 	} while (0)
 
 /**
- * Manipulate the colour curves using a function on the CIE xyY colour space
+ * Get the offset of a lattice point in a 3D colour lookup table
+ * 
+ * A 3D colour lookup table is a structure with the scalar `size`,
+ * the number of lattice points along each axis (at least 2), and
+ * the array `data`, with `3 * size * size * size` elements. Each
+ * lattice point is stored as three consecutive elements: red,
+ * green, and blue. The red index varies fastest and the blue
+ * index varies slowest, which is the order used by .cube files.
+ * Lattice point `i` along an axis corresponds to the input value
+ * `i / (size - 1)`, and the elements are scaled to [0, `max`]
+ * like the stops in gamma ramps.
  * 
  * None of the parameter may have side-effects
  * 
- * Requires linking with '-lclut'
- * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     Function to manipulate the red colour curve, should either
- *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
- * @param  g     Function to manipulate the green colour curve, should either
- *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
- * @param  b     Function to manipulate the blue colour curve, should either
- *               be `NULL` or map a [0, 1] `double` to a [0, 1] `double`
+ * @param   lut  Pointer to the 3D lookup table, must have the
+ *               array `data` and the scalar `size`
+ * @param   r    The index of the lattice point along the red axis
+ * @param   g    The index of the lattice point along the green axis
+ * @param   b    The index of the lattice point along the blue axis
+ * @return       The index, in `lut->data`, of the red element
+ *               of the lattice point, the green and blue
+ *               elements follow immediately
  */
-#define libclut_cie_manipulate(clut, max, type, r, g, b)\
-	libclut_cie__(clut, max, type, (r) && (g) && (b), r, g, b, (r)(Y__), (g)(Y__), (b)(Y__))
+#define libclut_3d_index(lut, r, g, b)\
+	((((size_t)(b) * (lut)->size + (size_t)(g)) * (lut)->size + (size_t)(r)) * 3)
 
 /**
- * Resets colour curvers to linear mappings
- * (Identity mapping if imaginged to map from [0, 1] to [0, 1])
+ * Resets a 3D colour lookup table to the identity mapping
  * 
  * None of the parameter may have side-effects
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     Whether to reset the red colour curve
- * @param  g     Whether to reset the green colour curve
- * @param  b     Whether to reset the blue colour curve
+ * @param  lut   Pointer to the 3D lookup table, must have the array
+ *               `data` and the scalar `size`, see `libclut_3d_index`
+ * @param  max   The maximum value on each element in the lookup table
+ * @param  type  The data type used for each element in the lookup table
  */
-#define libclut_start_over(clut, max, type, r, g, b)\
+#define libclut_3d_start_over(lut, max, type)\
 	do {\
-		size_t i__;\
-		double m__, max__ = (double)(max);\
-		if (r) {\
-			m__ = (double)((clut)->red_size - 1);\
-			for (i__ = 0; i__ < (clut)->red_size; i__++)\
-				(clut)->red[i__] = (type)(((double)i__ / m__) * max__);\
-		}\
-		if (g) {\
-			m__ = (double)((clut)->green_size - 1);\
-			for (i__ = 0; i__ < (clut)->green_size; i__++)\
-				(clut)->green[i__] = (type)(((double)i__ / m__) * max__);\
-		}\
-		if (b) {\
-			m__ = (double)((clut)->blue_size - 1);\
-			for (i__ = 0; i__ < (clut)->blue_size; i__++)\
-				(clut)->blue[i__] = (type)(((double)i__ / m__) * max__);\
-		}\
+		size_t n__ = (lut)->size, r__, g__, b__;\
+		double d__ = (double)(n__ - 1), max__ = (double)(max);\
+		type *p__ = (lut)->data;\
+		for (b__ = 0; b__ < n__; b__++)\
+			for (g__ = 0; g__ < n__; g__++)\
+				for (r__ = 0; r__ < n__; r__++, p__ += 3) {\
+					p__[0] = (type)(((double)r__ / d__) * max__);\
+					p__[1] = (type)(((double)g__ / d__) * max__);\
+					p__[2] = (type)(((double)b__ / d__) * max__);\
+				}\
 	} while (0)
 
 /**
- * Clip colour curves to only map to values between the minimum and maximum.
- * This should be done, before apply the curves, and before applying changes
- * with limited domain.
+ * Convert the values in a 3D colour lookup table between
+ * two RGB colour spaces, this is the 3D counterpart of
+ * `libclut_convert_rgb_inplace`
  * 
- * Values below 0 are set to 0, and values above `max` are set to `max`
+ * Both RGB colour spaces must have same gamma functions as sRGB
  * 
  * None of the parameter may have side-effects
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  r     Whether to clip the red colour curve
- * @param  g     Whether to clip the green colour curve
- * @param  b     Whether to clip the blue colour curve
+ * Requires linking with '-lclut', or '-lm' if
+ * `libclut_model_convert_rgb` is not undefined
+ * 
+ * @param  lut    Pointer to the 3D lookup table, must have the array
+ *                `data` and the scalar `size`, see `libclut_3d_index`
+ * @param  max    The maximum value on each element in the lookup table
+ * @param  type   The data type used for each element in the lookup table
+ * @param  m      Conversion matrix. Can be created with
+ *                `libclut_model_get_rgb_conversion_matrix`
+ * @param  trunc  Truncate values that are out of gamut
  */
-#define libclut_clip(clut, max, type, r, g, b)\
+#define libclut_3d_convert_rgb(lut, max, type, m, trunc)\
 	do {\
-		if (r) libclut__(clut, red,   type, libclut_clip__(0, LIBCLUT_VALUE, max));\
-		if (g) libclut__(clut, green, type, libclut_clip__(0, LIBCLUT_VALUE, max));\
-		if (b) libclut__(clut, blue,  type, libclut_clip__(0, LIBCLUT_VALUE, max));\
+		double m__ = (double)(max), r__, g__, b__;\
+		size_t i__, n__ = (lut)->size * (lut)->size * (lut)->size * 3;\
+		type *p__ = (lut)->data;\
+		for (i__ = 0; i__ < n__; i__ += 3) {\
+			libclut_model_convert_rgb(p__[i__] / m__, p__[i__ + 1] / m__, p__[i__ + 2] / m__,\
+			                          m, &r__, &g__, &b__);\
+			libclut_3d_store__(p__[i__ + 0], r__ * m__, m__, type, trunc);\
+			libclut_3d_store__(p__[i__ + 1], g__ * m__, m__, type, trunc);\
+			libclut_3d_store__(p__[i__ + 2], b__ * m__, m__, type, trunc);\
+		}\
 	} while (0)
 
 /**
- * Truncates a value to fit a boundary
+ * Create a 3D colour lookup table that converts between two
+ * RGB colour spaces, this has the same effect as
+ * `libclut_3d_start_over` followed by `libclut_3d_convert_rgb`,
+ * but it is much faster because the colours are only linearised
+ * once per lattice index rather than once per lattice point,
+ * the matrix multiplication is partially hoisted out of the
+ * innermost loop, and the values are delinearised with a
+ * polynomial approximation, with a relative error less than
+ * 10⁻⁹, rather than with `pow`
+ * 
+ * Both RGB colour spaces must have same gamma functions as sRGB
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
  * 
  * None of the parameter may have side-effects
  * 
- * Intended for internal use
+ * Requires linking with '-lclut', or '-lm' if
+ * `libclut_model_standard_to_linear1` is not undefined
  * 
- * @param   min  The minimum allowed value
- * @param   val  The current value
- * @param   max  The maximum allowed value
- * @return       The value truncated into its boundary
+ * @param  lut    Pointer to the 3D lookup table, must have the array
+ *                `data` and the scalar `size`, see `libclut_3d_index`
+ * @param  max    The maximum value on each element in the lookup table
+ * @param  type   The data type used for each element in the lookup table
+ * @param  m      Conversion matrix. Can be created with
+ *                `libclut_model_get_rgb_conversion_matrix`
+ * @param  trunc  Truncate values that are out of gamut
  */
-#define libclut_clip__(min, val, max)\
-	(LIBCLUT_VALUE < (min) ? (min) : LIBCLUT_VALUE > (max) ? (max) : LIBCLUT_VALUE)
+#define libclut_3d_rgb_conversion(lut, max, type, m, trunc)\
+	do {\
+		size_t n__ = (lut)->size, r__, g__, b__;\
+		double m__ = (double)(max), d__ = (double)(n__ - 1), l__[n__];\
+		double xb__, yb__, zb__, x__, y__, z__;\
+		type *p__ = (lut)->data;\
+		for (r__ = 0; r__ < n__; r__++)\
+			l__[r__] = libclut_model_standard_to_linear1((double)r__ / d__);\
+		for (b__ = 0; b__ < n__; b__++) {\
+			xb__ = (m)[0][2] * l__[b__];\
+			yb__ = (m)[1][2] * l__[b__];\
+			zb__ = (m)[2][2] * l__[b__];\
+			for (g__ = 0; g__ < n__; g__++) {\
+				x__ = xb__ + (m)[0][1] * l__[g__];\
+				y__ = yb__ + (m)[1][1] * l__[g__];\
+				z__ = zb__ + (m)[2][1] * l__[g__];\
+				for (r__ = 0; r__ < n__; r__++, p__ += 3) {\
+					libclut_3d_store__(p__[0], m__ * libclut_linear_to_standard__(x__ + (m)[0][0] * l__[r__]), m__, type, trunc);\
+					libclut_3d_store__(p__[1], m__ * libclut_linear_to_standard__(y__ + (m)[1][0] * l__[r__]), m__, type, trunc);\
+					libclut_3d_store__(p__[2], m__ * libclut_linear_to_standard__(z__ + (m)[2][0] * l__[r__]), m__, type, trunc);\
+				}\
+			}\
+		}\
+	} while (0)
 
 /**
- * Emulates low colour resolution
+ * Manipulate the colours in a 3D colour lookup table
+ * using a function on the sRGB colour space, unlike
+ * `libclut_manipulate`, the function can mix the channels
  * 
  * None of the parameter may have side-effects
  * 
- * @param  clut  Pointer to the gamma ramps, must have the arrays
- *               `red`, `green`, and `blue`, and the scalars
- *               `red_size`, `green_size`, and `blue_size`. Ramp
- *               structures from libgamma or libcoopgamma can be used.
- * @param  max   The maximum value on each stop in the ramps
- * @param  type  The data type used for each stop in the ramps
- * @param  rx    The desired emulated red encoding resolution, 0 for unchanged
- * @param  ry    The desired emulated red output resolution, 0 for unchanged
- * @param  gx    The desired emulated green encoding resolution, 0 for unchanged
- * @param  gy    The desired emulated green output resolution, 0 for unchanged
- * @param  bx    The desired emulated blue encoding resolution, 0 for unchanged
- * @param  by    The desired emulated blue output resolution, 0 for unchanged
+ * @param  lut   Pointer to the 3D lookup table, must have the array
+ *               `data` and the scalar `size`, see `libclut_3d_index`
+ * @param  max   The maximum value on each element in the lookup table
+ * @param  type  The data type used for each element in the lookup table
+ * @param  f     Function with the signature `void f(double r, double g, double b,
+ *               double *rp, double *gp, double *bp)` that maps an [0, 1] colour,
+ *               (`r`, `g`, `b`), to a [0, 1] colour, stored in `*rp`, `*gp`,
+ *               and `*bp`, which are never `NULL`
  */
-#define libclut_lower_resolution(clut, max, type, rx, ry, gx, gy, bx, by)\
+#define libclut_3d_manipulate(lut, max, type, f)\
 	do {\
-		libclut_lower_resolution__(clut, red,   max, type, rx, ry);\
-		libclut_lower_resolution__(clut, green, max, type, gx, gy);\
-		libclut_lower_resolution__(clut, blue,  max, type, bx, by);\
+		double m__ = (double)(max), r__, g__, b__;\
+		size_t i__, n__ = (lut)->size * (lut)->size * (lut)->size * 3;\
+		type *p__ = (lut)->data;\
+		void (*gcc_6_1_1_workaround__)(double, double, double, double *, double *, double *);\
+		gcc_6_1_1_workaround__ = f;\
+		for (i__ = 0; i__ < n__; i__ += 3) {\
+			(gcc_6_1_1_workaround__)(p__[i__] / m__, p__[i__ + 1] / m__, p__[i__ + 2] / m__,\
+			                         &r__, &g__, &b__);\
+			p__[i__ + 0] = (type)(r__ * m__);\
+			p__[i__ + 1] = (type)(g__ * m__);\
+			p__[i__ + 2] = (type)(b__ * m__);\
+		}\
 	} while (0)
 
 /**
- * Emulates low colour resolution of a channel
+ * Apply gamma ramps to the values in a 3D colour lookup table,
+ * so that any chain of the per-channel operations in this
+ * library can be baked into the lookup table
+ * 
+ * The ramps are interpolated linearly, and values in the lookup
+ * table that are out of range are clipped before the lookup.
+ * A ramp with one stop maps every value to that stop, and the
+ * values for a channel whose ramp is empty are not modified.
  * 
  * None of the parameter may have side-effects
  * 
- * Intended for internal use
+ * @param  lut    Pointer to the 3D lookup table, must have the array
+ *                `data` and the scalar `size`, see `libclut_3d_index`
+ * @param  max    The maximum value on each element in the lookup table
+ * @param  type   The data type used for each element in the lookup table
+ * @param  clut   Pointer to the gamma ramps, must have the arrays
+ *                `red`, `green`, and `blue`, and the scalars
+ *                `red_size`, `green_size`, and `blue_size`. Ramp
+ *                structures from libgamma or libcoopgamma can be used.
+ * @param  cmax   The maximum value on each stop in the ramps
+ * @param  ctype  The data type used for each stop in the ramps (Not actually used)
+ */
+#define libclut_3d_apply_ramps(lut, max, type, clut, cmax, ctype)\
+	do {\
+		double m__ = (double)(max), cm__ = (double)(m__ / (double)(cmax));\
+		size_t i__, n__ = (lut)->size * (lut)->size * (lut)->size * 3;\
+		type *p__ = (lut)->data;\
+		for (i__ = 0; i__ < n__; i__ += 3) {\
+			libclut_3d_apply__(p__[i__ + 0], m__, type, (clut)->red,   (clut)->red_size,   cm__);\
+			libclut_3d_apply__(p__[i__ + 1], m__, type, (clut)->green, (clut)->green_size, cm__);\
+			libclut_3d_apply__(p__[i__ + 2], m__, type, (clut)->blue,  (clut)->blue_size,  cm__);\
+		}\
+	} while (0)
+
+/**
+ * Apply a 3D colour lookup table to a buffer of pixels,
+ * in place, using tetrahedral interpolation
  * 
- * @param  clut     Pointer to the gamma ramps, must have the arrays
- *                  `red`, `green`, and `blue`, and the scalars
- *                  `red_size`, `green_size`, and `blue_size`. Ramp
- *                  structures from libgamma or libcoopgamma can be used.
- * @param  channel  The channel, must be either "red", "green", or "blue"
- * @param  max      The maximum value on each stop in the ramps
- * @param  type     The data type used for each stop in the ramps
- * @param  x        The desired emulated encoding resolution, 0 for unchanged
- * @param  y        The desired emulated output resolution, 0 for unchanged
+ * Each pixel must store its red, green, and blue values, in
+ * that order, in its first three elements; any further elements,
+ * such as alpha or padding, are left unmodified. Out of range
+ * values are clipped, and for integer pixel types the result is
+ * rounded to nearest.
+ * 
+ * For integer pixel types whose `pmax` is at most 4095, the
+ * lattice position of each value is looked up in a table rather
+ * than computed per pixel.
+ * 
+ * The rows are processed independently, so a large buffer can be
+ * split into bands of rows, by adjusting `pixels` and `height`,
+ * that are processed concurrently by different threads; the
+ * lookup table is only read.
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * @param  lut     Pointer to the 3D lookup table, must have the array
+ *                 `data` and the scalar `size`, see `libclut_3d_index`
+ * @param  max     The maximum value on each element in the lookup table
+ * @param  type    The data type used for each element in the lookup table
+ * @param  pixels  Pointer to the first pixel in the buffer
+ * @param  pmax    The maximum value on each channel in the pixels
+ * @param  ptype   The data type used for each channel in the pixels,
+ *                 for example `uint8_t`, `uint16_t`, or `float`
+ * @param  width   The number of pixels per row
+ * @param  height  The number of rows
+ * @param  stride  The number of bytes between the first pixel of a
+ *                 row and the first pixel of the next row
+ * @param  step    The number of elements (`ptype`s) per pixel, at least 3
  */
-#define libclut_lower_resolution__(clut, channel, max, type, x, y)\
+#define libclut_3d_apply(lut, max, type, pixels, pmax, ptype, width, height, stride, step)\
 	do {\
-		if ((x) || (y)) {\
-			size_t x__, y__, i__, n__ = (clut)->channel##_size;\
-			double xm__ = (double)((x) - 1), ym__ = (double)((y) - 1);\
-			double m__ = (double)(max), nm__ = (double)(n__ - 1);\
-			type c__[n__]; /* Do not use alloca! */\
-			const double h__ = (double)5 / 10;\
-			for (i__ = 0; i__ < n__; i__++) {\
-				if ((x__ = i__), (x)) {\
-					x__ = (size_t)((double)i__ * (double)(x) / (double)n__);\
-					x__ = (size_t)((double)x__ * nm__ / xm__);\
+		size_t n__ = (lut)->size, x__, y__, k__, i__[3], oa__, ob__, a__, b__, c__;\
+		size_t o__[3] = {3, 3 * n__, 3 * n__ * n__}, oc__ = 3 + 3 * n__ + 3 * n__ * n__;\
+		double pm__ = (double)(pmax), s__ = (double)(n__ - 1) / pm__, sc__ = pm__ / (double)(max);\
+		double rnd__ = (ptype)0.5 > 0 ? 0 : 0.5, f__[3], v__;\
+		size_t tn__ = libclut_tabulate__(ptype, pmax) ? (size_t)(pmax) + 1 : 1, ti__[tn__];\
+		double tf__[tn__];\
+		const type *l__;\
+		ptype *p__;\
+		for (k__ = 0; tn__ > 1 && k__ < tn__; k__++)\
+			tf__[k__] = libclut_3d_locate__((double)k__ * s__, n__, &ti__[k__]);\
+		for (y__ = 0; y__ < (size_t)(height); y__++) {\
+			p__ = (ptype *)(void *)((char *)(pixels) + y__ * (size_t)(stride));\
+			for (x__ = 0; x__ < (size_t)(width); x__++, p__ += (step)) {\
+				for (k__ = 0; k__ < 3; k__++) {\
+					if (tn__ > 1) {\
+						v__ = (double)p__[k__];\
+						a__ = v__ < (double)tn__ ? (size_t)p__[k__] : tn__ - 1;\
+						i__[k__] = ti__[a__];\
+						f__[k__] = tf__[a__];\
+					} else {\
+						f__[k__] = libclut_3d_locate__((double)p__[k__] * s__, n__, &i__[k__]);\
+					}\
 				}\
-				if (!(y)) {\
-					c__[i__] = (clut)->channel[x__];\
+				if (f__[0] >= f__[1]) {\
+					if (f__[1] >= f__[2])      a__ = 0, b__ = 1, c__ = 2;\
+					else if (f__[0] >= f__[2]) a__ = 0, b__ = 2, c__ = 1;\
+					else                       a__ = 2, b__ = 0, c__ = 1;\
 				} else {\
-					y__ = (size_t)((double)((clut)->channel[x__]) / (max) * ym__ + h__);\
-					c__[i__] = (type)((double)y__ / ym__ * m__);\
+					if (f__[0] >= f__[2])      a__ = 1, b__ = 0, c__ = 2;\
+					else if (f__[1] >= f__[2]) a__ = 1, b__ = 2, c__ = 0;\
+					else                       a__ = 2, b__ = 1, c__ = 0;\
+				}\
+				oa__ = o__[a__];\
+				ob__ = oa__ + o__[b__];\
+				l__ = (lut)->data + i__[0] * o__[0] + i__[1] * o__[1] + i__[2] * o__[2];\
+				for (k__ = 0; k__ < 3; k__++, l__++) {\
+					v__ = (double)l__[0];\
+					v__ += f__[a__] * ((double)l__[oa__] - (double)l__[0]);\
+					v__ += f__[b__] * ((double)l__[ob__] - (double)l__[oa__]);\
+					v__ += f__[c__] * ((double)l__[oc__] - (double)l__[ob__]);\
+					v__ *= sc__;\
+					p__[k__] = (ptype)((v__ > 0 ? (v__ < pm__ ? v__ : pm__) : 0) + rnd__);\
 				}\
 			}\
-			memcpy((clut)->channel, c__, n__ * sizeof(type));\
 		}\
 	} while (0)
 
 /**
- * Translates a gamma ramp structure to another gamma ramp structure type
+ * Look up a value in a ramp with linear interpolation
  * 
  * None of the parameter may have side-effects
  * 
- * @param  dclut  Pointer to the desired gamma ramps, must have the arrays
- *                `red`, `green`, and `blue`, and the scalars `red_size`,
- *                `green_size`, and `blue_size`. Ramp structures from
- *                libgamma or libcoopgamma can be used.
- * @param  dmax   The maximum value on each stop in the ramps in `dclut`
- * @param  dtype  The data type used for each stop in the ramps in `dclut`
- * @param  sclut  Pointer to the set gamma ramps, must have the arrays
- *                `red`, `green`, and `blue`, and the scalars `red_size`,
- *                `green_size`, and `blue_size`. Ramp structures from
- *                libgamma or libcoopgamma can be used
- * @param  smax   The maximum value on each stop in the ramps in `sclut`
- * @param  stype  The data type used for each stop in the ramps in `sclut`
- *                (Not actually used)
+ * Intended for internal use
+ * 
+ * @param  lvalue  The element to update
+ * @param  max     The maximum value on each element, as a `double`
+ * @param  type    The data type used for each element
+ * @param  ramp    The ramp
+ * @param  n       The number of stops in `ramp`
+ * @param  scale   The factor that converts the values in
+ *                 `ramp` to the range of the element
  */
-#define libclut_translate(dclut, dmax, dtype, sclut, smax, stype)\
+#define libclut_3d_apply__(lvalue, max, type, ramp, n, scale)\
 	do {\
-		libclut_translate__(dclut, dmax, dtype, sclut, smax, stype, red);\
-		libclut_translate__(dclut, dmax, dtype, sclut, smax, stype, green);\
-		libclut_translate__(dclut, dmax, dtype, sclut, smax, stype, blue);\
+		double x__ = (double)(lvalue) / (max), w__;\
+		size_t j__;\
+		if ((n) < 2) {\
+			if ((n) == 1)\
+				(lvalue) = (type)((double)(ramp)[0] * (scale));\
+			break;\
+		}\
+		x__ = (x__ < 0 ? 0 : x__ > 1 ? 1 : x__) * (double)((n) - 1);\
+		j__ = (size_t)x__;\
+		j__ = j__ < (n) - 1 ? j__ : (n) - 2;\
+		w__ = x__ - (double)j__;\
+		(lvalue) = (type)(((double)(ramp)[j__] * (1 - w__) + (double)(ramp)[j__ + 1] * w__) * (scale));\
 	} while (0)
 
 /**
- * Translates a gamma ramp structure to another gamma ramp structure type
+ * Store a value in a 3D colour lookup table
  * 
  * None of the parameter may have side-effects
  * 
- * This is intended for internal use
+ * Intended for internal use
  * 
- * @param  dclut    Pointer to the desired gamma ramps, must have the arrays
- *                  `red`, `green`, and `blue`, and the scalars `red_size`,
- *                  `green_size`, and `blue_size`. Ramp structures from
- *                  libgamma or libcoopgamma can be used.
- * @param  dmax     The maximum value on each stop in the ramps in `dclut`
- * @param  dtype    The data type used for each stop in the ramps in `dclut`
- * @param  sclut    Pointer to the set gamma ramps, must have the arrays
- *                  `red`, `green`, and `blue`, and the scalars `red_size`,
- *                  `green_size`, and `blue_size`. Ramp structures from
- *                  libgamma or libcoopgamma can be used.
- * @param  smax     The maximum value on each stop in the ramps in `sclut`
- * @param  stype    The data type used for each stop in the ramps in `sclut`.
- *                  (Not actually used)
- * @param  channel  The channel, must be either "red", "green", or "blue"
+ * @param  lvalue  The element to update
+ * @param  value   The value, scaled to [0, `max`]
+ * @param  max     The maximum value on each element, as a `double`
+ * @param  type    The data type used for each element
+ * @param  trunc   Truncate values that are out of gamut
  */
-#define libclut_translate__(dclut, dmax, dtype, sclut, smax, stype, channel)\
+#define libclut_3d_store__(lvalue, value, max, type, trunc)\
 	do {\
-		size_t di__, si__, sj__;\
-		size_t dn__ = (dclut)->channel##_size;\
-		size_t sn__ = (sclut)->channel##_size;\
-		double dm__ = (double)(dmax);\
-		double sm__ = (double)(smax);\
-		double dmsm__ = dm__ / sm__;\
-		double x__, y__;\
-		if (dn__ == sn__) {\
-			for (di__ = 0; di__ < dn__; di__++) {\
-				y__ = (double)((sclut)->channel[di__]) * dmsm__;\
-				(dclut)->channel[di__] = (dtype)y__;\
-			}\
-		} else {\
-			for (di__ = 0; di__ < dn__; di__++) {\
-				x__ = di__ / (dn__ - 1) * (sn__ - 1);\
-				si__ = (size_t)(x__);\
-				sj__ = si__ + (si__ != sn__);\
-				x__ -= (double)si__;\
-				y__  = (double)((sclut)->channel[si__]) * (1 - x__);\
-				y__ += (double)((sclut)->channel[sj__]) * (x__);\
-				y__ *= dmsm__;\
-				(dclut)->channel[di__] = (dtype)y__;\
-			}\
+		double v__ = (value);\
+		if (trunc)\
+			v__ = v__ < 0 ? 0 : v__ > (max) ? (max) : v__;\
+		(lvalue) = (type)v__;\
+	} while (0)
+
+/**
+ * Find the lattice cell of a value in a 3D colour lookup table
+ * 
+ * Intended for internal use
+ * 
+ * @param   x   The value, scaled to [0, `n` - 1], out of
+ *              range values, and NaN, are clipped
+ * @param   n   The number of lattice points along each axis
+ * @param   ip  Output parameter for the index of the lower
+ *              lattice point of the cell
+ * @return      The position of `x` within the cell, in [0, 1]
+ */
+static inline double
+libclut_3d_locate__(double x, size_t n, size_t *ip)
+{
+	double m = (double)(n - 1);
+	size_t i;
+	x = x > 0 ? (x < m ? x : m) : 0;
+	i = (size_t)x;
+	i -= (i == n - 1);
+	*ip = i;
+	return x - (double)i;
+}
+
+#if !defined(__cplusplus) && ((defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L) || defined(__GNUC__) || defined(__clang__))
+/**
+ * The maximum value on each stop in a ramp structure, derived
+ * from the ramp's element type: `UINT8_MAX`, `UINT16_MAX`,
+ * `UINT32_MAX`, or `UINT64_MAX` for `uint8_t`, `uint16_t`,
+ * `uint32_t`, and `uint64_t`, respectively, and 1 for `float`
+ * and `double`
+ * 
+ * This is a constant expression, the ramps are not accessed
+ * 
+ * Requires C11 or GCC or Clang, not available in C++,
+ * use `libclut::ramp_traits` from <libclut.hpp> instead
+ * 
+ * @param   clut  Pointer to the gamma ramps, must have the array `red`
+ * @return        The maximum value on each stop in the ramps
+ */
+# if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#  define LIBCLUT_MAX(clut)\
+	_Generic((clut)->red[0],\
+	         uint8_t: UINT8_MAX, uint16_t: UINT16_MAX, uint32_t: UINT32_MAX, uint64_t: UINT64_MAX,\
+	         float: 1, double: 1)
+# else
+#  define LIBCLUT_MAX(clut)\
+	(__extension__ _Generic((clut)->red[0],\
+	                        uint8_t: UINT8_MAX, uint16_t: UINT16_MAX, uint32_t: UINT32_MAX, uint64_t: UINT64_MAX,\
+	                        float: 1, double: 1))
+# endif
+#endif
+
+#if (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 202311L) || defined(__GNUC__) || defined(__clang__)
+/**
+ * The data type used for each stop in a ramp structure
+ * 
+ * Requires C23 or GCC or Clang
+ * 
+ * @param   clut  Pointer to the gamma ramps, must have the array `red`
+ * @return        The element type of the ramps
+ */
+# if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 202311L
+#  define LIBCLUT_TYPE(clut)  typeof((clut)->red[0])
+# else
+#  define LIBCLUT_TYPE(clut)  __typeof__((clut)->red[0])
+# endif
+#endif
+
+#if defined(LIBCLUT_MAX) && defined(LIBCLUT_TYPE)
+/**
+ * Apply an operation, whose first three parameters are
+ * the ramps, the maximum value on each stop, and the data
+ * type of each stop, with the maximum value and the data
+ * type derived from the type of the ramps. For example,
+ * `libclut_generic(libclut_gamma, &ramps, r, g, b)` is
+ * equivalent to `libclut_gamma(&ramps, UINT16_MAX, uint16_t,
+ * r, g, b)` if `ramps.red` is a `uint16_t *`
+ * 
+ * Since `max` is a constant expression, it is folded into
+ * the expanded operation at compile-time
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * Requires C11 and C23, or GCC or Clang
+ * 
+ * @param  op    The operation, for example `libclut_gamma`
+ * @param  clut  Pointer to the gamma ramps, must have the arrays
+ *               `red`, `green`, and `blue`, and the scalars
+ *               `red_size`, `green_size`, and `blue_size`. Ramp
+ *               structures from libgamma or libcoopgamma can be used.
+ *               The element type must be `uint8_t`, `uint16_t`,
+ *               `uint32_t`, `uint64_t`, `float`, or `double`.
+ * @param  ...   The rest of the arguments for `op`
+ */
+# define libclut_generic(op, clut, ...)\
+	op(clut, LIBCLUT_MAX(clut), LIBCLUT_TYPE(clut), __VA_ARGS__)
+#endif
+
+/**
+ * Modify a ramp
+ * 
+ * None of the parameter may have side-effects
+ * 
+ * This is intended for internal use
+ * 
+ * @param  clut     Pointer to the gamma ramps, must have and array
+ *                  named `channel` and a scalar named `channel` followed
+ *                  by "_size"
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ * @param  type     The data type used for each stop in the ramps
+ * @param  expr     Expression that evalutes the value a stop should have.
+ *                  It can use the variable `LIBCLUT_VALUE` to get the
+ *                  current value of the stop.
+ */
+#define libclut__(clut, channel, type, expr)\
+	do {\
+		size_t i__, n__ = (clut)->channel##_size;\
+		type LIBCLUT_VALUE;\
+		for (i__ = 0; i__ < n__; i__++) {\
+			LIBCLUT_VALUE = (clut)->channel[i__];\
+			(clut)->channel[i__] = (type)(expr);\
 		}\
 	} while (0)
 
 /**
- * Applies a filter or calibration
+ * Manipulate a ramp using a function, evaluated
+ * as specified for `libclut_manipulate_sampled`
  * 
  * None of the parameter may have side-effects
  * 
- * @param  clut    Pointer to the gamma ramps, must have the arrays
- *                 `red`, `green`, and `blue`, and the scalars
- *                 `red_size`, `green_size`, and `blue_size`. Ramp
- *                 structures from libgamma or libcoopgamma can be used.
- * @param  max     The maximum value on each stop in the ramps
- * @param  type    The data type used for each stop in the ramps
- * @param  filter  Same as `clut`, but for the filter to apply
- * @param  fmax    Same as `max`, but for the filter to apply
- * @param  ftype   Same as `type`, but for the filter to apply (Not actually used)
- * @param  r       Whether to apply the filter for the red curve
- * @param  g       Whether to apply the filter for the green curve
- * @param  b       Whether to apply the filter for the blue curve
+ * This is intended for internal use.
+ * Assumes the existence of variables defined in `libclut_manipulate_sampled`.
+ * 
+ * @param  clut     Pointer to the gamma ramps
+ * @param  max      The maximum value on each stop in the ramps
+ * @param  type     The data type used for each stop in the ramps
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ * @param  f        The function, must not be `NULL`
  */
-#define libclut_apply(clut, max, type, filter, fmax, ftype, r, g, b)\
+#define libclut_sampled__(clut, max, type, channel, f)\
 	do {\
-		if (r) libclut_apply__(clut, max, type, filter, fmax, ftype, red);\
-		if (g) libclut_apply__(clut, max, type, filter, fmax, ftype, green);\
-		if (b) libclut_apply__(clut, max, type, filter, fmax, ftype, blue);\
+		size_t i__, j__, n__ = (clut)->channel##_size;\
+		double m__ = (double)(max), y__ = 0;\
+		type v__, p__ = 0;\
+		if (k__ > 1) {\
+			for (j__ = 0; j__ < k__; j__++)\
+				t__[j__] = m__ * (f)((double)j__ / (double)(k__ - 1));\
+			for (i__ = 0; i__ < n__; i__++)\
+				(clut)->channel[i__] = (type)libclut_interpolate__(t__, k__, (double)(clut)->channel[i__] / m__);\
+		} else if (tn__ > 1) {\
+			memset(d__, 0, tn__);\
+			for (i__ = 0; i__ < n__; i__++) {\
+				j__ = (size_t)(clut)->channel[i__];\
+				if (j__ >= tn__) {\
+					(clut)->channel[i__] = (type)(m__ * (f)((double)j__ / m__));\
+					continue;\
+				}\
+				if (!d__[j__])\
+					t__[j__] = m__ * (f)((double)j__ / m__), d__[j__] = 1;\
+				(clut)->channel[i__] = (type)t__[j__];\
+			}\
+		} else {\
+			for (i__ = 0; i__ < n__; i__++) {\
+				v__ = (clut)->channel[i__];\
+				if (!i__ || !libclut_eq__((double)v__, (double)p__))\
+					y__ = m__ * (f)((double)v__ / m__);\
+				(clut)->channel[i__] = (type)y__;\
+				p__ = v__;\
+			}\
+		}\
 	} while (0)
 
 /**
- * Applies a filter or calibration for one channel
+ * Manipulate a ramp using a function that is
+ * called with chunks of stops at a time
  * 
  * None of the parameter may have side-effects
  * 
- * Intended for internal use
+ * This is intended for internal use
  * 
- * @param  clut     Pointer to the gamma ramps, must have the arrays
- *                  `red`, `green`, and `blue`, and the scalars
- *                  `red_size`, `green_size`, and `blue_size`. Ramp
- *                  structures from libgamma or libcoopgamma can be used.
+ * @param  clut     Pointer to the gamma ramps
  * @param  max      The maximum value on each stop in the ramps
  * @param  type     The data type used for each stop in the ramps
- * @param  filter   Same as `clut`, but for the filter to apply
- * @param  fmax     Same as `max`, but for the filter to apply
- * @param  ftype    Same as `type`, but for the filter to apply (Not actually used)
  * @param  channel  The channel, must be either "red", "green", or "blue"
+ * @param  f        The function, must not be `NULL`
+ * @param  user     The last argument for `f`
  */
-#define libclut_apply__(clut, max, type, filter, fmax, ftype, channel)\
+#define libclut_batch__(clut, max, type, channel, f, user)\
 	do {\
-		size_t i__, rn__ = (clut)->channel##_size, fn__ = (filter)->channel##_size - 1;\
-		double x__, rm__ = (double)(max), m__ = (double)(max) / (double)(fmax);\
-		for (i__ = 0; i__ < rn__; i__++) {\
-			x__ = (double)((clut)->channel[i__]) / rm__ * (double)fn__;\
-			(clut)->channel[i__] = (type)((double)((filter)->channel[(size_t)x__]) * m__);\
+		double in__[LIBCLUT_BATCH_SIZE], out__[LIBCLUT_BATCH_SIZE], m__ = (double)(max);\
+		size_t i__, j__, k__, n__ = (clut)->channel##_size;\
+		for (i__ = 0; i__ < n__; i__ += k__) {\
+			k__ = n__ - i__ < LIBCLUT_BATCH_SIZE ? n__ - i__ : LIBCLUT_BATCH_SIZE;\
+			for (j__ = 0; j__ < k__; j__++)\
+				in__[j__] = (double)(clut)->channel[i__ + j__] / m__;\
+			(f)(in__, out__, k__, user);\
+			for (j__ = 0; j__ < k__; j__++)\
+				(clut)->channel[i__ + j__] = (type)(m__ * out__[j__]);\
 		}\
 	} while (0)
 
 /**
- * Applies a filter or calibration, using CIE xyY
+ * Interpolate linearly between evenly spaced samples of a function
+ * 
+ * Intended for internal use
+ * 
+ * @param   t  The values of the function at the points `i / (n - 1)`
+ * @param   n  The number of samples, at least 2
+ * @param   x  The input value, out of range values, and NaN, are clipped
+ * @return     The interpolated value of the function at `x`
+ */
+static inline double
+libclut_interpolate__(const double *t, size_t n, double x)
+{
+	size_t i;
+	x = (!(x > 0) ? 0 : x > 1 ? 1 : x) * (double)(n - 1);
+	i = (size_t)x;
+	i -= i == n - 1;
+	x -= (double)i;
+	return t[i] * (1 - x) + t[i + 1] * x;
+}
+
+/**
+ * Append an affine function to one channel of an affine operation
  * 
  * None of the parameter may have side-effects
  * 
- * Requires linking with '-lclut'
+ * This is intended for internal use
  * 
- * @param  clut    Pointer to the gamma ramps, must have the arrays
- *                 `red`, `green`, and `blue`, and the scalars
- *                 `red_size`, `green_size`, and `blue_size`. Ramp
- *                 structures from libgamma or libcoopgamma can be used.
- * @param  max     The maximum value on each stop in the ramps
- * @param  type    The data type used for each stop in the ramps
- * @param  filter  Same as `clut`, but for the filter to apply
- * @param  fmax    Same as `max`, but for the filter to apply
- * @param  ftype   Same as `type`, but for the filter to apply (Not actually used)
- * @param  r       Whether to apply the filter for the red curve
- * @param  g       Whether to apply the filter for the green curve
- * @param  b       Whether to apply the filter for the blue curve
+ * @param  op       Pointer to the `libclut_affine_t`
+ * @param  channel  The channel, must be either "red", "green", or "blue"
+ * @param  mul      The factor to multiply by after the operation
+ * @param  add      The value to add after the multiplication
  */
-#define libclut_cie_apply(clut, max, type, filter, fmax, ftype, r, g, b)\
+#define libclut_affine__(op, channel, mul, add)\
 	do {\
-		size_t rfn__ = (filter)->red_size - 1, gfn__ = (filter)->green_size - 1;\
-		size_t bfn__ = (filter)->blue_size - 1, x__;\
-		size_t rm__ = (double)(max), fm__ = (double)(fmax);\
-		libclut_cie__(clut, max, type, 0, r, g, b,\
-		              (x__ = (size_t)(Y__ / rm__ * rfn__), (double)((filter)->red[x__])   / fm__),\
-		              (x__ = (size_t)(Y__ / rm__ * gfn__), (double)((filter)->green[x__]) / fm__),\
-		              (x__ = (size_t)(Y__ / rm__ * bfn__), (double)((filter)->blue[x__])  / fm__));\
+		double m__ = (double)(mul);\
+		(op)->channel##_offset = (op)->channel##_offset * m__ + (double)(add);\
+		(op)->channel##_factor *= m__;\
 	} while (0)
 
 /**
- * Modify a ramp
+ * Modify a ramp with an affine function, using only
+ * integer arithmetics on each stop
+ * 
+ * The coefficients are converted to Q16 fixed-point
+ * for 8-bit ramps and Q32 fixed-point for 16-bit ramps,
+ * the result is rounded to nearest and saturated to
+ * [0, `max`]. If the absolute value of the factor is
+ * not less than 16384, or the absolute value of the
+ * offset is not less than 2³⁰, the products would not
+ * fit in 64 bits, so floating-point arithmetics, with
+ * the same rounding and saturation, is used instead.
  * 
  * None of the parameter may have side-effects
  * 
+ * Requires linking with '-lm'
+ * 
  * This is intended for internal use
  * 
  * @param  clut     Pointer to the gamma ramps, must have and array
  *                  named `channel` and a scalar named `channel` followed
  *                  by "_size"
  * @param  channel  The channel, must be either "red", "green", or "blue"
- * @param  type     The data type used for each stop in the ramps
- * @param  expr     Expression that evalutes the value a stop should have.
- *                  It can use the variable `LIBCLUT_VALUE` to get the
- *                  current value of the stop.
+ * @param  max      The maximum value on each stop in the ramps
+ * @param  type     The data type used for each stop in the ramps, must
+ *                  be an unsigned integer type of at most 16 bits
+ * @param  mul      The factor each stop shall be multiplied by
+ * @param  add      The value to add to each stop after the multiplication
  */
-#define libclut__(clut, channel, type, expr)\
+#define libclut_fixed__(clut, channel, max, type, mul, add)\
 	do {\
 		size_t i__, n__ = (clut)->channel##_size;\
-		type LIBCLUT_VALUE;\
+		const int s__ = sizeof(type) == 1 ? 16 : 32;\
+		const double one__ = (double)((int_least64_t)1 << s__);\
+		const double m__ = (double)(mul), a__ = (double)(add), h__ = (double)5 / 10;\
+		int_least64_t mul__, add__, max__ = (int_least64_t)(max), y__;\
+		double d__;\
+		if (!(fabs(m__) < 16384) || !(fabs(a__) < 1073741824.)) {\
+			for (i__ = 0; i__ < n__; i__++) {\
+				d__ = (double)(clut)->channel[i__] * m__ + a__;\
+				d__ = d__ > 0 ? d__ + h__ : 0;\
+				(clut)->channel[i__] = (type)(d__ < (double)max__ ? (int_least64_t)d__ : max__);\
+			}\
+			break;\
+		}\
+		mul__ = (int_least64_t)llround(m__ * one__);\
+		add__ = (int_least64_t)llround(a__ * one__) + ((int_least64_t)1 << (s__ - 1));\
 		for (i__ = 0; i__ < n__; i__++) {\
-			LIBCLUT_VALUE = (clut)->channel[i__];\
-			(clut)->channel[i__] = (type)(expr);\
+			y__ = (int_least64_t)(clut)->channel[i__] * mul__ + add__;\
+			y__ = y__ < 0 ? 0 : (y__ >> s__);\
+			(clut)->channel[i__] = (type)(y__ > max__ ? max__ : y__);\
 		}\
 	} while (0)
 
@@ -1670,6 +5025,76 @@ void (libclut_model_standard_to_linear)(double *, double *, double *);
 		*b__ = libclut_model_standard_to_linear1(*b__);\
 	} while (0)
 
+/**
+ * Convert one component from linear to encoded with a transfer function
+ * 
+ * @param   tf  The transfer function
+ * @param   c   The linear value
+ * @return      Corresponding encoded value
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__pure__, __leaf__, __nonnull__)))
+double libclut_model_transfer_encode(const libclut_transfer_function_t *, double);
+
+/**
+ * Convert one component from encoded with a transfer function to linear
+ * 
+ * @param   tf  The transfer function
+ * @param   c   The encoded value
+ * @return      Corresponding linear value
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__pure__, __leaf__, __nonnull__)))
+double libclut_model_transfer_decode(const libclut_transfer_function_t *, double);
+
+/**
+ * Prepare the tables for a transfer function
+ * 
+ * @param   table  Output parameter for the tables
+ * @param   tf     The transfer function
+ * @return         Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  `tf->type` is not a valid transfer function
+ * @throws  EINVAL  `tf->type` is `LIBCLUT_TRANSFER_GAMMA`,
+ *                  but `tf->gamma` is not positive
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__, __nonnull__)))
+int libclut_model_prepare_transfer_table(libclut_transfer_table_t *, const libclut_transfer_function_t *);
+
+/**
+ * Convert many components from linear to encoded with a transfer function
+ * 
+ * Values in [2⁻¹⁶, 1] are interpolated from `table`, with an
+ * absolute error of less than 10⁻⁵, other values are
+ * converted with `libclut_model_transfer_encode`
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
+ * 
+ * @param  in     The linear values
+ * @param  out    Output parameter for the encoded values, may be `in`
+ * @param  n      The number of values in `in` and `out`
+ * @param  table  The transfer function, prepared with
+ *                `libclut_model_prepare_transfer_table`
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void libclut_model_transfer_encode_batch(const double *, double *, size_t, const libclut_transfer_table_t *);
+
+/**
+ * Convert many components from encoded with a transfer function to linear
+ * 
+ * Values in [2⁻¹⁶, 1] are interpolated from `table`, with an
+ * absolute error of less than 10⁻⁵, other values are
+ * converted with `libclut_model_transfer_decode`
+ * 
+ * Assumes that `double` is an IEEE 754 binary64
+ * 
+ * @param  in     The encoded values
+ * @param  out    Output parameter for the linear values, may be `in`
+ * @param  n      The number of values in `in` and `out`
+ * @param  table  The transfer function, prepared with
+ *                `libclut_model_prepare_transfer_table`
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void libclut_model_transfer_decode_batch(const double *, double *, size_t, const libclut_transfer_table_t *);
+
 /**
  * Convert CIE xyY to CIE XYZ
  * 
@@ -1824,7 +5249,7 @@ void (libclut_model_ciexyz_to_cielab)(double, double, double, double *, double *
 #define libclut_model_ciexyz_to_cielab(X, Y, Z, L, a, b)\
 	do {\
 		double X__ = (X), Y__ = (Y), Z__ = (Z);\
-		X__ /= 0.95047, Z__ /= 1.08883;\
+		X__ *= 1 / 0.95047, Z__ *= 1 / 1.08883;\
 		X__ = LIBCLUT_MODEL_CIEXYZ_TO_CIELAB__(X__);\
 		Y__ = LIBCLUT_MODEL_CIEXYZ_TO_CIELAB__(Y__);\
 		Z__ = LIBCLUT_MODEL_CIEXYZ_TO_CIELAB__(Z__);\
@@ -1833,7 +5258,7 @@ void (libclut_model_ciexyz_to_cielab)(double, double, double, double *, double *
 		*(b) = 200 * (Y__ - Z__);\
 	} while (0)
 #define LIBCLUT_MODEL_CIEXYZ_TO_CIELAB__(C)\
-	(((C) > 0.00885642) ? pow((C), 1.0 / 3) : ((7.78 + 703.0 / 99900) * (C) + 0.1379310))
+	(((C) > 0.00885642) ? cbrt(C) : ((7.78 + 703.0 / 99900) * (C) + 0.1379310))
 
 /**
  * Convert from CIE L*a*b* to CIE XYZ
@@ -1855,11 +5280,43 @@ void (libclut_model_cielab_to_ciexyz)(double, double, double, double *, double *
 		*X__ = a__ / 500 + *Y__;\
 		*Z__ = *Y__ - b__ / 200;\
 		*X__ = LIBCLUT_MODEL_CIELAB_TO_CIEXYZ__(*X__) * 0.95047;\
-		*Y__ = LIBCLUT_MODEL_CIELAB_TO_CIEXYZ__(*Y__) * 1.08883;\
-		*Z__ = LIBCLUT_MODEL_CIELAB_TO_CIEXYZ__(*Z__);\
+		*Y__ = LIBCLUT_MODEL_CIELAB_TO_CIEXYZ__(*Y__);\
+		*Z__ = LIBCLUT_MODEL_CIELAB_TO_CIEXYZ__(*Z__) * 1.08883;\
 	} while (0)
 #define LIBCLUT_MODEL_CIELAB_TO_CIEXYZ__(C)\
-	(((C)*(C)*(C) > 0.00885642) ? ((C)*(C)*(C)) : (((C) - 0.1379310) / (7.78 + 703.0 / 99900)))
+	(((C)*(C)*(C) > 0.00885642) ? ((C)*(C)*(C)) : (((C) - 0.1379310) * (1 / (7.78 + 703.0 / 99900))))
+
+/**
+ * Convert many colours from CIE XYZ to CIE L*a*b*
+ * 
+ * This function gives the same results as `libclut_model_ciexyz_to_cielab`,
+ * with an error less than 1e-6, but is much faster. The cube root is
+ * calculated with an initial approximation from the representation of
+ * the value, refined with Newton's method, and the piecewise function
+ * is selected without branching, so that the loop can be vectorised.
+ * 
+ * @param  xyz  The X, Y, and Z parameters, interleaved
+ * @param  lab  Output parameter for the L*, a*, and b* components,
+ *              interleaved, may be `xyz`
+ * @param  n    The number of colours
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void libclut_model_ciexyz_to_cielab_batch(const double *, double *, size_t);
+
+/**
+ * Convert many colours from CIE L*a*b* to CIE XYZ
+ * 
+ * This function gives the same results as `libclut_model_cielab_to_ciexyz`,
+ * but is faster as the piecewise function is selected without branching,
+ * so that the loop can be vectorised
+ * 
+ * @param  lab  The L*, a*, and b* components, interleaved
+ * @param  xyz  Output parameter for the X, Y, and Z parameters,
+ *              interleaved, may be `lab`
+ * @param  n    The number of colours
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void libclut_model_cielab_to_ciexyz_batch(const double *, double *, size_t);
 
 /**
  * Convert from CIE XYZ to CIELUV
@@ -1933,6 +5390,134 @@ void (libclut_model_cieluv_to_ciexyz)(double, double, double, double, double, do
 		*(Z) = y__ * (12 - 3 * u__ - 20 * v__) / (4 * v__);\
 	} while (0)
 
+/**
+ * Prepare a reference white for the CIE L*a*b*
+ * and CIE L*u*v* conversions that take one
+ * 
+ * @param  wp  The white point, `.white_x`, `.white_y`, and
+ *             `.white_Y` must be set, the other members are set
+ */
+void libclut_model_prepare_white_point(libclut_white_point_t *);
+
+/**
+ * Convert from CIE XYZ to CIE L*a*b*, with a specified reference white
+ * 
+ * The macro variant requires linking with '-lm'
+ * 
+ * @param  X   The X parameter
+ * @param  Y   The Y parameter
+ * @param  Z   The Z parameter
+ * @param  wp  The reference white, prepared with `libclut_model_prepare_white_point`
+ * @param  L   Output parameter for the L* component
+ * @param  a   Output parameter for the a* component
+ * @param  b   Output parameter for the b* component
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void (libclut_model_ciexyz_to_cielab_wp)(double, double, double, const libclut_white_point_t *,
+                                         double *, double *, double *);
+#define libclut_model_ciexyz_to_cielab_wp(X, Y, Z, wp, L, a, b)\
+	do {\
+		const libclut_white_point_t *wp__ = (wp);\
+		double X__ = (X) * wp__->rXn, Y__ = (Y) * wp__->rYn, Z__ = (Z) * wp__->rZn;\
+		X__ = LIBCLUT_MODEL_CIEXYZ_TO_CIELAB__(X__);\
+		Y__ = LIBCLUT_MODEL_CIEXYZ_TO_CIELAB__(Y__);\
+		Z__ = LIBCLUT_MODEL_CIEXYZ_TO_CIELAB__(Z__);\
+		*(L) = 116 * Y__ - 16;\
+		*(a) = 500 * (X__ - Y__);\
+		*(b) = 200 * (Y__ - Z__);\
+	} while (0)
+
+/**
+ * Convert from CIE L*a*b* to CIE XYZ, with a specified reference white
+ * 
+ * @param  L   The L* component
+ * @param  a   The a* component
+ * @param  b   The b* component
+ * @param  wp  The reference white, prepared with `libclut_model_prepare_white_point`
+ * @param  X   Output parameter for the X parameter
+ * @param  Y   Output parameter for the Y parameter
+ * @param  Z   Output parameter for the Z parameter
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void (libclut_model_cielab_to_ciexyz_wp)(double, double, double, const libclut_white_point_t *,
+                                         double *, double *, double *);
+#define libclut_model_cielab_to_ciexyz_wp(L, a, b, wp, X, Y, Z)\
+	do {\
+		const libclut_white_point_t *wp__ = (wp);\
+		double Y__ = ((L) + 16) * (1. / 116);\
+		double X__ = (a) * (1. / 500) + Y__;\
+		double Z__ = Y__ - (b) * (1. / 200);\
+		*(X) = LIBCLUT_MODEL_CIELAB_TO_CIEXYZ__(X__) * wp__->Xn;\
+		*(Y) = LIBCLUT_MODEL_CIELAB_TO_CIEXYZ__(Y__) * wp__->Yn;\
+		*(Z) = LIBCLUT_MODEL_CIELAB_TO_CIEXYZ__(Z__) * wp__->Zn;\
+	} while (0)
+
+/**
+ * Convert from CIE XYZ to CIELUV, with a specified reference white
+ * 
+ * The macro variant requires linking with '-lm'
+ * 
+ * @param  X   The X component
+ * @param  Y   The Y component
+ * @param  Z   The Z component
+ * @param  wp  The reference white, prepared with `libclut_model_prepare_white_point`
+ * @param  L   Output parameter for the L* parameter
+ * @param  u   Output parameter for the u* parameter
+ * @param  v   Output parameter for the v* parameter
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void (libclut_model_ciexyz_to_cieluv_wp)(double, double, double, const libclut_white_point_t *,
+                                         double *, double *, double *);
+#define libclut_model_ciexyz_to_cieluv_wp(X, Y, Z, wp, L, u, v)\
+	do {\
+		const libclut_white_point_t *wp__ = (wp);\
+		double x__ = (X), y__ = (Y);\
+		double t__ = 1 / (x__ + 15 * y__ + 3 * (Z));\
+		double u__ = 4 * x__ * t__ - wp__->un;\
+		double v__ = 9 * y__ * t__ - wp__->vn;\
+		y__ *= wp__->rYn;\
+		if (y__ * 24389 <= (double)216)\
+			y__ *= 24389. / 27;\
+		else\
+			y__ = cbrt(y__) * 116 - 16;\
+		*(L) = y__;\
+		y__ *= 13;\
+		*(u) = y__ * u__;\
+		*(v) = y__ * v__;\
+	} while (0)
+
+/**
+ * Convert from CIELUV to CIE XYZ, with a specified reference white
+ * 
+ * @param  L   The L* component
+ * @param  u   The u* component
+ * @param  v   The v* component
+ * @param  wp  The reference white, prepared with `libclut_model_prepare_white_point`
+ * @param  X   Output parameter for the X parameter
+ * @param  Y   Output parameter for the Y parameter
+ * @param  Z   Output parameter for the Z parameter
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void (libclut_model_cieluv_to_ciexyz_wp)(double, double, double, const libclut_white_point_t *,
+                                         double *, double *, double *);
+#define libclut_model_cieluv_to_ciexyz_wp(L, u, v, wp, X, Y, Z)\
+	do {\
+		const libclut_white_point_t *wp__ = (wp);\
+		double l__ = (L), y__ = wp__->Yn, r__ = 1 / (l__ * 13);\
+		double u__ = (u) * r__ + wp__->un;\
+		double v__ = (v) * r__ + wp__->vn;\
+		if (l__ <= (double)8) {\
+			y__ *= l__ * (27. / 24389);\
+		} else {\
+			l__ = (l__ + 16) * (1. / 116);\
+			y__ *= l__ * l__ * l__;\
+		}\
+		r__ = y__ / (4 * v__);\
+		*(Y) = y__;\
+		*(X) = 9 * u__ * r__;\
+		*(Z) = (12 - 3 * u__ - 20 * v__) * r__;\
+	} while (0)
+
 /**
  * Convert from CIELCh to CIE L*u*v*
  * 
@@ -2246,6 +5831,32 @@ void (libclut_model_ciexyz_to_cie_1960_ucs)(double, double, double, double *, do
 		*(Y) = y__;\
 	} while (0)
 
+/**
+ * Get the chromaticity of a blackbody of a
+ * correlated colour temperature in CIE xyY
+ * 
+ * The chromaticity is interpolated from a table
+ * of the Planckian locus, it is accurate to
+ * within 0.0001
+ * 
+ * @param  T  The temperature, in kelvins, clamped to [1000, 25000]
+ * @param  x  Output parameter for the x parameter
+ * @param  y  Output parameter for the y parameter
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void libclut_model_cct_to_ciexy(double, double *, double *);
+
+/**
+ * Get the chromaticity of a blackbody of a
+ * correlated colour temperature in CIE 1960 UCS
+ * 
+ * @param  T  The temperature, in kelvins, clamped to [1000, 25000]
+ * @param  u  Output parameter for the u parameter
+ * @param  v  Output parameter for the v parameter
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void libclut_model_cct_to_cie_1960_ucs(double, double *, double *);
+
 /**
  * Convert from CIEUVW to CIE 1960 UCS
  * 
@@ -2293,6 +5904,38 @@ void (libclut_model_cie_1960_ucs_to_cieuvw)(double, double, double, double, doub
 		*(V) = w__ * ((v) - (v0));\
 	} while (0)
 
+/**
+ * Invert a colour space conversion matrix
+ * 
+ * The inverse is calculated in closed form from the adjugate
+ * and the determinant of the matrix, so it is cheap enough
+ * to be done whenever a conversion is set up
+ * 
+ * @param   M     The matrix to invert
+ * @param   Minv  Output parameter for the inverse of `M`, may be `M`
+ * @param   cond  Output parameter for the condition number of `M`, in the
+ *                maximum absolute row sum norm, may be `NULL`; a large
+ *                condition number means that converting back and forth
+ *                with the matrices will amplify rounding errors
+ * @return        Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  The matrix is singular or contains non-finite values
+ */
+int libclut_model_invert_matrix(libclut_colour_space_conversion_matrix_t, libclut_colour_space_conversion_matrix_t, double *);
+
+/**
+ * Multiply two colour space conversion matrices, so that
+ * converting with the product is the same as converting
+ * with `B` and then with `A`
+ * 
+ * @param  R  Output parameter for `A` times `B`, may be `A` or `B`
+ * @param  A  The left-hand factor
+ * @param  B  The right-hand factor
+ */
+LIBCLUT_GCC_ONLY__(__attribute__((__leaf__)))
+void libclut_model_multiply_matrices(libclut_colour_space_conversion_matrix_t, libclut_colour_space_conversion_matrix_t,
+                                     libclut_colour_space_conversion_matrix_t);
+
 /**
  * Create a matrix for converting values between
  * two RGB colour spaces
@@ -2310,10 +5953,38 @@ void (libclut_model_cie_1960_ucs_to_cieuvw)(double, double, double, double, doub
 int libclut_model_get_rgb_conversion_matrix(const libclut_rgb_colour_space_t *, const libclut_rgb_colour_space_t *,
                                             libclut_colour_space_conversion_matrix_t, libclut_colour_space_conversion_matrix_t);
 
+/**
+ * Create a matrix for converting values between two RGB colour
+ * spaces, that also maps the white point of the input colour
+ * space to the white point of the output colour space
+ * 
+ * The adaptation is folded into the matrix, so converting with
+ * it costs the same as converting with a matrix created with
+ * `libclut_model_get_rgb_conversion_matrix`
+ * 
+ * @param   from  The input colour space, `NULL` for CIE XYZ
+ * @param   to    The output colour space, `NULL` for CIE XYZ
+ * @param   cat   The chromatic adaptation transform, no adaptation is
+ *                done if `from` or `to` is `NULL` as CIE XYZ does not
+ *                have a white point
+ * @param   M     Output matrix for conversion from `from` to `to`
+ * @param   Minv  Output matrix for conversion from `to` to `from`, may be `NULL`
+ * @return        Zero on success, -1 on error
+ * 
+ * @throws  EINVAL  The colour space cannot be used
+ * @throws  EINVAL  `cat` is not a valid chromatic adaptation transform
+ */
+int libclut_model_get_adapted_rgb_conversion_matrix(const libclut_rgb_colour_space_t *, const libclut_rgb_colour_space_t *,
+                                                    libclut_chromatic_adaptation_t, libclut_colour_space_conversion_matrix_t,
+                                                    libclut_colour_space_conversion_matrix_t);
+
 /**
  * Convert an RGB colour into another RGB colour space
  * 
- * Both RGB colour spaces must have same gamma functions as sRGB
+ * Both RGB colour spaces must have same gamma functions as sRGB,
+ * regardless of their `transfer` members, see
+ * `libclut_model_transfer_decode` and `libclut_model_transfer_encode`
+ * for other transfer functions
  * 
  * Requires linking with '-lclut', or '-lm' if
  * `libclut_model_standard_to_linear1` or
@@ -2397,4 +6068,8 @@ void (libclut_model_ciexyz_to_rgb)(double, double, double, libclut_colour_space_
 # pragma GCC diagnostic pop
 #endif
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,616 @@
+/* See LICENSE file for copyright and license details. */
+#ifndef LIBCLUT_HPP
+#define LIBCLUT_HPP
+
+#include "libclut.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+
+/**
+ * C++ interface for libclut
+ *
+ * Requires C++14
+ */
+namespace libclut
+{
+
+/**
+ * The default maximum value on each stop in a ramp
+ * with a specific element type: the greatest value
+ * for unsigned integer types, and 1 for floating-point
+ * types
+ *
+ * @param  T  The data type used for each stop in the ramps
+ */
+template <typename T>
+struct ramp_traits
+{
+	static_assert((std::is_integral<T>::value && std::is_unsigned<T>::value) || std::is_floating_point<T>::value,
+	              "ramp elements must be unsigned integers or floating-point values");
+
+	/**
+	 * The default maximum value on each stop
+	 */
+	static constexpr std::uintmax_t max = std::is_integral<T>::value ? (std::uintmax_t)std::numeric_limits<T>::max() : 1;
+};
+
+
+/**
+ * View of a set of gamma ramps, with the same layout as ramp
+ * structures from libgamma and libcoopgamma, so that the
+ * views can also be used with the macros in <libclut.h>
+ *
+ * The view does not own the ramps
+ *
+ * @param  T    The data type used for each stop in the ramps
+ * @param  Max  The maximum value on each stop in the ramps
+ */
+template <typename T, std::uintmax_t Max = ramp_traits<T>::max>
+struct ramp_view
+{
+	/**
+	 * The data type used for each stop in the ramps
+	 */
+	typedef T value_type;
+
+	/**
+	 * The maximum value on each stop in the ramps
+	 */
+	static constexpr double max = (double)Max;
+
+	/**
+	 * The number of stops in the red ramp
+	 */
+	std::size_t red_size;
+
+	/**
+	 * The number of stops in the green ramp
+	 */
+	std::size_t green_size;
+
+	/**
+	 * The number of stops in the blue ramp
+	 */
+	std::size_t blue_size;
+
+	/**
+	 * The red ramp
+	 */
+	T *red;
+
+	/**
+	 * The green ramp
+	 */
+	T *green;
+
+	/**
+	 * The blue ramp
+	 */
+	T *blue;
+
+	/**
+	 * Create a view from separate arrays
+	 *
+	 * @param  red          The red ramp
+	 * @param  red_size     The number of stops in the red ramp
+	 * @param  green        The green ramp
+	 * @param  green_size   The number of stops in the green ramp
+	 * @param  blue         The blue ramp
+	 * @param  blue_size    The number of stops in the blue ramp
+	 */
+	constexpr ramp_view(T *red, std::size_t red_size, T *green, std::size_t green_size, T *blue, std::size_t blue_size) noexcept
+		: red_size(red_size), green_size(green_size), blue_size(blue_size), red(red), green(green), blue(blue)
+	{
+	}
+
+	/**
+	 * Create a view of a ramp structure, for example
+	 * from libgamma or libcoopgamma
+	 *
+	 * @param  ramps  Ramp structure, must have the arrays `red`,
+	 *                `green`, and `blue`, and the scalars `red_size`,
+	 *                `green_size`, and `blue_size`
+	 */
+	template <typename Ramps>
+	constexpr explicit ramp_view(Ramps &ramps) noexcept
+		: red_size(ramps.red_size), green_size(ramps.green_size), blue_size(ramps.blue_size),
+		  red(ramps.red), green(ramps.green), blue(ramps.blue)
+	{
+	}
+};
+
+
+/**
+ * Implementation details, not part of the interface
+ */
+namespace detail
+{
+
+/**
+ * Modify each stop in a ramp
+ *
+ * @param  ramp  The ramp
+ * @param  n     The number of stops in the ramp
+ * @param  f     Function that maps the current value
+ *               of a stop to its new value
+ */
+template <typename T, typename F>
+inline void
+map_ramp(T *ramp, std::size_t n, F &&f)
+{
+	for (std::size_t i = 0; i < n; i++)
+		ramp[i] = static_cast<T>(f(static_cast<double>(ramp[i])));
+}
+
+}
+
+/**
+ * Manipulate the colour curves using a function on the sRGB colour space
+ *
+ * Unlike `libclut_manipulate`, any callable object can be used
+ * and the arguments may have side-effects
+ *
+ * @param  ramps  The gamma ramps
+ * @param  r      Function to manipulate the red colour curve,
+ *                maps a [0, 1] `double` to a [0, 1] `double`
+ * @param  g      Function to manipulate the green colour curve,
+ *                maps a [0, 1] `double` to a [0, 1] `double`
+ * @param  b      Function to manipulate the blue colour curve,
+ *                maps a [0, 1] `double` to a [0, 1] `double`
+ */
+template <typename T, std::uintmax_t Max, typename FR, typename FG, typename FB>
+inline void
+manipulate(const ramp_view<T, Max> &ramps, FR &&r, FG &&g, FB &&b)
+{
+	constexpr double m = ramp_view<T, Max>::max;
+	detail::map_ramp(ramps.red,   ramps.red_size,   [&](double x) { return m * r(x / m); });
+	detail::map_ramp(ramps.green, ramps.green_size, [&](double x) { return m * g(x / m); });
+	detail::map_ramp(ramps.blue,  ramps.blue_size,  [&](double x) { return m * b(x / m); });
+}
+
+/**
+ * Manipulate all colour curves using the same function on the sRGB colour space
+ *
+ * @param  ramps  The gamma ramps
+ * @param  f      Function to manipulate the colour curves,
+ *                maps a [0, 1] `double` to a [0, 1] `double`
+ */
+template <typename T, std::uintmax_t Max, typename F>
+inline void
+manipulate(const ramp_view<T, Max> &ramps, F &&f)
+{
+	manipulate(ramps, f, f, f);
+}
+
+/**
+ * Apply contrast correction on the colour curves using sRGB,
+ * see `libclut_rgb_contrast`
+ *
+ * @param  ramps  The gamma ramps
+ * @param  r      The contrast parameter for the red curve
+ * @param  g      The contrast parameter for the green curve
+ * @param  b      The contrast parameter for the blue curve
+ */
+template <typename T, std::uintmax_t Max>
+inline void
+rgb_contrast(const ramp_view<T, Max> &ramps, double r, double g, double b)
+{
+	constexpr double h = ramp_view<T, Max>::max / 2;
+	if (!libclut_1__(r)) detail::map_ramp(ramps.red,   ramps.red_size,   [=](double x) { return (x - h) * r + h; });
+	if (!libclut_1__(g)) detail::map_ramp(ramps.green, ramps.green_size, [=](double x) { return (x - h) * g + h; });
+	if (!libclut_1__(b)) detail::map_ramp(ramps.blue,  ramps.blue_size,  [=](double x) { return (x - h) * b + h; });
+}
+
+/**
+ * Apply brightness correction on the colour curves using sRGB,
+ * see `libclut_rgb_brightness`
+ *
+ * @param  ramps  The gamma ramps
+ * @param  r      The brightness parameter for the red curve
+ * @param  g      The brightness parameter for the green curve
+ * @param  b      The brightness parameter for the blue curve
+ */
+template <typename T, std::uintmax_t Max>
+inline void
+rgb_brightness(const ramp_view<T, Max> &ramps, double r, double g, double b)
+{
+	if (!libclut_1__(r)) detail::map_ramp(ramps.red,   ramps.red_size,   [=](double x) { return x * r; });
+	if (!libclut_1__(g)) detail::map_ramp(ramps.green, ramps.green_size, [=](double x) { return x * g; });
+	if (!libclut_1__(b)) detail::map_ramp(ramps.blue,  ramps.blue_size,  [=](double x) { return x * b; });
+}
+
+/**
+ * Apply gamma correction on the colour curves,
+ * see `libclut_gamma`
+ *
+ * @param  ramps  The gamma ramps
+ * @param  r      The gamma parameter the red colour curve
+ * @param  g      The gamma parameter the green colour curve
+ * @param  b      The gamma parameter the blue colour curve
+ */
+template <typename T, std::uintmax_t Max>
+inline void
+gamma(const ramp_view<T, Max> &ramps, double r, double g, double b)
+{
+	constexpr double m = ramp_view<T, Max>::max;
+	if (!libclut_1__(r)) detail::map_ramp(ramps.red,   ramps.red_size,   [=](double x) { return m * std::pow(x / m, 1 / r); });
+	if (!libclut_1__(g)) detail::map_ramp(ramps.green, ramps.green_size, [=](double x) { return m * std::pow(x / m, 1 / g); });
+	if (!libclut_1__(b)) detail::map_ramp(ramps.blue,  ramps.blue_size,  [=](double x) { return m * std::pow(x / m, 1 / b); });
+}
+
+/**
+ * Invert the colour curves (negative image with gamma invertion),
+ * using sRGB, see `libclut_rgb_invert`
+ *
+ * @param  ramps  The gamma ramps
+ * @param  r      Whether to invert the red colour curve
+ * @param  g      Whether to invert the green colour curve
+ * @param  b      Whether to invert the blue colour curve
+ */
+template <typename T, std::uintmax_t Max>
+inline void
+rgb_invert(const ramp_view<T, Max> &ramps, bool r = true, bool g = true, bool b = true)
+{
+	constexpr double m = ramp_view<T, Max>::max;
+	if (r) detail::map_ramp(ramps.red,   ramps.red_size,   [](double x) { return m - x; });
+	if (g) detail::map_ramp(ramps.green, ramps.green_size, [](double x) { return m - x; });
+	if (b) detail::map_ramp(ramps.blue,  ramps.blue_size,  [](double x) { return m - x; });
+}
+
+/**
+ * Changes the blackpoint and the whitepoint, using sRGB,
+ * see `libclut_rgb_limits`
+ *
+ * @param  ramps  The gamma ramps
+ * @param  rmin   The red component value of the blackpoint
+ * @param  rmax   The red component value of the whitepoint
+ * @param  gmin   The green component value of the blackpoint
+ * @param  gmax   The green component value of the whitepoint
+ * @param  bmin   The blue component value of the blackpoint
+ * @param  bmax   The blue component value of the whitepoint
+ */
+template <typename T, std::uintmax_t Max>
+inline void
+rgb_limits(const ramp_view<T, Max> &ramps, double rmin, double rmax, double gmin, double gmax, double bmin, double bmax)
+{
+	constexpr double m = ramp_view<T, Max>::max;
+	double rd = (rmax - rmin) / m, gd = (gmax - gmin) / m, bd = (bmax - bmin) / m;
+	if (!libclut_0__(rmin) || !libclut_1__(rmax))
+		detail::map_ramp(ramps.red,   ramps.red_size,   [=](double x) { return x * rd + rmin; });
+	if (!libclut_0__(gmin) || !libclut_1__(gmax))
+		detail::map_ramp(ramps.green, ramps.green_size, [=](double x) { return x * gd + gmin; });
+	if (!libclut_0__(bmin) || !libclut_1__(bmax))
+		detail::map_ramp(ramps.blue,  ramps.blue_size,  [=](double x) { return x * bd + bmin; });
+}
+
+/**
+ * Apply an affine operation on the colour curves in one pass,
+ * see `libclut_rgb_affine`
+ *
+ * @param  ramps  The gamma ramps
+ * @param  op     The affine operation, built with `libclut_affine_brightness`,
+ *                `libclut_affine_contrast`, `libclut_affine_limits`, and
+ *                `libclut_affine_compose`
+ */
+template <typename T, std::uintmax_t Max>
+inline void
+rgb_affine(const ramp_view<T, Max> &ramps, const libclut_affine_t &op)
+{
+	double ra = op.red_factor, rb = op.red_offset;
+	double ga = op.green_factor, gb = op.green_offset;
+	double ba = op.blue_factor, bb = op.blue_offset;
+	if (!libclut_1__(ra) || !libclut_0__(rb))
+		detail::map_ramp(ramps.red,   ramps.red_size,   [=](double x) { return x * ra + rb; });
+	if (!libclut_1__(ga) || !libclut_0__(gb))
+		detail::map_ramp(ramps.green, ramps.green_size, [=](double x) { return x * ga + gb; });
+	if (!libclut_1__(ba) || !libclut_0__(bb))
+		detail::map_ramp(ramps.blue,  ramps.blue_size,  [=](double x) { return x * ba + bb; });
+}
+
+/**
+ * Resets colour curvers to linear mappings,
+ * see `libclut_start_over`
+ *
+ * @param  ramps  The gamma ramps
+ * @param  r      Whether to reset the red colour curve
+ * @param  g      Whether to reset the green colour curve
+ * @param  b      Whether to reset the blue colour curve
+ */
+template <typename T, std::uintmax_t Max>
+inline void
+start_over(const ramp_view<T, Max> &ramps, bool r = true, bool g = true, bool b = true)
+{
+	constexpr double m = ramp_view<T, Max>::max;
+	std::size_t i;
+	double n;
+	if (r)
+		for (i = 0, n = (double)(ramps.red_size - 1); i < ramps.red_size; i++)
+			ramps.red[i] = static_cast<T>((double)i / n * m);
+	if (g)
+		for (i = 0, n = (double)(ramps.green_size - 1); i < ramps.green_size; i++)
+			ramps.green[i] = static_cast<T>((double)i / n * m);
+	if (b)
+		for (i = 0, n = (double)(ramps.blue_size - 1); i < ramps.blue_size; i++)
+			ramps.blue[i] = static_cast<T>((double)i / n * m);
+}
+
+/**
+ * Clip colour curves to only map to values between
+ * 0 and the maximum, see `libclut_clip`
+ *
+ * @param  ramps  The gamma ramps
+ * @param  r      Whether to clip the red colour curve
+ * @param  g      Whether to clip the green colour curve
+ * @param  b      Whether to clip the blue colour curve
+ */
+template <typename T, std::uintmax_t Max>
+inline void
+clip(const ramp_view<T, Max> &ramps, bool r = true, bool g = true, bool b = true)
+{
+	constexpr double m = ramp_view<T, Max>::max;
+	auto f = [](double x) { return x < 0 ? 0 : x > m ? m : x; };
+	if (r) detail::map_ramp(ramps.red,   ramps.red_size,   f);
+	if (g) detail::map_ramp(ramps.green, ramps.green_size, f);
+	if (b) detail::map_ramp(ramps.blue,  ramps.blue_size,  f);
+}
+
+
+/**
+ * Colour space conversion matrix that, unlike
+ * `libclut_colour_space_conversion_matrix_t`,
+ * can be returned from functions and be `constexpr`
+ */
+struct matrix
+{
+	/**
+	 * The elements, by row
+	 */
+	double m[3][3];
+
+	/**
+	 * Get a row
+	 *
+	 * @param   i  The index of the row
+	 * @return     The row
+	 */
+	constexpr const double *operator[](std::size_t i) const noexcept { return m[i]; }
+
+	/**
+	 * Get a row
+	 *
+	 * @param   i  The index of the row
+	 * @return     The row
+	 */
+	constexpr double *operator[](std::size_t i) noexcept { return m[i]; }
+
+	/**
+	 * Copy the matrix into a matrix usable by the C API
+	 *
+	 * @param  out  Output parameter for the matrix
+	 */
+	void
+	copy_to(libclut_colour_space_conversion_matrix_t out) const noexcept
+	{
+		for (std::size_t i = 0; i < 3; i++)
+			for (std::size_t j = 0; j < 3; j++)
+				out[i][j] = m[i][j];
+	}
+};
+
+/**
+ * Multiply two matrices
+ *
+ * @param   a  The left-hand matrix
+ * @param   b  The right-hand matrix
+ * @return     The product
+ */
+constexpr matrix
+multiply(const matrix &a, const matrix &b) noexcept
+{
+	matrix r = {};
+	for (std::size_t i = 0; i < 3; i++)
+		for (std::size_t j = 0; j < 3; j++)
+			r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j];
+	return r;
+}
+
+/**
+ * Invert a matrix, using its adjugate and determinant
+ *
+ * @param   a  The matrix
+ * @return     The inverse of `a`
+ *
+ * @throws  std::domain_error  The matrix is not invertible; when
+ *                             evaluated at compile-time, this
+ *                             is a compilation error
+ */
+constexpr matrix
+invert(const matrix &a)
+{
+	double c00 = a.m[1][1] * a.m[2][2] - a.m[1][2] * a.m[2][1];
+	double c01 = a.m[1][2] * a.m[2][0] - a.m[1][0] * a.m[2][2];
+	double c02 = a.m[1][0] * a.m[2][1] - a.m[1][1] * a.m[2][0];
+	double det = a.m[0][0] * c00 + a.m[0][1] * c01 + a.m[0][2] * c02;
+	matrix r = {};
+	if (!(det < 0) && !(det > 0))
+		throw std::domain_error("libclut::invert: matrix is not invertible");
+	r.m[0][0] = c00 / det;
+	r.m[1][0] = c01 / det;
+	r.m[2][0] = c02 / det;
+	r.m[0][1] = (a.m[0][2] * a.m[2][1] - a.m[0][1] * a.m[2][2]) / det;
+	r.m[1][1] = (a.m[0][0] * a.m[2][2] - a.m[0][2] * a.m[2][0]) / det;
+	r.m[2][1] = (a.m[0][1] * a.m[2][0] - a.m[0][0] * a.m[2][1]) / det;
+	r.m[0][2] = (a.m[0][1] * a.m[1][2] - a.m[0][2] * a.m[1][1]) / det;
+	r.m[1][2] = (a.m[0][2] * a.m[1][0] - a.m[0][0] * a.m[1][2]) / det;
+	r.m[2][2] = (a.m[0][0] * a.m[1][1] - a.m[0][1] * a.m[1][0]) / det;
+	return r;
+}
+
+/**
+ * Get the condition number of a matrix, see `libclut_model_invert_matrix`
+ *
+ * @param   a  The matrix
+ * @return     The condition number of `a`, in the maximum absolute row sum norm
+ *
+ * @throws  std::domain_error  The matrix is not invertible
+ */
+constexpr double
+condition_number(const matrix &a)
+{
+	matrix ainv = invert(a);
+	double n = 0, ninv = 0;
+	for (std::size_t i = 0; i < 3; i++) {
+		double t = 0, tinv = 0;
+		for (std::size_t j = 0; j < 3; j++) {
+			t += a.m[i][j] < 0 ? -a.m[i][j] : a.m[i][j];
+			tinv += ainv.m[i][j] < 0 ? -ainv.m[i][j] : ainv.m[i][j];
+		}
+		n = t > n ? t : n;
+		ninv = tinv > ninv ? tinv : ninv;
+	}
+	return n * ninv;
+}
+
+/**
+ * Create an RGB to CIE XYZ conversion matrix
+ *
+ * @param   cs  The colour space
+ * @return      The conversion matrix
+ *
+ * @throws  std::domain_error  The colour space cannot be used
+ */
+constexpr matrix
+rgb_to_ciexyz_matrix(const libclut_rgb_colour_space_t &cs)
+{
+	double wy = cs.white_Y;
+	double Xw = (!(wy < 0) && !(wy > 0)) ? wy : cs.white_x * wy / cs.white_y;
+	double Zw = (!(wy < 0) && !(wy > 0)) ? wy : (1 - cs.white_x - cs.white_y) * wy / cs.white_y;
+	matrix P = {{{cs.red_x / cs.red_y, cs.green_x / cs.green_y, cs.blue_x / cs.blue_y},
+	             {1, 1, 1},
+	             {(1 - cs.red_x - cs.red_y) / cs.red_y,
+	              (1 - cs.green_x - cs.green_y) / cs.green_y,
+	              (1 - cs.blue_x - cs.blue_y) / cs.blue_y}}};
+	matrix Pinv = invert(P);
+	double S[3] = {0, 0, 0};
+	for (std::size_t i = 0; i < 3; i++)
+		S[i] = Pinv.m[i][0] * Xw + Pinv.m[i][1] * wy + Pinv.m[i][2] * Zw;
+	for (std::size_t i = 0; i < 3; i++)
+		for (std::size_t j = 0; j < 3; j++)
+			P.m[i][j] *= S[j];
+	return P;
+}
+
+/**
+ * Create a matrix for converting values between
+ * two RGB colour spaces, see
+ * `libclut_model_get_rgb_conversion_matrix`
+ *
+ * When evaluated in a constant expression, the matrix
+ * is computed at compile-time
+ *
+ * @param   from  The input colour space, `nullptr` for CIE XYZ
+ * @param   to    The output colour space, `nullptr` for CIE XYZ
+ * @return        Matrix for conversion from `from` to `to`
+ *
+ * @throws  std::domain_error  A colour space cannot be used
+ */
+constexpr matrix
+get_rgb_conversion_matrix(const libclut_rgb_colour_space_t *from, const libclut_rgb_colour_space_t *to)
+{
+	matrix identity = {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}};
+	matrix A = from ? rgb_to_ciexyz_matrix(*from) : identity;
+	return to ? multiply(invert(rgb_to_ciexyz_matrix(*to)), A) : A;
+}
+
+/**
+ * Create a matrix for converting values between two RGB
+ * colour spaces, with chromatic adaptation, see
+ * `libclut_model_get_adapted_rgb_conversion_matrix`
+ *
+ * When evaluated in a constant expression, the matrix
+ * is computed at compile-time
+ *
+ * @param   from  The input colour space, `nullptr` for CIE XYZ
+ * @param   to    The output colour space, `nullptr` for CIE XYZ
+ * @param   cat   The chromatic adaptation transform
+ * @return        Matrix for conversion from `from` to `to`
+ *
+ * @throws  std::domain_error  A colour space or `cat` cannot be used
+ */
+constexpr matrix
+get_adapted_rgb_conversion_matrix(const libclut_rgb_colour_space_t *from, const libclut_rgb_colour_space_t *to,
+                                  libclut_chromatic_adaptation_t cat)
+{
+	matrix cones = {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}};
+	double f[3] = {0, 0, 0}, t[3] = {0, 0, 0};
+	double fX = 0, fZ = 0, tX = 0, tZ = 0;
+	matrix D = {};
+	if (cat == LIBCLUT_ADAPTATION_NONE || !from || !to)
+		return get_rgb_conversion_matrix(from, to);
+	if (cat == LIBCLUT_ADAPTATION_VON_KRIES)
+		cones = {{{0.40024, 0.70760, -0.08081}, {-0.22630, 1.16532, 0.04570}, {0, 0, 0.91822}}};
+	else if (cat == LIBCLUT_ADAPTATION_BRADFORD)
+		cones = {{{0.8951, 0.2664, -0.1614}, {-0.7502, 1.7135, 0.0367}, {0.0389, -0.0685, 1.0296}}};
+	else if (cat == LIBCLUT_ADAPTATION_CAT02)
+		cones = {{{0.7328, 0.4296, -0.1624}, {-0.7036, 1.6975, 0.0061}, {0.0030, 0.0136, 0.9834}}};
+	else if (cat != LIBCLUT_ADAPTATION_XYZ_SCALING)
+		throw std::domain_error("libclut::get_adapted_rgb_conversion_matrix: invalid chromatic adaptation");
+	fX = from->white_x * from->white_Y / from->white_y;
+	fZ = (1 - from->white_x - from->white_y) * from->white_Y / from->white_y;
+	tX = to->white_x * to->white_Y / to->white_y;
+	tZ = (1 - to->white_x - to->white_y) * to->white_Y / to->white_y;
+	for (std::size_t i = 0; i < 3; i++) {
+		f[i] = cones.m[i][0] * fX + cones.m[i][1] * from->white_Y + cones.m[i][2] * fZ;
+		t[i] = cones.m[i][0] * tX + cones.m[i][1] * to->white_Y + cones.m[i][2] * tZ;
+		D.m[i][i] = t[i] / f[i];
+	}
+	return multiply(invert(rgb_to_ciexyz_matrix(*to)),
+	                multiply(multiply(invert(cones), multiply(D, cones)), rgb_to_ciexyz_matrix(*from)));
+}
+
+
+#if __cplusplus >= 202002L
+/**
+ * `constexpr` copies of the `LIBCLUT_RGB_COLOUR_SPACE_*_INITIALISER`
+ * colour spaces, for use with `get_rgb_conversion_matrix`
+ *
+ * Requires C++20
+ */
+namespace colour_spaces
+{
+	inline constexpr libclut_rgb_colour_space_t srgb                  = LIBCLUT_RGB_COLOUR_SPACE_SRGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t adobe_rgb             = LIBCLUT_RGB_COLOUR_SPACE_ADOBE_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t apple_rgb             = LIBCLUT_RGB_COLOUR_SPACE_APPLE_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t best_rgb              = LIBCLUT_RGB_COLOUR_SPACE_BEST_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t beta_rgb              = LIBCLUT_RGB_COLOUR_SPACE_BETA_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t bruce_rgb             = LIBCLUT_RGB_COLOUR_SPACE_BRUCE_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t cie_rgb               = LIBCLUT_RGB_COLOUR_SPACE_CIE_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t colormatch_rgb        = LIBCLUT_RGB_COLOUR_SPACE_COLORMATCH_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t dci_p3_d65            = LIBCLUT_RGB_COLOUR_SPACE_DCI_P3_D65_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t dci_p3_theater        = LIBCLUT_RGB_COLOUR_SPACE_DCI_P3_THEATER_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t don_rgb_4             = LIBCLUT_RGB_COLOUR_SPACE_DON_RGB_4_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t eci_rgb_v2            = LIBCLUT_RGB_COLOUR_SPACE_ECI_RGB_V2_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t ekta_space_ps5        = LIBCLUT_RGB_COLOUR_SPACE_EKTA_SPACE_PS5_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t itu_r_bt_601_625_line = LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_601_625_LINE_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t itu_r_bt_601_525_line = LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_601_525_LINE_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t itu_r_bt_709          = LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_709_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t itu_r_bt_2020         = LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_2020_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t itu_r_bt_2100         = LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_2100_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t lightroom_rgb         = LIBCLUT_RGB_COLOUR_SPACE_LIGHTROOM_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t ntsc_rgb              = LIBCLUT_RGB_COLOUR_SPACE_NTSC_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t pal_secam_rgb         = LIBCLUT_RGB_COLOUR_SPACE_PAL_SECAM_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t prophoto_rgb          = LIBCLUT_RGB_COLOUR_SPACE_PROPHOTO_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t smpte_c_rgb           = LIBCLUT_RGB_COLOUR_SPACE_SMPTE_C_RGB_INITIALISER;
+	inline constexpr libclut_rgb_colour_space_t wide_gamut_rgb        = LIBCLUT_RGB_COLOUR_SPACE_WIDE_GAMUT_RGB_INITIALISER;
+}
+#endif
+
+}
+
+#endif
@@ -0,0 +1,177 @@
+/* See LICENSE file for copyright and license details. */
+#include "libclut.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+
+struct clut {
+	std::size_t red_size;
+	std::size_t green_size;
+	std::size_t blue_size;
+	std::uint16_t *red;
+	std::uint16_t *green;
+	std::uint16_t *blue;
+};
+
+
+/* The initialisers in <libclut.h> use designated initialisers, which C++14 does not have */
+
+static constexpr libclut_rgb_colour_space_t srgb = {
+	0.6400, 0.3300, 0.212656,
+	0.3000, 0.6000, 0.715158,
+	0.1500, 0.0600, 0.072186,
+	0.31271, 0.32902, 1,
+	{LIBCLUT_TRANSFER_SRGB, 0}};
+
+static constexpr libclut_rgb_colour_space_t prophoto = {
+	0.7347, 0.2653, 0.288040,
+	0.1596, 0.8404, 0.711874,
+	0.0366, 0.0001, 0.000086,
+	0.34567, 0.35850, 1,
+	{LIBCLUT_TRANSFER_GAMMA, 1.8}};
+
+static constexpr libclut::matrix identity = {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}};
+
+static constexpr libclut::matrix tridiagonal = {{{2, 1, 0}, {1, 3, 1}, {0, 1, 4}}};
+
+
+/**
+ * Check whether two matrices are equal within a tolerance
+ *
+ * @param   a    One of the matrices
+ * @param   b    The other matrix
+ * @param   tol  The greatest allowed difference between two elements
+ * @return       Whether the matrices are equal within `tol`
+ */
+static constexpr bool
+matrix_near(const libclut::matrix &a, const libclut::matrix &b, double tol)
+{
+	for (std::size_t i = 0; i < 3; i++)
+		for (std::size_t j = 0; j < 3; j++)
+			if (a.m[i][j] - b.m[i][j] > tol || b.m[i][j] - a.m[i][j] > tol)
+				return false;
+	return true;
+}
+
+/**
+ * Check whether a matrix maps (1, 1, 1) to (1, 1, 1), that is,
+ * whether it maps the white point of one RGB colour space to
+ * the white point of another
+ *
+ * @param   a    The matrix
+ * @param   tol  The greatest allowed error
+ * @return       Whether `a` maps white to white within `tol`
+ */
+static constexpr bool
+preserves_white(const libclut::matrix &a, double tol)
+{
+	for (std::size_t i = 0; i < 3; i++) {
+		double s = a.m[i][0] + a.m[i][1] + a.m[i][2];
+		if (s - 1 > tol || 1 - s > tol)
+			return false;
+	}
+	return true;
+}
+
+
+static_assert(libclut::ramp_view<std::uint8_t>::max == 255, "ramp_view<uint8_t>::max is wrong");
+static_assert(libclut::ramp_view<std::uint16_t>::max == 65535, "ramp_view<uint16_t>::max is wrong");
+static_assert(libclut::ramp_view<float>::max == 1, "ramp_view<float>::max is wrong");
+static_assert(libclut::ramp_view<std::uint16_t, 1023>::max == 1023, "ramp_view<uint16_t, 1023>::max is wrong");
+
+static_assert(matrix_near(libclut::multiply(identity, tridiagonal), tridiagonal, 0), "libclut::multiply failed");
+static_assert(matrix_near(libclut::multiply(tridiagonal, libclut::invert(tridiagonal)), identity, 1e-12),
+              "libclut::invert failed");
+static_assert(libclut::condition_number(identity) == 1, "libclut::condition_number failed");
+static_assert(libclut::condition_number(tridiagonal) > 1, "libclut::condition_number failed");
+
+static_assert(matrix_near(libclut::get_rgb_conversion_matrix(&srgb, &srgb), identity, 1e-12),
+              "libclut::get_rgb_conversion_matrix failed");
+static_assert(!preserves_white(libclut::get_rgb_conversion_matrix(&srgb, &prophoto), 1e-3),
+              "libclut::get_rgb_conversion_matrix failed");
+static_assert(preserves_white(libclut::get_adapted_rgb_conversion_matrix(&srgb, &prophoto, LIBCLUT_ADAPTATION_BRADFORD), 1e-9),
+              "libclut::get_adapted_rgb_conversion_matrix failed");
+static_assert(preserves_white(libclut::get_adapted_rgb_conversion_matrix(&srgb, &prophoto, LIBCLUT_ADAPTATION_CAT02), 1e-9),
+              "libclut::get_adapted_rgb_conversion_matrix failed");
+
+
+int
+main()
+{
+	constexpr libclut::matrix M = libclut::get_rgb_conversion_matrix(&srgb, &prophoto);
+	constexpr libclut::matrix A = libclut::get_adapted_rgb_conversion_matrix(&srgb, &prophoto, LIBCLUT_ADAPTATION_BRADFORD);
+	static std::uint16_t r1[256], g1[256], b1[256], r2[256], g2[256], b2[256], r3[256], g3[256], b3[256];
+	clut t1 = {256, 256, 256, r1, g1, b1}, t2 = {256, 256, 256, r2, g2, b2};
+	libclut::ramp_view<std::uint16_t> v1(t1), v2(t2);
+	libclut::ramp_view<std::uint16_t> v3(r3, 256, g3, 256, b3, 256);
+	libclut_colour_space_conversion_matrix_t C, Cinv;
+	libclut::matrix D = {};
+	libclut_affine_t op = LIBCLUT_AFFINE_IDENTITY_INITIALISER;
+	double cond = 0;
+	int rc = 0;
+
+	if (v1.red != r1 || v1.green != g1 || v1.blue != b1 ||
+	    v1.red_size != 256 || v1.green_size != 256 || v1.blue_size != 256)
+		std::printf("libclut::ramp_view failed\n"), rc = 1;
+
+	libclut::start_over(v1);
+	libclut_start_over(&t2, UINT16_MAX, std::uint16_t, 1, 1, 1);
+	if (std::memcmp(r1, r2, sizeof(r1)) || std::memcmp(g1, g2, sizeof(g1)) || std::memcmp(b1, b2, sizeof(b1)))
+		std::printf("libclut::start_over failed\n"), rc = 1;
+
+	libclut_start_over(&v3, UINT16_MAX, std::uint16_t, 1, 1, 1);
+	libclut::rgb_invert(v3);
+	libclut::rgb_invert(v3);
+	if (std::memcmp(r1, r3, sizeof(r1)) || std::memcmp(g1, g3, sizeof(g1)) || std::memcmp(b1, b3, sizeof(b1)))
+		std::printf("libclut::rgb_invert failed\n"), rc = 1;
+
+	libclut_affine_brightness(&op, 0.8, 0.9, 1.0);
+	libclut_affine_contrast(&op, UINT16_MAX, 0.9, 1.0, 0.7);
+	libclut::rgb_affine(v1, op);
+	libclut_rgb_affine(&v2, UINT16_MAX, std::uint16_t, &op);
+	if (std::memcmp(r1, r2, sizeof(r1)) || std::memcmp(g1, g2, sizeof(g1)) || std::memcmp(b1, b2, sizeof(b1)) ||
+	    !std::memcmp(r1, r3, sizeof(r1)))
+		std::printf("libclut::rgb_affine failed\n"), rc = 1;
+
+	if (libclut_model_get_rgb_conversion_matrix(&srgb, &prophoto, C, NULL)) {
+		std::printf("libclut_model_get_rgb_conversion_matrix failed\n"), rc = 1;
+	} else {
+		std::memcpy(D.m, C, sizeof(C));
+		if (!matrix_near(M, D, 1e-9))
+			std::printf("libclut::get_rgb_conversion_matrix failed\n"), rc = 1;
+	}
+
+	if (libclut_model_get_adapted_rgb_conversion_matrix(&srgb, &prophoto, LIBCLUT_ADAPTATION_BRADFORD, C, NULL) ||
+	    libclut_model_invert_matrix(C, Cinv, &cond)) {
+		std::printf("libclut_model_get_adapted_rgb_conversion_matrix failed\n"), rc = 1;
+	} else {
+		std::memcpy(D.m, C, sizeof(C));
+		if (!matrix_near(A, D, 1e-9))
+			std::printf("libclut::get_adapted_rgb_conversion_matrix failed\n"), rc = 1;
+		std::memcpy(D.m, Cinv, sizeof(Cinv));
+		if (!matrix_near(libclut::invert(A), D, 1e-9))
+			std::printf("libclut::invert failed\n"), rc = 1;
+		if (libclut::condition_number(A) < cond * (1 - 1e-9) || libclut::condition_number(A) > cond * (1 + 1e-9))
+			std::printf("libclut::condition_number failed\n"), rc = 1;
+	}
+
+	D = {};
+	try {
+		libclut::invert(D);
+		std::printf("libclut::invert failed\n"), rc = 1;
+	} catch (const std::domain_error &) {
+	}
+	try {
+		libclut::get_adapted_rgb_conversion_matrix(&srgb, &prophoto, (libclut_chromatic_adaptation_t)100);
+		std::printf("libclut::get_adapted_rgb_conversion_matrix failed\n"), rc = 1;
+	} catch (const std::domain_error &) {
+	}
+
+	if (!rc)
+		std::printf("everything is fine\n");
+	return rc;
+}
@@ -22,6 +22,15 @@ struct clut {
 	uint16_t *blue;
 };
 
+struct clut8 {
+	size_t red_size;
+	size_t green_size;
+	size_t blue_size;
+	uint8_t *red;
+	uint8_t *green;
+	uint8_t *blue;
+};
+
 struct dclut {
 	size_t red_size;
 	size_t green_size;
@@ -31,6 +40,16 @@ struct dclut {
 	double *blue;
 };
 
+struct lut3d {
+	size_t size;
+	double *data;
+};
+
+struct clut3d {
+	size_t size;
+	uint16_t *data;
+};
+
 static int
 clutcmp(const struct clut *a, const struct clut *b, uint16_t tol)
 {
@@ -97,12 +116,108 @@ dumpdcluts(const struct dclut *a, const struct dclut *b, double tol)
 	}
 }
 
+static void
+tetrahedral(const struct lut3d *lut, double r, double g, double b, double out[3])
+{
+	size_t n = lut->size - 1, i0, j0, k0, i1, j1, k1, c;
+	double fr, fg, fb;
+	const double *c000, *c100, *c010, *c001, *c110, *c101, *c011, *c111;
+	r *= (double)n, g *= (double)n, b *= (double)n;
+	i0 = (size_t)r < n ? (size_t)r : n - 1, fr = r - (double)i0, i1 = i0 + 1;
+	j0 = (size_t)g < n ? (size_t)g : n - 1, fg = g - (double)j0, j1 = j0 + 1;
+	k0 = (size_t)b < n ? (size_t)b : n - 1, fb = b - (double)k0, k1 = k0 + 1;
+	c000 = &lut->data[libclut_3d_index(lut, i0, j0, k0)];
+	c100 = &lut->data[libclut_3d_index(lut, i1, j0, k0)];
+	c010 = &lut->data[libclut_3d_index(lut, i0, j1, k0)];
+	c001 = &lut->data[libclut_3d_index(lut, i0, j0, k1)];
+	c110 = &lut->data[libclut_3d_index(lut, i1, j1, k0)];
+	c101 = &lut->data[libclut_3d_index(lut, i1, j0, k1)];
+	c011 = &lut->data[libclut_3d_index(lut, i0, j1, k1)];
+	c111 = &lut->data[libclut_3d_index(lut, i1, j1, k1)];
+	for (c = 0; c < 3; c++) {
+		if (fr >= fg && fg >= fb)
+			out[c] = (1 - fr) * c000[c] + (fr - fg) * c100[c] + (fg - fb) * c110[c] + fb * c111[c];
+		else if (fr >= fb && fb >= fg)
+			out[c] = (1 - fr) * c000[c] + (fr - fb) * c100[c] + (fb - fg) * c101[c] + fg * c111[c];
+		else if (fb >= fr && fr >= fg)
+			out[c] = (1 - fb) * c000[c] + (fb - fr) * c001[c] + (fr - fg) * c101[c] + fg * c111[c];
+		else if (fg >= fr && fr >= fb)
+			out[c] = (1 - fg) * c000[c] + (fg - fr) * c010[c] + (fr - fb) * c110[c] + fb * c111[c];
+		else if (fg >= fb && fb >= fr)
+			out[c] = (1 - fg) * c000[c] + (fg - fb) * c010[c] + (fb - fr) * c011[c] + fr * c111[c];
+		else
+			out[c] = (1 - fb) * c000[c] + (fb - fg) * c001[c] + (fg - fr) * c011[c] + fr * c111[c];
+	}
+}
+
 static double
 make_double(double x)
 {
 	return x * 2;
 }
 
+static void
+put32(unsigned char *p, uint32_t v)
+{
+	p[0] = (unsigned char)(v >> 24);
+	p[1] = (unsigned char)(v >> 16);
+	p[2] = (unsigned char)(v >> 8);
+	p[3] = (unsigned char)(v >> 0);
+}
+
+static void
+put_icc_tag(unsigned char *icc, size_t i, const char *sig, uint32_t offset, uint32_t size)
+{
+	memcpy(&icc[132 + 12 * i], sig, 4);
+	put32(&icc[132 + 12 * i + 4], offset);
+	put32(&icc[132 + 12 * i + 8], size);
+}
+
+static void
+put_icc_xyz(unsigned char *icc, uint32_t offset, double x, double y, double z)
+{
+	memcpy(&icc[offset], "XYZ ", 4);
+	put32(&icc[offset + 8], (uint32_t)(int32_t)(x * 65536));
+	put32(&icc[offset + 12], (uint32_t)(int32_t)(y * 65536));
+	put32(&icc[offset + 16], (uint32_t)(int32_t)(z * 65536));
+}
+
+static size_t square_calls = 0;
+
+static double
+square(double x)
+{
+	square_calls += 1;
+	return x * x;
+}
+
+static void
+square_batch(const double *in, double *out, size_t n, void *user)
+{
+	*(size_t *)user += 1;
+	while (n--)
+		*out++ = *in * *in, in++;
+}
+
+static const char cube_text[] =
+	"# Comment\r\n"
+	"TITLE \"Test\"\r\n"
+	"DOMAIN_MIN 0 0 0\n"
+	"DOMAIN_MAX 0.5 1 1.0e0\n"
+	"LUT_1D_SIZE 3\n"
+	"\n"
+	"0 1 0\n"
+	"  .5 0.5 5E-1  # Middle\n"
+	"1 0 1";
+
+static void
+swap_red_blue(double r, double g, double b, double *rp, double *gp, double *bp)
+{
+	*rp = b;
+	*gp = g;
+	*bp = r;
+}
+
 
 /**
  * Test libclut
@@ -120,9 +235,37 @@ main(int argc, char *argv[])
 	libclut_colour_space_conversion_matrix_t M, Minv;
 	libclut_rgb_colour_space_t srgb  = LIBCLUT_RGB_COLOUR_SPACE_SRGB_INITIALISER;
 	libclut_rgb_colour_space_t wgrgb = LIBCLUT_RGB_COLOUR_SPACE_WIDE_GAMUT_RGB_INITIALISER;
-	struct clut t1, t2, t3;
+	libclut_rgb_colour_space_t prophoto = LIBCLUT_RGB_COLOUR_SPACE_PROPHOTO_RGB_INITIALISER;
+	libclut_colour_space_conversion_matrix_t P;
+	libclut_affine_t aff = LIBCLUT_AFFINE_IDENTITY_INITIALISER, aff2 = LIBCLUT_AFFINE_IDENTITY_INITIALISER;
+	libclut_ramps_t stages[3];
+	libclut_rgb_colour_space_t bt2100 = LIBCLUT_RGB_COLOUR_SPACE_ITU_R_BT_2100_INITIALISER;
+	libclut_transfer_function_t tfs[] = {
+		{LIBCLUT_TRANSFER_SRGB, 0}, {LIBCLUT_TRANSFER_LINEAR, 0}, {LIBCLUT_TRANSFER_GAMMA, 2.2},
+		{LIBCLUT_TRANSFER_BT_709, 0}, {LIBCLUT_TRANSFER_PQ, 0}, {LIBCLUT_TRANSFER_HLG, 0},
+		{LIBCLUT_TRANSFER_L_STAR, 0}};
+	libclut_transfer_table_t tt, tt2;
+	struct clut t1, t2, t3, t4;
 	struct dclut d1, d2;
-	size_t i, j;
+	struct clut8 e1, e2;
+	struct lut3d l1, l2;
+	struct clut3d c1;
+	uint8_t p8[64 * 4], q8[64 * 4];
+	uint32_t p32[64];
+	float img[2 * 320 * 4], img2[2 * 320 * 4];
+	libclut_mapped_ramps_t mapping;
+	unsigned char icc[1928], *tmp;
+	libclut_icc_t iccp;
+	libclut_cube_t cube;
+	libclut_cache_t cache;
+	uint64_t h1, h2, op1, op2;
+	double params[3];
+	double (*nofunc)(double) = NULL;
+	FILE *f;
+	float pf[17 * 3];
+	double xyz[3 * 1000], lab[3 * 1000];
+	libclut_white_point_t d65 = {LIBCLUT_ILLUMINANT_D65}, d50 = {LIBCLUT_ILLUMINANT_D50};
+	size_t i, j, k;
 	int rc = 0;
 	double param, r, g, b, x, y, z;
 
@@ -134,6 +277,10 @@ main(int argc, char *argv[])
 	if (!(t3.red = malloc(3 * 256 * sizeof(uint16_t))))  goto fail;
 	if (!(d1.red = malloc(3 * 256 * sizeof(double))))  goto fail;
 	if (!(d2.red = malloc(3 * 256 * sizeof(double))))  goto fail;
+	l1.size = l2.size = c1.size = 17;
+	if (!(l1.data = malloc(3 * 17 * 17 * 17 * sizeof(double))))  goto fail;
+	if (!(l2.data = malloc(3 * 17 * 17 * 17 * sizeof(double))))  goto fail;
+	if (!(c1.data = malloc(3 * 17 * 17 * 17 * sizeof(uint16_t))))  goto fail;
 	t1.blue = (t1.green = t1.red + 256) + 256;
 	t2.blue = (t2.green = t2.red + 256) + 256;
 	t3.blue = (t3.green = t3.red + 256) + 256;
@@ -196,6 +343,28 @@ main(int argc, char *argv[])
 	if (clutcmp(&t1, &t2, 0))
 		printf("libclut_gamma failed\n"), rc = 1;
 
+	for (i = 0; i < 256; i++) {
+		t1.blue[i] = t1.green[i] = t1.red[i] = (uint16_t)((i << 8) | i);
+		t2.blue[i] = t2.green[i] = t2.red[i] = (uint16_t)((i << 8) | i);
+	}
+	libclut_gamma(&t1, UINT16_MAX, uint16_t, TENTHS(11), TENTHS(22), TENTHS(5));
+	libclut_gamma_fast(&t2, UINT16_MAX, uint16_t, TENTHS(11), TENTHS(22), TENTHS(5));
+	if (clutcmp(&t1, &t2, 1))
+		printf("libclut_gamma_fast failed\n"), rc = 1;
+
+#if defined(libclut_generic)
+	for (i = 0; i < 256; i++) {
+		t1.blue[i] = t1.green[i] = t1.red[i] = (uint16_t)((i << 8) | i);
+		t2.blue[i] = t2.green[i] = t2.red[i] = (uint16_t)((i << 8) | i);
+	}
+	libclut_gamma(&t1, UINT16_MAX, uint16_t, TENTHS(11), TENTHS(22), TENTHS(5));
+	libclut_generic(libclut_gamma, &t2, TENTHS(11), TENTHS(22), TENTHS(5));
+	if (clutcmp(&t1, &t2, 0))
+		printf("libclut_generic failed\n"), rc = 1;
+	if (LIBCLUT_MAX(&t1) != UINT16_MAX || LIBCLUT_MAX(&d1) != 1 || sizeof(LIBCLUT_TYPE(&t1)) != sizeof(uint16_t))
+		printf("LIBCLUT_MAX or LIBCLUT_TYPE failed\n"), rc = 1;
+#endif
+
 	for (i = 0; i < 256; i++) {
 		t1.blue[i] = t1.green[i] = t1.red[i] = (uint16_t)((i << 8) | i);
 		t2.blue[i] = t2.green[i] = t2.red[i] = (uint16_t)((t1.red[i] - UINT16_MAX / 2) / 2 + UINT16_MAX / 2);
@@ -204,6 +373,180 @@ main(int argc, char *argv[])
 	if (clutcmp(&t1, &t2, 1))
 		printf("libclut_rgb_contrast failed\n"), rc = 1;
 
+	for (i = 0; i < 256; i++) {
+		t1.blue[i] = t1.green[i] = t1.red[i] = (uint16_t)((i << 8) | i);
+		t2.blue[i] = t2.green[i] = t2.red[i] = (uint16_t)((i << 8) | i);
+	}
+	libclut_rgb_brightness(&t1, UINT16_MAX, uint16_t, TENTHS(7), HALF, TENTHS(9));
+	libclut_rgb_brightness_fixed(&t2, UINT16_MAX, uint16_t, TENTHS(7), HALF, TENTHS(9));
+	if (clutcmp(&t1, &t2, 1))
+		printf("libclut_rgb_brightness_fixed failed\n"), rc = 1;
+	memcpy(t2.red, t1.red, 3 * 256 * sizeof(uint16_t));
+	libclut_rgb_contrast(&t1, UINT16_MAX, uint16_t, HALF, TENTHS(9), TENTHS(3));
+	libclut_rgb_contrast_fixed(&t2, UINT16_MAX, uint16_t, HALF, TENTHS(9), TENTHS(3));
+	if (clutcmp(&t1, &t2, 1))
+		printf("libclut_rgb_contrast_fixed failed\n"), rc = 1;
+	memcpy(t2.red, t1.red, 3 * 256 * sizeof(uint16_t));
+	libclut_rgb_limits(&t1, UINT16_MAX, uint16_t, 1000, 60000, 0, 50000, 20000, 40000);
+	libclut_rgb_limits_fixed(&t2, UINT16_MAX, uint16_t, 1000, 60000, 0, 50000, 20000, 40000);
+	if (clutcmp(&t1, &t2, 1))
+		printf("libclut_rgb_limits_fixed failed\n"), rc = 1;
+
+	for (i = 0; i < 256; i++) {
+		d1.blue[i] = d1.green[i] = d1.red[i] = (double)i / 255;
+		t1.blue[i] = t1.green[i] = t1.red[i] = (uint16_t)((i << 8) | i);
+	}
+	memcpy(d2.red, d1.red, 3 * 256 * sizeof(double));
+	memcpy(t2.red, t1.red, 3 * 256 * sizeof(uint16_t));
+	libclut_rgb_affine(&d2, 1, double, &aff);
+	if (dclutcmp(&d1, &d2, 0))
+		printf("libclut_rgb_affine failed\n"), rc = 1;
+	libclut_affine_brightness(&aff, TENTHS(7), HALF, TENTHS(9));
+	libclut_affine_contrast(&aff, 1, HALF, TENTHS(9), TENTHS(3));
+	libclut_affine_limits(&aff2, 1, TENTHS(1), TENTHS(9), 0, TENTHS(8), TENTHS(3), TENTHS(6));
+	libclut_affine_compose(&aff, &aff2);
+	libclut_rgb_brightness(&d1, 1, double, TENTHS(7), HALF, TENTHS(9));
+	libclut_rgb_contrast(&d1, 1, double, HALF, TENTHS(9), TENTHS(3));
+	libclut_rgb_limits(&d1, 1, double, TENTHS(1), TENTHS(9), 0, TENTHS(8), TENTHS(3), TENTHS(6));
+	libclut_rgb_affine(&d2, 1, double, &aff);
+	if (dclutcmp(&d1, &d2, 0.0000000001))
+		printf("libclut_rgb_affine failed\n"), rc = 1;
+	aff = aff2;
+	libclut_affine_compose(&aff, &aff);
+	libclut_rgb_limits(&d1, 1, double, TENTHS(1), TENTHS(9), 0, TENTHS(8), TENTHS(3), TENTHS(6));
+	libclut_rgb_limits(&d1, 1, double, TENTHS(1), TENTHS(9), 0, TENTHS(8), TENTHS(3), TENTHS(6));
+	libclut_rgb_affine(&d2, 1, double, &aff);
+	if (dclutcmp(&d1, &d2, 0.0000000001))
+		printf("libclut_affine_compose failed\n"), rc = 1;
+
+	aff = (libclut_affine_t)LIBCLUT_AFFINE_IDENTITY_INITIALISER;
+	libclut_affine_brightness(&aff, TENTHS(7), HALF, TENTHS(9));
+	libclut_affine_contrast(&aff, UINT16_MAX, HALF, TENTHS(9), TENTHS(3));
+	libclut_affine_limits(&aff, UINT16_MAX, 1000, 60000, 0, 50000, 20000, 40000);
+	libclut_rgb_affine(&t1, UINT16_MAX, uint16_t, &aff);
+	for (i = 0; i < 256; i++) {
+		x = ((double)((i << 8) | i) * TENTHS(7) - UINT16_MAX * HALF) * HALF + UINT16_MAX * HALF;
+		x = x * 59000 / UINT16_MAX + 1000;
+		if (t1.red[i] != (uint16_t)x)
+			break;
+	}
+	if (i < 256)
+		printf("libclut_rgb_affine failed\n"), rc = 1;
+	libclut_rgb_affine_fixed(&t2, UINT16_MAX, uint16_t, &aff);
+	if (clutcmp(&t1, &t2, 1))
+		printf("libclut_rgb_affine_fixed failed\n"), rc = 1;
+
+	e1.red_size = e1.green_size = e1.blue_size = e2.red_size = e2.green_size = e2.blue_size = 64;
+	e1.blue = (e1.green = (e1.red = p8) + 64) + 64;
+	e2.blue = (e2.green = (e2.red = q8) + 64) + 64;
+	for (i = 0; i < 3 * 64; i++)
+		p8[i] = q8[i] = (uint8_t)((i % 64) * 4 + (i % 64) / 16);
+	libclut_rgb_brightness(&e1, UINT8_MAX, uint8_t, TENTHS(7), HALF, TENTHS(9));
+	libclut_rgb_brightness_fixed(&e2, UINT8_MAX, uint8_t, TENTHS(7), HALF, TENTHS(9));
+	for (i = 0; i < 3 * 64; i++)
+		if (abs((int)p8[i] - (int)q8[i]) > 1)
+			break;
+	if (i < 3 * 64)
+		printf("libclut_rgb_brightness_fixed (uint8_t) failed\n"), rc = 1;
+	memcpy(q8, p8, 3 * 64);
+	libclut_rgb_contrast(&e1, UINT8_MAX, uint8_t, HALF, TENTHS(9), TENTHS(3));
+	libclut_rgb_contrast_fixed(&e2, UINT8_MAX, uint8_t, HALF, TENTHS(9), TENTHS(3));
+	for (i = 0; i < 3 * 64; i++)
+		if (abs((int)p8[i] - (int)q8[i]) > 1)
+			break;
+	if (i < 3 * 64)
+		printf("libclut_rgb_contrast_fixed (uint8_t) failed\n"), rc = 1;
+	memcpy(q8, p8, 3 * 64);
+	libclut_rgb_limits(&e1, UINT8_MAX, uint8_t, 10, 240, 0, 200, 50, 100);
+	libclut_rgb_limits_fixed(&e2, UINT8_MAX, uint8_t, 10, 240, 0, 200, 50, 100);
+	for (i = 0; i < 3 * 64; i++)
+		if (abs((int)p8[i] - (int)q8[i]) > 1)
+			break;
+	if (i < 3 * 64)
+		printf("libclut_rgb_limits_fixed (uint8_t) failed\n"), rc = 1;
+
+	libclut_start_over(&t2, UINT16_MAX, uint16_t, 1, 1, 1);
+	aff.red_factor = 40000, aff.red_offset = 0;
+	aff.green_factor = HALF, aff.green_offset = 2000000000.;
+	aff.blue_factor = 1, aff.blue_offset = -2000000000.;
+	libclut_rgb_affine_fixed(&t2, UINT16_MAX, uint16_t, &aff);
+	for (i = 0; i < 256; i++)
+		if (t2.red[i] != (i ? UINT16_MAX : 0) || t2.green[i] != UINT16_MAX || t2.blue[i] != 0)
+			break;
+	if (i < 256)
+		printf("libclut_rgb_affine_fixed (large coefficients) failed\n"), rc = 1;
+
+	for (i = 0; i < 256; i++) {
+		d1.red[i] = 1 - (double)i / 255;
+		d1.green[i] = pow((double)i / 255, 2.2);
+		d1.blue[i] = i < 100 ? (double)i / 500 : i < 150 ? 0.2 : 0.2 + (double)(i - 149) * 0.8 / 106;
+	}
+	libclut_invert_mapping(&d2, 1, double, &d1, 1, double);
+	for (i = 0; i < 256; i++) {
+		x = d2.green[i] * 255;
+		j = (size_t)x;
+		j -= j == 255;
+		x = d1.green[j] * (double)(j + 1 - x) + d1.green[j + 1] * (x - (double)j);
+		if (fabs(d2.red[i] - (1 - (double)i / 255)) > 0.000000001 || fabs(x - (double)i / 255) > 0.000000001)
+			break;
+		if (i && d2.blue[i] < d2.blue[i - 1])
+			break;
+	}
+	if (i < 256 || d2.blue[0] != 0 || fabs(d2.blue[255] - 1) > 0.000000001)
+		printf("libclut_invert_mapping failed\n"), rc = 1;
+	if (fabs(d2.blue[51] - (double)100 / 255) > 0.000000001 || d2.blue[52] <= (double)149 / 255)
+		printf("libclut_invert_mapping failed\n"), rc = 1;
+
+	for (i = 0; i < 256; i++)
+		t1.red[i] = t1.green[i] = t1.blue[i] = (uint16_t)((i << 8) | i);
+	t3.red_size = t3.green_size = t3.blue_size = 64;
+	libclut_invert_mapping(&t3, UINT16_MAX, uint16_t, &t1, UINT16_MAX, uint16_t);
+	for (i = 0; i < 64; i++)
+		if (t3.red[i] != (uint16_t)((double)i / 63 * UINT16_MAX + 0.5) || t3.blue[i] != t3.red[i])
+			break;
+	if (i < 64)
+		printf("libclut_invert_mapping failed\n"), rc = 1;
+	t3.red_size = t3.green_size = t3.blue_size = 256;
+
+	for (i = 0; i < 256; i++) {
+		d1.red[i] = pow((double)i / 255, 2.2);
+		d1.green[i] = (double)i / 255;
+		d1.blue[i] = 1 - (double)i / 255;
+		t1.red[i] = t1.green[i] = t1.blue[i] = (uint16_t)((i << 8) | i);
+	}
+	for (i = 0; i < 64; i++)
+		p32[i] = (uint32_t)(i * 68174084UL);
+	stages[0] = (libclut_ramps_t)LIBCLUT_RAMPS_INITIALISER(&d1, 1, double);
+	stages[1] = (libclut_ramps_t)LIBCLUT_RAMPS_INITIALISER(&t1, UINT16_MAX, uint16_t);
+	stages[2].type = LIBCLUT_ELEMENT_UINT32;
+	stages[2].max = 63. * 68174084;
+	stages[2].red_size = stages[2].green_size = stages[2].blue_size = 64;
+	stages[2].red = stages[2].green = stages[2].blue = p32;
+	if (libclut_compose(&t2, UINT16_MAX, uint16_t, 3, stages))
+		printf("libclut_compose failed\n"), rc = 1;
+	for (i = 0; i < 256; i++)
+		if (abs((int)t2.red[i] - (int)(pow((double)i / 255, 2.2) * UINT16_MAX + 0.5)) > 1 ||
+		    t2.green[i] != t1.green[i] || t2.blue[i] != UINT16_MAX - t1.blue[i])
+			break;
+	if (i < 256)
+		printf("libclut_compose failed\n"), rc = 1;
+	memcpy(t3.red, t2.red, 3 * 256 * sizeof(uint16_t));
+	stages[0] = (libclut_ramps_t)LIBCLUT_RAMPS_INITIALISER(&t2, UINT16_MAX, uint16_t);
+	if (libclut_compose(&t2, UINT16_MAX, uint16_t, 1, stages) || clutcmp(&t2, &t3, 0))
+		printf("libclut_compose failed\n"), rc = 1;
+	if (libclut_compose(&t2, UINT16_MAX, uint16_t, 0, stages) || clutcmp(&t1, &t2, 0))
+		printf("libclut_compose failed\n"), rc = 1;
+	stages[0].red_size = 0;
+	if (libclut_compose(&t2, UINT16_MAX, uint16_t, 1, stages) != -1)
+		printf("libclut_compose failed\n"), rc = 1;
+	stages[0].red_size = 256;
+	stages[0].max = 0;
+	if (libclut_compose(&t2, UINT16_MAX, uint16_t, 1, stages) != -1)
+		printf("libclut_compose failed\n"), rc = 1;
+	stages[0].max = NAN;
+	if (libclut_compose(&t2, UINT16_MAX, uint16_t, 1, stages) != -1)
+		printf("libclut_compose failed\n"), rc = 1;
+
 	param = 2;
 	for (i = 0; i < 256; i++) {
 		double t = (double)i / 255;
@@ -221,6 +564,22 @@ main(int argc, char *argv[])
 	if (clutcmp(&t1, &t2, 0))
 		printf("libclut_sigmoid failed\n"), rc = 1;
 
+	for (i = 0; i < 256; i++) {
+		double t = (double)i / 255;
+		if (i % 255) {
+			t = 1 / t - 1;
+			t = log(t);
+			t = HALF - t / param;
+		}
+		t1.blue[i] = t1.green[i] = t1.red[i] = (uint16_t)i;
+		t2.blue[i] = t2.green[i] = t2.red[i] = (uint16_t)(t * 255);
+	}
+	libclut_sigmoid(&t1, 255, uint16_t, &param, &param, &param);
+	t1.blue[0]   = t1.green[0]   = t1.red[0]   = t2.red[0];
+	t1.blue[255] = t1.green[255] = t1.red[255] = t2.red[255];
+	if (clutcmp(&t1, &t2, 0))
+		printf("libclut_sigmoid (tabulated) failed\n"), rc = 1;
+
 	for (i = 0; i < 256; i++) {
 		t1.blue[i] = t1.green[i] = t1.red[i] = (uint16_t)((i << 8) | i);
 		t2.blue[i] = t2.green[i] = t2.red[i] = t1.red[i & 0xF0] | (t1.red[i & 0xF0] >> 4);
@@ -250,6 +609,64 @@ main(int argc, char *argv[])
 	/* High error rate, especially at low values, are expected due
 	 * to low precision and truncated values rather rounded values. */
 
+	if (srgb.transfer.type != LIBCLUT_TRANSFER_SRGB || bt2100.transfer.type != LIBCLUT_TRANSFER_PQ ||
+	    prophoto.transfer.type != LIBCLUT_TRANSFER_GAMMA || !libclut_eq__(prophoto.transfer.gamma, 1.8))
+		printf("LIBCLUT_RGB_COLOUR_SPACE_*_INITIALISER failed\n"), rc = 1;
+	if (fabs(libclut_model_transfer_encode(&tfs[4], 0.01) - 0.5081) > 0.0001 ||
+	    fabs(libclut_model_transfer_encode(&tfs[5], 1. / 12) - 0.5) > 0.000001 ||
+	    fabs(libclut_model_transfer_encode(&tfs[3], 0.01) - 0.045) > 0.000001 ||
+	    fabs(libclut_model_transfer_encode(&tfs[6], 0.18) - 0.4950) > 0.0001 ||
+	    fabs(libclut_model_transfer_encode(&tfs[0], 0.5) - libclut_model_linear_to_standard1(0.5)) > 0.000001 ||
+	    fabs(libclut_model_transfer_decode(&tfs[2], 0.5) - pow(0.5, 2.2)) > 0.000001)
+		printf("libclut_model_transfer_encode or libclut_model_transfer_decode failed\n"), rc = 1;
+	for (j = 0; j < sizeof(tfs) / sizeof(*tfs); j++) {
+		if (libclut_model_prepare_transfer_table(&tt, &tfs[j])) {
+			printf("libclut_model_prepare_transfer_table failed\n"), rc = 1;
+			break;
+		}
+		for (i = 0; i < 1000; i++) {
+			x = (double)i / 999 * 1.5 - 0.25;
+			y = libclut_model_transfer_encode(&tfs[j], x);
+			if (fabs(libclut_model_transfer_decode(&tfs[j], y) - x) > 0.000000001 ||
+			    fabs(libclut_model_transfer_encode(&tfs[j], -x) + y) > 0.000000001) {
+				printf("libclut_model_transfer_encode or libclut_model_transfer_decode failed\n"), rc = 1;
+				break;
+			}
+			xyz[i] = x;
+		}
+		libclut_model_transfer_encode_batch(xyz, lab, 1000, &tt);
+		for (i = 0; i < 1000; i++)
+			if (fabs(lab[i] - libclut_model_transfer_encode(&tfs[j], xyz[i])) > 0.00001)
+				break;
+		if (i < 1000)
+			printf("libclut_model_transfer_encode_batch failed\n"), rc = 1;
+		libclut_model_transfer_decode_batch(xyz, xyz, 1000, &tt);
+		for (i = 0; i < 1000; i++)
+			if (fabs(xyz[i] - libclut_model_transfer_decode(&tfs[j], (double)i / 999 * 1.5 - 0.25)) > 0.00001)
+				break;
+		if (i < 1000)
+			printf("libclut_model_transfer_decode_batch failed\n"), rc = 1;
+	}
+	tfs[2].gamma = 0;
+	if (libclut_model_prepare_transfer_table(&tt, &tfs[2]) != -1)
+		printf("libclut_model_prepare_transfer_table failed\n"), rc = 1;
+	tfs[2].gamma = 2.2;
+
+	for (i = 0; i < 256; i++) {
+		d1.blue[i] = d1.green[i] = d1.red[i] = (double)i / 255;
+		d2.blue[i] = d2.green[i] = d2.red[i] = (double)i / 255;
+	}
+	libclut_model_prepare_transfer_table(&tt, &tfs[0]);
+	libclut_decode_transfer(&d1, 1, double, &tt, 1, 1, 0);
+	libclut_linearise(&d2, 1, double, 1, 1, 0);
+	if (dclutcmp(&d1, &d2, 0.00001))
+		printf("libclut_decode_transfer failed\n"), rc = 1;
+	libclut_model_prepare_transfer_table(&tt, &tfs[4]);
+	libclut_encode_transfer(&d1, 1, double, &tt, 1, 0, 1);
+	libclut_decode_transfer(&d1, 1, double, &tt, 1, 0, 1);
+	if (dclutcmp(&d1, &d2, 0.00001))
+		printf("libclut_encode_transfer failed\n"), rc = 1;
+
 	for (i = 0; i < 256; i++) {
 		d1.blue[i] = d1.green[i] = d1.red[i] = (i & 1) ? -1 : 2;
 		d2.blue[i] = d2.green[i] = d2.red[i] = (i & 1) ?  0 : 1;
@@ -268,6 +685,349 @@ main(int argc, char *argv[])
 	if (clutcmp(&t1, &t3, 0))
 		printf("libclut_apply failed\n"), rc = 1;
 
+	libclut_start_over(&t1, UINT16_MAX, uint16_t, 1, 1, 1);
+	libclut_negative(&t1, UINT16_MAX, uint16_t, 1, 0, 0);
+	for (i = 0; i < 64 * 4; i++)
+		q8[i] = p8[i] = (uint8_t)(i * 37 + (i >> 2));
+	libclut_apply_pixels(&t1, UINT16_MAX, uint16_t, LIBCLUT_PIXEL_RGBA8888, p8, 4, 16, 4 * 4);
+	for (i = 0; i < 64 * 4; i++)
+		if (p8[i] != (i % 4 ? q8[i] : 255 - q8[i]))
+			break;
+	if (i < 64 * 4)
+		printf("libclut_apply_pixels (RGBA8888) failed\n"), rc = 1;
+	memcpy(p8, q8, sizeof(p8));
+	libclut_apply_pixels(&t1, UINT16_MAX, uint16_t, LIBCLUT_PIXEL_BGRA8888, p8, 8, 8, 8 * 4);
+	for (i = 0; i < 64 * 4; i++)
+		if (p8[i] != (i % 4 != 2 ? q8[i] : 255 - q8[i]))
+			break;
+	if (i < 64 * 4)
+		printf("libclut_apply_pixels (BGRA8888) failed\n"), rc = 1;
+	for (i = 0; i < 256; i++)
+		t2.red[i] = (uint16_t)(i * 4999);
+	libclut_apply_pixels(&t1, UINT16_MAX, uint16_t, LIBCLUT_PIXEL_RGB565, t2.red, 16, 16, 16 * sizeof(uint16_t));
+	for (i = 0; i < 256; i++)
+		if (t2.red[i] != (uint16_t)((i * 4999) ^ 0xF800))
+			break;
+	if (i < 256)
+		printf("libclut_apply_pixels (RGB565) failed\n"), rc = 1;
+	for (i = 0; i < 64; i++)
+		p32[i] = (uint32_t)(i * 2654435761UL);
+	libclut_apply_pixels(&t1, UINT16_MAX, uint16_t, LIBCLUT_PIXEL_XRGB2101010, p32, 8, 8, 8 * sizeof(uint32_t));
+	libclut_apply_pixels(&t1, UINT16_MAX, uint16_t, LIBCLUT_PIXEL_XBGR2101010, p32, 8, 8, 8 * sizeof(uint32_t));
+	for (i = 0; i < 64; i++)
+		if (p32[i] != ((uint32_t)(i * 2654435761UL) ^ 0x3FF003FFUL))
+			break;
+	if (i < 64)
+		printf("libclut_apply_pixels (XRGB2101010 or XBGR2101010) failed\n"), rc = 1;
+	if (libclut_apply_pixel_tables((libclut_pixel_format_t)-1, p32, 8, 8, 8 * sizeof(uint32_t), t1.red, t1.green, t1.blue) != -1)
+		printf("libclut_apply_pixel_tables failed\n"), rc = 1;
+
+	libclut_start_over(&t1, UINT16_MAX, uint16_t, 1, 1, 1);
+	libclut_gamma(&t1, UINT16_MAX, uint16_t, 1.1, 1.2, 1.3);
+	if (!(f = tmpfile()))
+		goto fail;
+	if (libclut_save_ramps(fileno(f), &t1, UINT16_MAX, uint16_t, &wgrgb)) {
+		printf("libclut_save_ramps failed\n"), rc = 1;
+	} else if (libclut_map_ramps(fileno(f), &t4, uint16_t, &mapping)) {
+		printf("libclut_map_ramps failed\n"), rc = 1;
+	} else {
+		if (t4.red_size != 256 || t4.green_size != 256 || t4.blue_size != 256 ||
+		    memcmp(t4.red, t1.red, 256 * sizeof(uint16_t)) || memcmp(t4.green, t1.green, 256 * sizeof(uint16_t)) ||
+		    memcmp(t4.blue, t1.blue, 256 * sizeof(uint16_t)) ||
+		    mapping.max != UINT16_MAX || mapping.type != LIBCLUT_ELEMENT_UINT16 ||
+		    !mapping.has_colour_space || memcmp(&mapping.colour_space, &wgrgb, sizeof(wgrgb)) ||
+		    (size_t)((char *)t4.red - (char *)mapping.map) % 64)
+			printf("libclut_map_ramps failed\n"), rc = 1;
+		t4.red[0] = 1;
+		libclut_unmap_ramps(&mapping);
+		if (!libclut_map_ramps(fileno(f), &d1, double, &mapping))
+			printf("libclut_map_ramps failed\n"), rc = 1;
+		if (libclut_map_ramps_file(fileno(f), 0, &mapping) || ((uint16_t *)mapping.red)[0] != t1.red[0])
+			printf("libclut_map_ramps_file failed\n"), rc = 1;
+		else
+			libclut_unmap_ramps(&mapping);
+	}
+	fclose(f);
+
+	if (!(f = tmpfile()))
+		goto fail;
+	if (libclut_save_ramps(fileno(f), &t1, UINT16_MAX, uint16_t, &bt2100)) {
+		printf("libclut_save_ramps failed\n"), rc = 1;
+	} else if (libclut_map_ramps_file(fileno(f), LIBCLUT_ELEMENT_UINT16, &mapping)) {
+		printf("libclut_map_ramps_file failed\n"), rc = 1;
+	} else {
+		if (!mapping.has_colour_space || mapping.colour_space.transfer.type != LIBCLUT_TRANSFER_PQ ||
+		    mapping.colour_space.red_x != bt2100.red_x || mapping.colour_space.white_y != bt2100.white_y)
+			printf("libclut_map_ramps_file failed\n"), rc = 1;
+		libclut_unmap_ramps(&mapping);
+		/* Version 1 files did not store the transfer function, which was always sRGB */
+		if (fseek(f, 8, SEEK_SET) || fwrite(&(uint32_t){1}, sizeof(uint32_t), 1, f) != 1 || fflush(f))
+			goto fail;
+		if (libclut_map_ramps_file(fileno(f), LIBCLUT_ELEMENT_UINT16, &mapping)) {
+			printf("libclut_map_ramps_file failed\n"), rc = 1;
+		} else {
+			if (!mapping.has_colour_space || mapping.colour_space.transfer.type != LIBCLUT_TRANSFER_SRGB)
+				printf("libclut_map_ramps_file failed\n"), rc = 1;
+			libclut_unmap_ramps(&mapping);
+		}
+	}
+	fclose(f);
+
+	memset(icc, 0, sizeof(icc));
+	put32(&icc[0], 1928);
+	memcpy(&icc[36], "acsp", 4);
+	put32(&icc[128], 8);
+	put_icc_tag(icc, 0, "vcgt", 228, 1554);
+	put_icc_tag(icc, 1, "rXYZ", 1784, 20);
+	put_icc_tag(icc, 2, "gXYZ", 1804, 20);
+	put_icc_tag(icc, 3, "bXYZ", 1824, 20);
+	put_icc_tag(icc, 4, "wtpt", 1844, 20);
+	put_icc_tag(icc, 5, "rTRC", 1864, 32);
+	put_icc_tag(icc, 6, "gTRC", 1896, 14);
+	put_icc_tag(icc, 7, "bTRC", 1912, 16);
+	memcpy(&icc[228], "vcgt", 4);
+	icc[241] = 3, icc[242] = 1, icc[245] = 2;
+	for (i = 0; i < 256; i++) {
+		icc[246 + 2 * i + 0 * 512] = (unsigned char)(255 - i), icc[246 + 2 * i + 0 * 512 + 1] = (unsigned char)(255 - i);
+		icc[246 + 2 * i + 1 * 512] = (unsigned char)i,         icc[246 + 2 * i + 1 * 512 + 1] = (unsigned char)i;
+		icc[246 + 2 * i + 2 * 512] = (unsigned char)(i / 2),   icc[246 + 2 * i + 2 * 512 + 1] = (unsigned char)(i / 2 * 2);
+	}
+	put_icc_xyz(icc, 1784, 0.4124, 0.2126, 0.0193);
+	put_icc_xyz(icc, 1804, 0.3576, 0.7152, 0.1192);
+	put_icc_xyz(icc, 1824, 0.1805, 0.0722, 0.9505);
+	put_icc_xyz(icc, 1844, 0.9505, 1.0000, 1.0890);
+	memcpy(&icc[1864], "para", 4);
+	icc[1873] = 3;
+	put32(&icc[1876], (uint32_t)(2.4 * 65536));
+	put32(&icc[1880], (uint32_t)(1 / 1.055 * 65536));
+	put32(&icc[1884], (uint32_t)(0.055 / 1.055 * 65536));
+	put32(&icc[1888], (uint32_t)(1 / 12.92 * 65536));
+	put32(&icc[1892], (uint32_t)(0.04045 * 65536));
+	memcpy(&icc[1896], "curv", 4);
+	put32(&icc[1904], 1);
+	icc[1908] = 2, icc[1909] = 51;
+	memcpy(&icc[1912], "curv", 4);
+	put32(&icc[1920], 2);
+	icc[1926] = icc[1927] = 255;
+	if (libclut_icc_parse(icc, sizeof(icc), &iccp)) {
+		printf("libclut_icc_parse failed\n"), rc = 1;
+	} else {
+		if (!iccp.has_colour_space ||
+		    fabs(iccp.colour_space.red_x   - 0.64)   > 0.001 || fabs(iccp.colour_space.red_y   - 0.33)   > 0.001 ||
+		    fabs(iccp.colour_space.green_x - 0.30)   > 0.001 || fabs(iccp.colour_space.green_y - 0.60)   > 0.001 ||
+		    fabs(iccp.colour_space.blue_x  - 0.15)   > 0.001 || fabs(iccp.colour_space.blue_y  - 0.06)   > 0.001 ||
+		    fabs(iccp.colour_space.white_x - 0.3127) > 0.001 || fabs(iccp.colour_space.white_y - 0.3290) > 0.001)
+			printf("libclut_icc_parse failed\n"), rc = 1;
+		t4.red_size = t4.green_size = t4.blue_size = 64;
+		t4.blue = (t4.green = (t4.red = t3.red) + 64) + 64;
+		libclut_icc_vcgt_ramps(&iccp, &t4, UINT16_MAX, uint16_t);
+		for (i = 0; i < 64; i++)
+			if (abs((int)t4.red[i] - (int)(UINT16_MAX - (double)i / 63 * UINT16_MAX)) > 2 ||
+			    abs((int)t4.green[i] - (int)((double)i / 63 * UINT16_MAX)) > 2 ||
+			    fabs(t4.blue[i] - (double)i / 63 * 127.5 * 258) > 300)
+				break;
+		if (i < 64)
+			printf("libclut_icc_vcgt_ramps failed\n"), rc = 1;
+		t4.red_size = t4.green_size = t4.blue_size = 1;
+		t4.blue = (t4.green = t4.red + 1) + 1;
+		libclut_icc_vcgt_ramps(&iccp, &t4, UINT16_MAX, uint16_t);
+		if (abs((int)t4.red[0] - UINT16_MAX) > 2 || t4.green[0] > 2 || t4.blue[0] > 2)
+			printf("libclut_icc_vcgt_ramps (1 stop) failed\n"), rc = 1;
+		libclut_icc_trc_ramps(&iccp, &t2, UINT16_MAX, uint16_t);
+		for (i = 0; i < 256; i++)
+			if (fabs(t2.red[i] - libclut_model_standard_to_linear1(i / 255.) * UINT16_MAX) > 40 ||
+			    fabs(t2.green[i] - pow(i / 255., 563. / 256) * UINT16_MAX) > 1 ||
+			    abs((int)t2.blue[i] - (int)(i * 257)) > 1)
+				break;
+		if (i < 256)
+			printf("libclut_icc_trc_ramps failed\n"), rc = 1;
+	}
+	icc[37] = 'C';
+	if (!libclut_icc_parse(icc, sizeof(icc), &iccp))
+		printf("libclut_icc_parse failed\n"), rc = 1;
+	icc[37] = 'c';
+	put32(&icc[0], 0);
+	put32(&icc[128], 1000);
+	if (!(tmp = malloc(132)))
+		goto fail;
+	memcpy(tmp, icc, 132);
+	if (!libclut_icc_parse(tmp, 132, &iccp))
+		printf("libclut_icc_parse failed\n"), rc = 1;
+	free(tmp);
+
+	for (i = 0; i < 3 * 256; i++)
+		t1.red[i] = (uint16_t)(i % 256 * (i % 256));
+	libclut_translate(&e1, UINT8_MAX, uint8_t, &t1, UINT16_MAX, uint16_t);
+	for (i = 0; i < 3 * 64; i++) {
+		x = (double)(i % 64) / 63 * 255;
+		if (fabs(p8[i] - x * x / UINT16_MAX * UINT8_MAX) > 1)
+			break;
+	}
+	if (i < 3 * 64 || p8[0] != 0 || p8[63] != (uint8_t)(255. * 255 / UINT16_MAX * UINT8_MAX) || p8[64 + 63] != p8[63])
+		printf("libclut_translate (256 to 64 stops) failed\n"), rc = 1;
+	for (i = 0; i < 3 * 64; i++)
+		q8[i] = (uint8_t)(i % 64 * 4);
+	libclut_translate(&t2, UINT16_MAX, uint16_t, &e2, UINT8_MAX, uint8_t);
+	for (i = 0; i < 3 * 256; i++)
+		if (fabs(t2.red[i] - (double)(i % 256) / 255 * 63 * 4 * 257) > 1)
+			break;
+	if (i < 3 * 256 || t2.red[0] != 0 || t2.red[255] != 63 * 4 * 257 || t2.blue[255] != 63 * 4 * 257)
+		printf("libclut_translate (64 to 256 stops) failed\n"), rc = 1;
+
+	libclut_start_over(&t1, UINT16_MAX, uint16_t, 1, 1, 1);
+	libclut_gamma(&t1, UINT16_MAX, uint16_t, 1.1, 1.2, 1.3);
+	if (!(f = tmpfile()))
+		goto fail;
+	if (libclut_cube_save_ramps(fileno(f), &t1, UINT16_MAX, uint16_t, "Gamma")) {
+		printf("libclut_cube_save_ramps failed\n"), rc = 1;
+	} else if (rewind(f), libclut_cube_load(fileno(f), &cube)) {
+		printf("libclut_cube_load failed\n"), rc = 1;
+	} else {
+		libclut_cube_ramps(&cube, &t2, UINT16_MAX, uint16_t);
+		if (clutcmp(&t1, &t2, 1) || strcmp(cube.title, "Gamma") || cube.red_size != 256 || cube.size)
+			printf("libclut_cube_ramps failed\n"), rc = 1;
+		libclut_cube_destroy(&cube);
+	}
+	fclose(f);
+
+	libclut_3d_start_over(&l1, 1, double);
+	libclut_3d_manipulate(&l1, 1, double, swap_red_blue);
+	if (!(f = tmpfile()))
+		goto fail;
+	if (libclut_cube_save_3d(fileno(f), &l1, 1, double, NULL)) {
+		printf("libclut_cube_save_3d failed\n"), rc = 1;
+	} else if (rewind(f), libclut_cube_load(fileno(f), &cube)) {
+		printf("libclut_cube_load failed\n"), rc = 1;
+	} else {
+		libclut_cube_3d(&cube, &c1, UINT16_MAX, uint16_t, 1);
+		for (i = 0; i < 3 * 17 * 17 * 17; i++)
+			if (fabs(cube.data[i] - l1.data[i]) > 0.000001 || abs((int)c1.data[i] - (int)(l1.data[i] * UINT16_MAX)) > 1)
+				break;
+		if (i < 3 * 17 * 17 * 17 || *cube.title || cube.red_size || cube.size != 17)
+			printf("libclut_cube_3d failed\n"), rc = 1;
+		libclut_cube_destroy(&cube);
+	}
+	fclose(f);
+
+	libclut_cube_init(&cube);
+	for (i = 0; i < sizeof(cube_text) - 1; i++)
+		if (libclut_cube_parse(&cube, &cube_text[i], 1))
+			break;
+	if (i < sizeof(cube_text) - 1 || libclut_cube_parse(&cube, NULL, 0)) {
+		printf("libclut_cube_parse failed\n"), rc = 1;
+	} else {
+		if (strcmp(cube.title, "Test") || cube.red_size != 3 || cube.size ||
+		    cube.red[1] != HALF || cube.green[1] != HALF || cube.blue[1] != HALF || cube.domain_max[0] != HALF)
+			printf("libclut_cube_parse failed\n"), rc = 1;
+		libclut_cube_ramps(&cube, &t2, UINT16_MAX, uint16_t);
+		if (t2.red[0] || t2.red[128] != UINT16_MAX || abs((int)t2.red[51] - (int)(0.4 * UINT16_MAX)) > 1 ||
+		    t2.green[0] != UINT16_MAX || t2.green[255] || t2.blue[255] != UINT16_MAX)
+			printf("libclut_cube_ramps failed\n"), rc = 1;
+		t2.red_size = t2.green_size = t2.blue_size = 1;
+		libclut_cube_ramps(&cube, &t2, UINT16_MAX, uint16_t);
+		if (t2.red[0] || t2.green[0] != UINT16_MAX || t2.blue[0])
+			printf("libclut_cube_ramps (1 stop) failed\n"), rc = 1;
+		t2.red_size = t2.green_size = t2.blue_size = 256;
+	}
+	libclut_cube_destroy(&cube);
+	libclut_cube_init(&cube);
+	if (libclut_cube_parse(&cube, cube_text, 86) || !libclut_cube_parse(&cube, NULL, 0) ||
+	    !libclut_cube_parse(&cube, "\n0 0 0\n1 1 1\n", 14))
+		printf("libclut_cube_parse failed\n"), rc = 1;
+	libclut_cube_destroy(&cube);
+
+	libclut_start_over(&t1, UINT16_MAX, uint16_t, 1, 1, 1);
+	libclut_start_over(&t2, UINT16_MAX, uint16_t, 1, 1, 1);
+	h1 = libclut_hash(&t1, UINT16_MAX, uint16_t);
+	h2 = libclut_hash(&t2, UINT16_MAX, uint16_t);
+	t2.blue[255] -= 1;
+	if (h1 != h2 || h1 == libclut_hash(&t2, UINT16_MAX, uint16_t) || h1 == libclut_hash(&t1, 65534, uint16_t))
+		printf("libclut_hash failed\n"), rc = 1;
+	params[0] = 0.0, params[1] = NAN, params[2] = 1.2;
+	op1 = libclut_hash_operation(0, "gamma", 3, params);
+	params[0] = -0.0, params[1] = -NAN;
+	op2 = libclut_hash_operation(0, "gamma", 3, params);
+	if (op1 != op2 || op1 == libclut_hash_operation(0, "gamma", 2, params) ||
+	    op1 == libclut_hash_operation(0, "contrast", 3, params) ||
+	    libclut_hash_operation(op1, "clip", 0, NULL) == libclut_hash_operation(0, "clip", 0, NULL))
+		printf("libclut_hash_operation failed\n"), rc = 1;
+
+	if (libclut_cache_init(&cache, 2))
+		goto fail;
+	libclut_gamma(&t1, UINT16_MAX, uint16_t, 1.1, 1.2, 1.3);
+	if (libclut_cache_store(&cache, h1, op1, &t1, UINT16_MAX, uint16_t) ||
+	    libclut_cache_store(&cache, h1, op2 + 1, &t2, UINT16_MAX, uint16_t) ||
+	    !libclut_cache_fetch(&cache, h1, op1, &t3, UINT16_MAX, uint16_t) || clutcmp(&t1, &t3, 0) ||
+	    libclut_cache_store(&cache, h2 + 1, op1, &t2, UINT16_MAX, uint16_t) ||
+	    libclut_cache_fetch(&cache, h1, op2 + 1, &t3, UINT16_MAX, uint16_t) ||
+	    libclut_cache_fetch(&cache, h1, op1, &d1, 1, double) ||
+	    !libclut_cache_fetch(&cache, h1, op1, &t3, UINT16_MAX, uint16_t) ||
+	    !libclut_cache_fetch(&cache, h2 + 1, op1, &t3, UINT16_MAX, uint16_t) || clutcmp(&t2, &t3, 0) ||
+	    cache.hits != 3 || cache.misses != 2)
+		printf("libclut_cache_store or libclut_cache_fetch failed\n"), rc = 1;
+	t4.red_size = t4.green_size = t4.blue_size = 0;
+	t4.red = t4.green = t4.blue = t3.red;
+	if (libclut_cache_store(&cache, h1, op1 + 1, &t4, UINT16_MAX, uint16_t) ||
+	    !libclut_cache_fetch(&cache, h1, op1 + 1, &t4, UINT16_MAX, uint16_t))
+		printf("libclut_cache_store or libclut_cache_fetch (empty ramps) failed\n"), rc = 1;
+	libclut_cache_destroy(&cache);
+
+	libclut_start_over(&t1, 15, uint16_t, 1, 1, 1);
+	libclut_start_over(&t2, 15, uint16_t, 1, 1, 1);
+	libclut_manipulate(&t1, 15, uint16_t, square, nofunc, square);
+	square_calls = 0;
+	libclut_manipulate_sampled(&t2, 15, uint16_t, square, nofunc, square, 0);
+	if (clutcmp(&t1, &t2, 0) || square_calls != 2 * 16)
+		printf("libclut_manipulate_sampled failed\n"), rc = 1;
+	for (i = 0; i < 3 * 256; i++)
+		t1.red[i] = t2.red[i] = (uint16_t)(i % 256 / 16 * 4096);
+	libclut_manipulate(&t1, UINT16_MAX, uint16_t, square, square, square);
+	square_calls = 0;
+	libclut_manipulate_sampled(&t2, UINT16_MAX, uint16_t, square, square, square, 0);
+	if (clutcmp(&t1, &t2, 0) || square_calls != 3 * 16)
+		printf("libclut_manipulate_sampled failed\n"), rc = 1;
+	libclut_start_over(&t1, UINT16_MAX, uint16_t, 1, 1, 1);
+	libclut_start_over(&t2, UINT16_MAX, uint16_t, 1, 1, 1);
+	libclut_manipulate(&t1, UINT16_MAX, uint16_t, square, square, square);
+	square_calls = 0;
+	libclut_manipulate_sampled(&t2, UINT16_MAX, uint16_t, square, square, square, 33);
+	if (clutcmp(&t1, &t2, 17) || square_calls != 3 * 33)
+		printf("libclut_manipulate_sampled failed\n"), rc = 1;
+	libclut_start_over(&t2, UINT16_MAX, uint16_t, 1, 1, 1);
+	square_calls = 0;
+	libclut_manipulate_sampled(&t2, UINT16_MAX, uint16_t, square, square, square, SIZE_MAX);
+	if (clutcmp(&t1, &t2, 0) || square_calls != 3 * 256)
+		printf("libclut_manipulate_sampled (too many samples) failed\n"), rc = 1;
+	libclut_start_over(&t1, UINT16_MAX, uint16_t, 1, 1, 1);
+	libclut_start_over(&t2, UINT16_MAX, uint16_t, 1, 1, 1);
+	libclut_manipulate(&t1, UINT16_MAX, uint16_t, square, nofunc, square);
+	j = 0;
+	libclut_manipulate_batch(&t2, UINT16_MAX, uint16_t, square_batch, NULL, square_batch, &j);
+	if (clutcmp(&t1, &t2, 0) || j != 2)
+		printf("libclut_manipulate_batch failed\n"), rc = 1;
+	t4.red_size = 700, t4.green_size = t4.blue_size = 34;
+	t4.blue = (t4.green = (t4.red = t3.red) + 700) + 34;
+	for (i = 0; i < 3 * 256; i++)
+		t3.red[i] = (uint16_t)(i * 85);
+	j = 0;
+	libclut_manipulate_batch(&t4, UINT16_MAX, uint16_t, square_batch, square_batch, square_batch, &j);
+	for (i = 0; i < 3 * 256; i++)
+		if (t3.red[i] != (uint16_t)(UINT16_MAX * ((i * 85.) / UINT16_MAX) * ((i * 85.) / UINT16_MAX)))
+			break;
+	if (i < 3 * 256 || j != 5)
+		printf("libclut_manipulate_batch failed\n"), rc = 1;
+	libclut_start_over(&d1, 1, double, 1, 1, 1);
+	libclut_start_over(&d2, 1, double, 1, 1, 1);
+	libclut_cie_manipulate(&d1, 1, double, square, nofunc, square);
+	square_calls = 0;
+	libclut_cie_manipulate_sampled(&d2, 1, double, square, nofunc, square, 257);
+	if (dclutcmp(&d1, &d2, 0.0001) || square_calls != 2 * 257)
+		printf("libclut_cie_manipulate_sampled failed\n"), rc = 1;
+	libclut_start_over(&d2, 1, double, 1, 1, 1);
+	libclut_cie_manipulate_sampled(&d2, 1, double, square, nofunc, square, SIZE_MAX);
+	if (dclutcmp(&d1, &d2, 0))
+		printf("libclut_cie_manipulate_sampled (too many samples) failed\n"), rc = 1;
+
 	if (libclut_model_get_rgb_conversion_matrix(&srgb, &wgrgb, M, Minv)) {
 		printf("libclut_model_get_rgb_conversion_matrix failed\n"), rc = 1;
 		goto rgb_conversion_done;
@@ -306,8 +1066,58 @@ main(int argc, char *argv[])
 # pragma GCC diagnostic ignored "-Waddress"
 #endif
 
-	libclut_convert_rgb_inplace(&d1, 1, double, M, trunc); /* TODO test */
-	libclut_convert_rgb(&d1, 1, double, M, trunc, &d2);    /* TODO test */
+	for (i = 0; i < 256; i++) {
+		d1.red[i] = (double)i / 255;
+		d1.green[i] = pow((double)i / 255, 1.1);
+		d1.blue[i] = pow((double)i / 255, 0.9);
+	}
+	memset(P, 0, sizeof(P));
+	P[0][0] = P[1][1] = P[2][2] = 1;
+	libclut_convert_rgb(&d1, 1, double, P, 0, &d2);
+	if (dclutcmp(&d1, &d2, 0.000000001))
+		printf("libclut_convert_rgb failed\n"), rc = 1;
+	memcpy(d2.red, d1.red, 3 * 256 * sizeof(double));
+	libclut_convert_rgb_inplace(&d2, 1, double, P, 0);
+	if (dclutcmp(&d1, &d2, 0.000000001))
+		printf("libclut_convert_rgb_inplace failed\n"), rc = 1;
+	memcpy(d2.red, d1.red, 3 * 256 * sizeof(double));
+	libclut_convert_rgb_inplace(&d2, 1, double, M, 0);
+	libclut_convert_rgb_inplace(&d2, 1, double, Minv, 0);
+	if (dclutcmp(&d1, &d2, 0.000001))
+		printf("libclut_convert_rgb_inplace failed\n"), rc = 1;
+	memcpy(d2.red, d1.red, 3 * 256 * sizeof(double));
+	libclut_convert_rgb_inplace(&d2, 1, double, M, 1);
+	for (i = 0; i < 256; i++) {
+		libclut_model_convert_rgb(d1.red[i], d1.green[i], d1.blue[i], M, &r, &g, &b);
+		r = r < 0 ? 0 : r > 1 ? 1 : r;
+		g = g < 0 ? 0 : g > 1 ? 1 : g;
+		b = b < 0 ? 0 : b > 1 ? 1 : b;
+		if (fabs(d2.red[i] - r) > 0.000000001 || fabs(d2.green[i] - g) > 0.000000001 ||
+		    fabs(d2.blue[i] - b) > 0.000000001)
+			break;
+	}
+	if (i < 256)
+		printf("libclut_convert_rgb_inplace failed\n"), rc = 1;
+	libclut_convert_rgb(&d1, 1, double, M, 1, &d2);
+	libclut_model_prepare_transfer_table(&tt, &srgb.transfer);
+	libclut_convert_rgb_transfer(&d1, 1, double, M, 1, &d1, &tt, &tt);
+	if (dclutcmp(&d1, &d2, 0.00001))
+		printf("libclut_convert_rgb_transfer failed\n"), rc = 1;
+
+	libclut_model_get_rgb_conversion_matrix(&wgrgb, &bt2100, P, NULL);
+	libclut_model_prepare_transfer_table(&tt, &wgrgb.transfer);
+	libclut_model_prepare_transfer_table(&tt2, &bt2100.transfer);
+	for (i = 0; i < 256; i++) {
+		r = libclut_model_transfer_decode(&wgrgb.transfer, d1.red[i]);
+		g = libclut_model_transfer_decode(&wgrgb.transfer, d1.green[i]);
+		b = libclut_model_transfer_decode(&wgrgb.transfer, d1.blue[i]);
+		d2.red[i]   = libclut_model_transfer_encode(&bt2100.transfer, P[0][0] * r + P[0][1] * g + P[0][2] * b);
+		d2.green[i] = libclut_model_transfer_encode(&bt2100.transfer, P[1][0] * r + P[1][1] * g + P[1][2] * b);
+		d2.blue[i]  = libclut_model_transfer_encode(&bt2100.transfer, P[2][0] * r + P[2][1] * g + P[2][2] * b);
+	}
+	libclut_convert_rgb_transfer(&d1, 1, double, P, 0, &d1, &tt, &tt2);
+	if (dclutcmp(&d1, &d2, 0.00001))
+		printf("libclut_convert_rgb_transfer failed\n"), rc = 1;
 
 #if defined(__GNUC__)
 # pragma GCC diagnostic pop
@@ -374,7 +1184,228 @@ main(int argc, char *argv[])
 		goto rgb_conversion_done;
 	}
 
+	for (k = LIBCLUT_ADAPTATION_XYZ_SCALING; k <= LIBCLUT_ADAPTATION_CAT02; k++) {
+		if (libclut_model_get_adapted_rgb_conversion_matrix(&srgb, &prophoto, (libclut_chromatic_adaptation_t)k, M, Minv)) {
+			printf("libclut_model_get_adapted_rgb_conversion_matrix failed\n"), rc = 1;
+			goto rgb_conversion_done;
+		}
+		libclut_model_convert_rgb(1, 1, 1, M, &r, &g, &b);
+		libclut_model_convert_rgb(r, g, b, Minv, &x, &y, &z);
+		if (fabs(r - 1) > 0.000001 || fabs(g - 1) > 0.000001 || fabs(b - 1) > 0.000001 ||
+		    fabs(x - 1) > 0.000001 || fabs(y - 1) > 0.000001 || fabs(z - 1) > 0.000001) {
+			printf("libclut_model_get_adapted_rgb_conversion_matrix failed\n"), rc = 1;
+			goto rgb_conversion_done;
+		}
+	}
+	libclut_model_get_adapted_rgb_conversion_matrix(&srgb, &prophoto, LIBCLUT_ADAPTATION_BRADFORD, M, NULL);
+	libclut_model_get_rgb_conversion_matrix(&prophoto, NULL, Minv, NULL);
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < 3; j++)
+			P[i][j] = Minv[i][0] * M[0][j] + Minv[i][1] * M[1][j] + Minv[i][2] * M[2][j];
+	if (fabs(P[0][0] - 0.4360747) > 0.001 || fabs(P[0][1] - 0.3850649) > 0.001 || fabs(P[0][2] - 0.1430804) > 0.001 ||
+	    fabs(P[1][0] - 0.2225045) > 0.001 || fabs(P[1][1] - 0.7168786) > 0.001 || fabs(P[1][2] - 0.0606169) > 0.001 ||
+	    fabs(P[2][0] - 0.0139322) > 0.001 || fabs(P[2][1] - 0.0971045) > 0.001 || fabs(P[2][2] - 0.7141733) > 0.001) {
+		printf("libclut_model_get_adapted_rgb_conversion_matrix failed\n"), rc = 1;
+		goto rgb_conversion_done;
+	}
+	libclut_model_get_adapted_rgb_conversion_matrix(&srgb, &prophoto, LIBCLUT_ADAPTATION_NONE, M, NULL);
+	libclut_model_get_rgb_conversion_matrix(&srgb, &prophoto, Minv, NULL);
+	if (memcmp(M, Minv, sizeof(M)))
+		printf("libclut_model_get_adapted_rgb_conversion_matrix failed\n"), rc = 1;
+	if (libclut_model_get_adapted_rgb_conversion_matrix(&srgb, &prophoto, (libclut_chromatic_adaptation_t)99, M, NULL) != -1)
+		printf("libclut_model_get_adapted_rgb_conversion_matrix failed\n"), rc = 1;
+
+	libclut_model_get_rgb_conversion_matrix(&srgb, &wgrgb, M, NULL);
+	if (libclut_model_invert_matrix(M, Minv, &x)) {
+		printf("libclut_model_invert_matrix failed\n"), rc = 1;
+		goto rgb_conversion_done;
+	}
+	memcpy(P, M, sizeof(P));
+	libclut_model_multiply_matrices(P, P, Minv);
+	for (i = 0; i < 9; i++)
+		if (fabs(P[i / 3][i % 3] - (i % 4 ? 0 : 1)) > 0.000000001)
+			break;
+	if (i < 9 || x < 1 || x > 100)
+		printf("libclut_model_invert_matrix failed\n"), rc = 1;
+	libclut_model_multiply_matrices(P, Minv, M);
+	for (i = 0; i < 9; i++)
+		if (fabs(P[i / 3][i % 3] - (i % 4 ? 0 : 1)) > 0.000000001)
+			break;
+	if (i < 9)
+		printf("libclut_model_multiply_matrices failed\n"), rc = 1;
+	memcpy(P, M, sizeof(P));
+	if (libclut_model_invert_matrix(P, P, NULL) || memcmp(P, Minv, sizeof(P)))
+		printf("libclut_model_invert_matrix failed\n"), rc = 1;
+	memset(P, 0, sizeof(P));
+	P[0][0] = P[1][1] = 1, P[2][2] = 0.00000001;
+	if (libclut_model_invert_matrix(P, Minv, &x) || fabs(x - 100000000) > 1 || fabs(Minv[2][2] - 100000000) > 0.0001)
+		printf("libclut_model_invert_matrix failed\n"), rc = 1;
+	P[2][2] = 1;
+	if (libclut_model_invert_matrix(P, Minv, &x) || !libclut_1__(x))
+		printf("libclut_model_invert_matrix failed\n"), rc = 1;
+	P[2][0] = 1, P[2][1] = 1, P[2][2] = 0;
+	if (libclut_model_invert_matrix(P, Minv, NULL) != -1)
+		printf("libclut_model_invert_matrix failed\n"), rc = 1;
+
 	libclut_model_get_rgb_conversion_matrix(&srgb, &wgrgb, M, NULL); /* Just testing that we don't get a segfault. */
+
+	for (i = 0; i < 2 * 320 * 4; i++)
+		img[i] = (float)((i * 7919) % 1000) / 999;
+	memcpy(img2, img, sizeof(img));
+	libclut_convert_rgb_image(img, 1, float, 300, 2, 320 * 4 * sizeof(float), 4, M, 0);
+	for (i = 0; i < 2 * 320; i++) {
+		k = i * 4;
+		if (i % 320 >= 300) {
+			if (memcmp(&img[k], &img2[k], 4 * sizeof(float)))
+				break;
+			continue;
+		}
+		libclut_model_convert_rgb(img2[k], img2[k + 1], img2[k + 2], M, &r, &g, &b);
+		if (fabs(img[k] - r) > 0.00001 || fabs(img[k + 1] - g) > 0.00001 ||
+		    fabs(img[k + 2] - b) > 0.00001 || img[k + 3] != img2[k + 3])
+			break;
+	}
+	if (i < 2 * 320)
+		printf("libclut_convert_rgb_image (float) failed\n"), rc = 1;
+	for (i = 0; i < 64 * 4; i++)
+		q8[i] = p8[i] = (uint8_t)(i * 37 + (i >> 2));
+	libclut_convert_rgb_image(p8, UINT8_MAX, uint8_t, 64, 1, 0, 4, M, 1);
+	for (i = 0; i < 64; i++) {
+		k = i * 4;
+		libclut_model_convert_rgb(q8[k] / 255., q8[k + 1] / 255., q8[k + 2] / 255., M, &r, &g, &b);
+		r = r < 0 ? 0 : r > 1 ? 255 : r * 255 + 0.5;
+		g = g < 0 ? 0 : g > 1 ? 255 : g * 255 + 0.5;
+		b = b < 0 ? 0 : b > 1 ? 255 : b * 255 + 0.5;
+		if (p8[k] != (uint8_t)r || p8[k + 1] != (uint8_t)g || p8[k + 2] != (uint8_t)b || p8[k + 3] != q8[k + 3])
+			break;
+	}
+	if (i < 64)
+		printf("libclut_convert_rgb_image (uint8_t) failed\n"), rc = 1;
+	for (i = 0; i < 3 * 256; i++)
+		t2.red[i] = t3.red[i] = (uint16_t)(i * 4093 % 4096);
+	libclut_convert_rgb_image(t3.red, 4095, uint16_t, 256, 1, 0, 3, M, 1);
+	for (i = 0; i < 3 * 256; i += 3) {
+		libclut_model_convert_rgb(t2.red[i] / 4095., t2.red[i + 1] / 4095., t2.red[i + 2] / 4095., M, &r, &g, &b);
+		r = r < 0 ? 0 : r > 1 ? 4095 : r * 4095 + 0.5;
+		g = g < 0 ? 0 : g > 1 ? 4095 : g * 4095 + 0.5;
+		b = b < 0 ? 0 : b > 1 ? 4095 : b * 4095 + 0.5;
+		if (t3.red[i] != (uint16_t)r || t3.red[i + 1] != (uint16_t)g || t3.red[i + 2] != (uint16_t)b)
+			break;
+	}
+	if (i < 3 * 256)
+		printf("libclut_convert_rgb_image (uint16_t) failed\n"), rc = 1;
+
+	libclut_3d_start_over(&l1, 1.0, double);
+	i = libclut_3d_index(&l1, 4, 8, 16);
+	if (l1.data[i] != 0.25 || l1.data[i + 1] != 0.5 || l1.data[i + 2] != 1 || i != 3 * (4 + 17 * (8 + 17 * 16)))
+		printf("libclut_3d_start_over failed\n"), rc = 1;
+	libclut_3d_convert_rgb(&l1, 1.0, double, M, 0);
+	libclut_model_convert_rgb(0.25, 0.5, 1.0, M, &r, &g, &b);
+	if (fabs(l1.data[i] - r) > 0.000001 || fabs(l1.data[i + 1] - g) > 0.000001 || fabs(l1.data[i + 2] - b) > 0.000001)
+		printf("libclut_3d_convert_rgb failed\n"), rc = 1;
+	libclut_3d_rgb_conversion(&l2, 1.0, double, M, 0);
+	for (i = 0; i < 3 * 17 * 17 * 17; i++)
+		if (fabs(l1.data[i] - l2.data[i]) > 0.000001)
+			break;
+	if (i < 3 * 17 * 17 * 17)
+		printf("libclut_3d_rgb_conversion failed\n"), rc = 1;
+	memcpy(l2.data, l1.data, 3 * 17 * 17 * 17 * sizeof(double));
+	libclut_3d_manipulate(&l2, 1.0, double, swap_red_blue);
+	for (i = 0; i < 3 * 17 * 17 * 17; i += 3)
+		if (l1.data[i] != l2.data[i + 2] || l1.data[i + 1] != l2.data[i + 1] || l1.data[i + 2] != l2.data[i])
+			break;
+	if (i < 3 * 17 * 17 * 17)
+		printf("libclut_3d_manipulate failed\n"), rc = 1;
+
+	libclut_3d_start_over(&c1, UINT16_MAX, uint16_t);
+	libclut_start_over(&t1, UINT16_MAX, uint16_t, 1, 1, 1);
+	libclut_negative(&t1, UINT16_MAX, uint16_t, 1, 0, 1);
+	libclut_3d_apply_ramps(&c1, UINT16_MAX, uint16_t, &t1, UINT16_MAX, uint16_t);
+	for (i = 0; i < 3 * 17 * 17 * 17; i += 3) {
+		j = i / 3;
+		if (abs((int)c1.data[i + 0] - (int)(UINT16_MAX - (j % 17) * UINT16_MAX / 16)) > 1 ||
+		    abs((int)c1.data[i + 1] - (int)((j / 17 % 17) * UINT16_MAX / 16)) > 1 ||
+		    abs((int)c1.data[i + 2] - (int)(UINT16_MAX - (j / 289) * UINT16_MAX / 16)) > 1)
+			break;
+	}
+	if (i < 3 * 17 * 17 * 17)
+		printf("libclut_3d_apply_ramps failed\n"), rc = 1;
+	libclut_3d_start_over(&c1, UINT16_MAX, uint16_t);
+	libclut_start_over(&t3, UINT16_MAX, uint16_t, 1, 1, 1);
+	t3.red[0] = 12345;
+	t3.red_size = 1, t3.green_size = 0;
+	libclut_3d_apply_ramps(&c1, UINT16_MAX, uint16_t, &t3, UINT16_MAX, uint16_t);
+	t3.red_size = t3.green_size = 256;
+	for (i = 0; i < 3 * 17 * 17 * 17; i += 3) {
+		j = i / 3;
+		if (c1.data[i + 0] != 12345 ||
+		    abs((int)c1.data[i + 1] - (int)((j / 17 % 17) * UINT16_MAX / 16)) > 1 ||
+		    abs((int)c1.data[i + 2] - (int)((j / 289) * UINT16_MAX / 16)) > 1)
+			break;
+	}
+	if (i < 3 * 17 * 17 * 17)
+		printf("libclut_3d_apply_ramps failed\n"), rc = 1;
+
+	libclut_3d_start_over(&c1, UINT16_MAX, uint16_t);
+	for (i = 0; i < 64 * 4; i++)
+		p8[i] = (uint8_t)(i * 37 + (i >> 2));
+	memcpy(q8, p8, sizeof(p8));
+	libclut_3d_apply(&c1, UINT16_MAX, uint16_t, p8, UINT8_MAX, uint8_t, 8, 8, 8 * 4, 4);
+	if (memcmp(p8, q8, sizeof(p8)))
+		printf("libclut_3d_apply (identity, uint8_t) failed\n"), rc = 1;
+	for (i = 0; i < 256 * 3; i++)
+		t2.red[i] = (uint16_t)(i * 4999);
+	memcpy(t3.red, t2.red, 256 * 3 * sizeof(uint16_t));
+	libclut_3d_apply(&c1, UINT16_MAX, uint16_t, t2.red, UINT16_MAX, uint16_t, 16, 16, 16 * 3 * sizeof(uint16_t), 3);
+	for (i = 0; i < 256 * 3; i++)
+		if (abs((int)t2.red[i] - (int)t3.red[i]) > 1)
+			break;
+	if (i < 256 * 3)
+		printf("libclut_3d_apply (identity, uint16_t) failed\n"), rc = 1;
+	for (i = 0; i < 17; i++) {
+		pf[3 * i + 0] = (float)i / 16;
+		pf[3 * i + 1] = (float)((i * 5) % 17) / 16;
+		pf[3 * i + 2] = (float)(16 - i) / 16;
+	}
+	libclut_3d_apply(&l1, 1.0, double, pf, 1, float, 17, 1, 0, 3);
+	for (i = 0; i < 17; i++) {
+		j = libclut_3d_index(&l1, i, (i * 5) % 17, 16 - i);
+		for (k = 0; k < 3; k++)
+			if (fabs(pf[3 * i + k] - (l1.data[j + k] < 0 ? 0 : l1.data[j + k] > 1 ? 1 : l1.data[j + k])) > 0.0001)
+				break;
+		if (k < 3)
+			break;
+	}
+	if (i < 17)
+		printf("libclut_3d_apply (float) failed\n"), rc = 1;
+	for (i = 0; i < 17 * 17 * 17; i++) {
+		x = (double)(i % 17) / 16, y = (double)(i / 17 % 17) / 16, z = (double)(i / 289) / 16;
+		l2.data[3 * i + 0] = x * y;
+		l2.data[3 * i + 1] = (y * y + z) / 2;
+		l2.data[3 * i + 2] = x * z * z;
+	}
+	for (i = 0; i < 17; i++) {
+		/* Fractions within the cell in each of the six orders, so every tetrahedron is used */
+		static const double fractions[6][3] = {
+			{0.7, 0.4, 0.15}, {0.7, 0.15, 0.4}, {0.4, 0.15, 0.7},
+			{0.4, 0.7, 0.15}, {0.15, 0.7, 0.4}, {0.15, 0.4, 0.7}};
+		pf[3 * i + 0] = (float)(((double)(i % 16) + fractions[i % 6][0]) / 16);
+		pf[3 * i + 1] = (float)(((double)((i * 5) % 16) + fractions[i % 6][1]) / 16);
+		pf[3 * i + 2] = (float)(((double)((i * 11) % 16) + fractions[i % 6][2]) / 16);
+	}
+	for (i = 0; i < 17 * 3; i++)
+		xyz[i] = (double)pf[i];
+	libclut_3d_apply(&l2, 1.0, double, pf, 1, float, 17, 1, 0, 3);
+	for (i = 0; i < 17; i++) {
+		tetrahedral(&l2, xyz[3 * i + 0], xyz[3 * i + 1], xyz[3 * i + 2], &lab[3 * i]);
+		for (k = 0; k < 3; k++)
+			if (fabs((double)pf[3 * i + k] - lab[3 * i + k]) > 0.00001)
+				break;
+		if (k < 3)
+			break;
+	}
+	if (i < 17)
+		printf("libclut_3d_apply (tetrahedra) failed\n"), rc = 1;
 rgb_conversion_done:
 
 	libclut_model_ciexyz_to_cieluv(0.4, 1.0, 0.7, 0.33, 1, 0.32, &x, &y, &z); /* TODO test */
@@ -424,6 +1455,53 @@ rgb_conversion_done:
 	    0.8999 > b || b > 0.9001)
 		printf("libclut_model_ycgco_to_srgb failed\n"), rc = 1;
 
+	libclut_model_ciexyz_to_cielab(0.3, 0.4, 0.5, &x, &y, &z);
+	libclut_model_cielab_to_ciexyz(x, y, z, &x, &y, &z);
+	if (0.2999 > x || x > 0.3001 ||
+	    0.3999 > y || y > 0.4001 ||
+	    0.4999 > z || z > 0.5001)
+		printf("libclut_model_cielab_to_ciexyz failed\n"), rc = 1;
+
+	libclut_model_prepare_white_point(&d65);
+	libclut_model_prepare_white_point(&d50);
+	if (fabs(d65.Xn - 0.9504) > 0.0001 || d65.Yn != 1 || fabs(d65.Zn - 1.0889) > 0.0001 ||
+	    fabs(d65.rZn * d65.Zn - 1) > 0.000001 || fabs(d65.un - 0.1978) > 0.0001 || fabs(d65.vn - 0.4683) > 0.0001)
+		printf("libclut_model_prepare_white_point failed\n"), rc = 1;
+	libclut_model_ciexyz_to_cielab(0.3, 0.4, 0.5, &r, &g, &b);
+	libclut_model_ciexyz_to_cielab_wp(0.3, 0.4, 0.5, &d65, &x, &y, &z);
+	if (fabs(r - x) > 0.05 || fabs(g - y) > 0.05 || fabs(b - z) > 0.05)
+		printf("libclut_model_ciexyz_to_cielab_wp failed\n"), rc = 1;
+	libclut_model_cielab_to_ciexyz_wp(x, y, z, &d65, &x, &y, &z);
+	if (fabs(x - 0.3) > 0.000000001 || fabs(y - 0.4) > 0.000000001 || fabs(z - 0.5) > 0.000000001)
+		printf("libclut_model_cielab_to_ciexyz_wp failed\n"), rc = 1;
+	(libclut_model_ciexyz_to_cielab_wp)(d50.Xn, d50.Yn, d50.Zn, &d50, &x, &y, &z);
+	if (fabs(x - 100) > 0.000001 || fabs(y) > 0.000001 || fabs(z) > 0.000001)
+		printf("libclut_model_ciexyz_to_cielab_wp failed\n"), rc = 1;
+	libclut_model_ciexyz_to_cieluv(0.3, 0.4, 0.5, d50.Xn, d50.Yn, d50.Zn, &r, &g, &b);
+	libclut_model_ciexyz_to_cieluv_wp(0.3, 0.4, 0.5, &d50, &x, &y, &z);
+	if (fabs(r - x) > 0.000000001 || fabs(g - y) > 0.000000001 || fabs(b - z) > 0.000000001)
+		printf("libclut_model_ciexyz_to_cieluv_wp failed\n"), rc = 1;
+	(libclut_model_cieluv_to_ciexyz_wp)(x, y, z, &d50, &x, &y, &z);
+	if (fabs(x - 0.3) > 0.000000001 || fabs(y - 0.4) > 0.000000001 || fabs(z - 0.5) > 0.000000001)
+		printf("libclut_model_cieluv_to_ciexyz_wp failed\n"), rc = 1;
+
+	for (i = 0; i < 3 * 1000; i++)
+		xyz[i] = (double)(i * 7919 % 1000) / 900;
+	libclut_model_ciexyz_to_cielab_batch(xyz, lab, 1000);
+	for (i = 0; i < 3 * 1000; i += 3) {
+		libclut_model_ciexyz_to_cielab(xyz[i], xyz[i + 1], xyz[i + 2], &x, &y, &z);
+		if (fabs(lab[i] - x) > 0.000001 || fabs(lab[i + 1] - y) > 0.000001 || fabs(lab[i + 2] - z) > 0.000001)
+			break;
+	}
+	if (i < 3 * 1000)
+		printf("libclut_model_ciexyz_to_cielab_batch failed\n"), rc = 1;
+	libclut_model_cielab_to_ciexyz_batch(lab, lab, 1000);
+	for (i = 0; i < 3 * 1000; i++)
+		if (fabs(lab[i] - xyz[i]) > 0.000001)
+			break;
+	if (i < 3 * 1000)
+		printf("libclut_model_cielab_to_ciexyz_batch failed\n"), rc = 1;
+
 	libclut_model_ciexyz_to_cie_1960_ucs(0.4, 0.7, 0.6, &x, &y, &z); /* TODO test */
 	libclut_model_cie_1960_ucs_to_ciexyz(x, y, z, &x, &y, &z);
 	if (0.3999 > x || x > 0.4001 ||
@@ -431,6 +1509,36 @@ rgb_conversion_done:
 	    0.5999 > z || z > 0.6001)
 		printf("libclut_model_cie_1960_ucs_to_ciexyz failed\n"), rc = 1;
 
+	libclut_model_cct_to_ciexy(2856, &x, &y);
+	if (fabs(x - 0.44757) > 0.0005 || fabs(y - 0.40745) > 0.0005)
+		printf("libclut_model_cct_to_ciexy failed\n"), rc = 1;
+	libclut_model_cct_to_ciexy(6500, &x, &y);
+	if (fabs(x - 0.3135) > 0.0005 || fabs(y - 0.3237) > 0.0005)
+		printf("libclut_model_cct_to_ciexy failed\n"), rc = 1;
+	libclut_model_cct_to_ciexy(500, &x, &y);
+	libclut_model_cct_to_ciexy(1000, &r, &g);
+	if (!libclut_eq__(x, r) || !libclut_eq__(y, g))
+		printf("libclut_model_cct_to_ciexy failed\n"), rc = 1;
+	libclut_model_cct_to_ciexy(40000, &x, &y);
+	libclut_model_cct_to_ciexy(25000, &r, &g);
+	if (!libclut_eq__(x, r) || !libclut_eq__(y, g) || fabs(x - 0.2521) > 0.0005 || fabs(y - 0.2507) > 0.0005)
+		printf("libclut_model_cct_to_ciexy failed\n"), rc = 1;
+	libclut_model_cct_to_cie_1960_ucs(2856, &x, &y);
+	if (fabs(x - 0.25597) > 0.0005 || fabs(y - 0.34950) > 0.0005)
+		printf("libclut_model_cct_to_cie_1960_ucs failed\n"), rc = 1;
+
+	for (i = 0; i < 256; i++)
+		d1.blue[i] = d1.green[i] = d1.red[i] = (double)i / 255;
+	libclut_rgb_temperature(&d1, 1, double, 3000);
+	if (fabs(d1.red[255] - 1) > 0.000001 || !(d1.green[255] < 1) || !(d1.blue[255] < d1.green[255]) ||
+	    fabs(d1.green[128] - d1.green[255] * 128 / 255) > 0.000001 || fabs(d1.blue[64] - d1.blue[255] * 64 / 255) > 0.000001)
+		printf("libclut_rgb_temperature failed\n"), rc = 1;
+	for (i = 0; i < 256; i++)
+		d1.blue[i] = d1.green[i] = d1.red[i] = (double)i / 255;
+	libclut_rgb_temperature(&d1, 1, double, 6500);
+	if (d1.red[255] < 0.97 || d1.green[255] < 0.97 || d1.blue[255] < 0.97)
+		printf("libclut_rgb_temperature failed\n"), rc = 1;
+
 	libclut_model_cie_1960_ucs_to_cieuvw(0.1, 0.7, 0.9, 0.3, 0.4, &x, &y, &z); /* TODO test */
 	libclut_model_cieuvw_to_cie_1960_ucs(x, y, z, 0.3, 0.4, &x, &y, &z);
 	if (0.0999 > x || x > 0.1001 ||
@@ -445,6 +1553,9 @@ rgb_conversion_done:
 	free(t3.red);
 	free(d1.red);
 	free(d2.red);
+	free(l1.data);
+	free(l2.data);
+	free(c1.data);
 	return rc;
 fail:
 	perror(*argv);
@@ -457,11 +1568,9 @@ fail:
 /*
   TODO test these too:
   
-  libclut_translate
   libclut_cie_contrast
   libclut_cie_brightness
   libclut_cie_invert
   libclut_cie_limits
-  libclut_cie_manipulate
   libclut_cie_apply
 */